@@ -20,6 +20,41 @@
 #include <time.h>
 #include <graph_generator.h>
 
+/// has the seed of the random generators been fixed by seedRandom?
+static bool Seeded;
+
+/// state of the generator behind rnd()
+static uint64_t Rnd_state;
+
+void seedRandom(unsigned seed) {
+    Rnd_state = seed;
+    Seeded = true;
+}
+
+/// seed the random generators from the clock, unless seedRandom was called
+static void initRandom(void) {
+    if (Seeded)
+	return;
+    Rnd_state = (uint64_t)time(0);
+}
+
+/// the next 64 random bits
+///
+/// Unlike rand(), this has the same range and sequence on every platform, so
+/// a seeded graph is the same everywhere, and it covers more than 32767 nodes.
+static uint64_t rndBits(void) {
+    // splitmix64
+    uint64_t z = (Rnd_state += UINT64_C(0x9e3779b97f4a7c15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return z ^ (z >> 31);
+}
+
+/// a random number in [0, n)
+static unsigned rnd(unsigned n) {
+    return (unsigned)(rndBits() % n);
+}
+
 void makePath(unsigned n, edgefn ef){
     if (n == 1) {
 	ef (1, 0);
@@ -383,8 +418,8 @@ void makeBall(unsigned w, unsigned h, edgefn ef) {
  * No. of nodes is largest 2^n - 1 less than or equal to h.
  */
 void makeRandom(unsigned h, unsigned w, edgefn ef) {
-    srand((unsigned)time(0));
-    const int type = rand() % 2;
+    initRandom();
+    const unsigned type = rnd(2);
 
     unsigned size = 0;
     unsigned depth = 0;
@@ -405,13 +440,119 @@ void makeRandom(unsigned h, unsigned w, edgefn ef) {
 
     for (unsigned i = 3; i <= size; i++) {
 	for (unsigned j = 1; j + 1 < i; j++) {
-	    const unsigned th = (unsigned)rand() % (size * size);
+	    const unsigned th = rnd(size * size);
 	    if ((th <= w * w && (i < 5 || (i + 4 > h && j + 4 > h))) || th <= w)
 		ef(j,i);
 	}
     }
 }
 
+/* makePowerLaw:
+ * Preferential attachment: each node after the first is joined to m distinct
+ * earlier nodes, chosen with probability proportional to their degree, which
+ * gives the power law degree distribution of many real networks.
+ */
+void makePowerLaw(unsigned n, unsigned m, edgefn ef) {
+    if (n == 1) {
+	ef(1, 0);
+	return;
+    }
+    initRandom();
+
+    // every end point of every edge so far; picking uniformly from these
+    // picks a node in proportion to its degree
+    unsigned *ends = gv_calloc(2 * (size_t)m * n, sizeof(unsigned));
+    size_t n_ends = 0;
+    unsigned *picked = gv_calloc(m, sizeof(unsigned));
+
+    for (unsigned i = 2; i <= n; i++) {
+	unsigned k = 0;
+	if (i - 1 <= m) {
+	    for (unsigned j = 1; j < i; j++)
+		picked[k++] = j;
+	} else {
+	    // every earlier node is an end point, so there are enough to pick from
+	    while (k < m) {
+		const unsigned j = ends[rnd((unsigned)n_ends)];
+		bool seen = false;
+		for (unsigned l = 0; l < k && !seen; l++)
+		    seen = picked[l] == j;
+		if (!seen)
+		    picked[k++] = j;
+	    }
+	}
+	for (unsigned l = 0; l < k; l++) {
+	    ef(picked[l], i);
+	    ends[n_ends++] = picked[l];
+	    ends[n_ends++] = i;
+	}
+    }
+
+    free(picked);
+    free(ends);
+}
+
+DEFINE_LIST(adj, unsigned)
+
+/* makeRandomDAG:
+ * A random recursive tree, in which each node after the first has a random
+ * earlier parent, plus random edges between the remaining pairs. Edges always
+ * go from the lower to the higher numbered node, so a directed graph is
+ * acyclic, and the tree keeps its depth, and hence dot's rank count,
+ * logarithmic in n. With fewer than n - 1 edges, the nodes the tree does not
+ * reach are emitted on their own. Duplicate edges are drawn again, so there
+ * are at most n(n-1)/2 edges.
+ */
+void makeRandomDAG(unsigned n, unsigned e, edgefn ef) {
+    if (n == 1) {
+	ef(1, 0);
+	return;
+    }
+    initRandom();
+
+    const unsigned max_e = n % 2 == 0 ? n / 2 * (n - 1) : (n - 1) / 2 * n;
+    if (e > max_e)
+	e = max_e;
+
+    // higher numbered neighbors of each node, for finding duplicates
+    adj_t *adj = gv_calloc((size_t)n + 1, sizeof(adj_t));
+
+    unsigned added = 0;
+    for (unsigned i = 2; i <= n; i++) {
+	if (added == e) {
+	    ef(i, 0);
+	    continue;
+	}
+	const unsigned a = rnd(i - 1) + 1;
+	ef(a, i);
+	adj_append(&adj[a], i);
+	added++;
+    }
+    while (added < e) {
+	unsigned a = rnd(n) + 1;
+	unsigned b = rnd(n - 1) + 1;
+	if (b >= a)
+	    b++;
+	if (b < a) {
+	    const unsigned t = a;
+	    a = b;
+	    b = t;
+	}
+	bool seen = false;
+	for (size_t i = 0; i < adj_size(&adj[a]) && !seen; i++)
+	    seen = adj_get(&adj[a], i) == b;
+	if (seen)
+	    continue;
+	ef(a, b);
+	adj_append(&adj[a], b);
+	added++;
+    }
+
+    for (unsigned i = 1; i <= n; i++)
+	adj_free(&adj[i]);
+    free(adj);
+}
+
 void makeMobius(unsigned w, unsigned h, edgefn ef) {
     if (h == 1) {
 	fprintf(stderr, "Warning: degenerate Moebius strip of %u vertices\n", w);
@@ -555,13 +696,9 @@ static unsigned *genCnt(unsigned NN) {
     return T;
 }
 
-static double 
-drand(void)
-{
-    double d;
-    d = rand();
-    d = d / RAND_MAX;
-    return d;
+/// a random number in [0, 1]
+static double drand(void) {
+    return (double)(rndBits() >> 11) / (double)((UINT64_C(1) << 53) - 1);
 }
 
 static void genTree(unsigned NN, unsigned *T, int_stack_t *stack,
@@ -586,8 +723,8 @@ static void genTree(unsigned NN, unsigned *T, int_stack_t *stack,
 		J = 0;
 		do {
 		    J++;
+		    if (M <= D) break; // M is unsigned, so check before it wraps
 		    M -= D;
-		    if (M < 1) break;
 		    if (Z <= T[M] * TD) {
                       more = false;
                       break;
@@ -637,7 +774,7 @@ treegen_t *makeTreeGen(unsigned N) {
     tg->T = genCnt(N);
     tg->sp = (int_stack_t){0};
     tg->tp = mkTree(N+1);
-    srand((unsigned)time(0));
+    initRandom();
 
     return tg;
 }
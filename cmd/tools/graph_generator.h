@@ -31,6 +31,12 @@ extern void makeHypercube(unsigned, edgefn);
 extern void makeTree(unsigned, unsigned, edgefn);
 extern void makeTriMesh(unsigned, edgefn);
 extern void makeMobius(unsigned, unsigned, edgefn);
+extern void makePowerLaw(unsigned, unsigned, edgefn);
+extern void makeRandomDAG(unsigned, unsigned, edgefn);
+
+/// fix the seed of the random graph and tree generators, which otherwise
+/// seed themselves from the clock
+extern void seedRandom(unsigned);
 
 typedef struct treegen_s treegen_t;
 extern treegen_t *makeTreeGen(unsigned);
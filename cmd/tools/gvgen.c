@@ -31,7 +31,7 @@
 
 typedef enum { unknown, grid, circle, complete, completeb, 
     path, tree, torus, cylinder, mobius, randomg, randomt, ball,
-    sierpinski, hypercube, star, wheel, trimesh
+    sierpinski, hypercube, star, wheel, trimesh, powerlaw, randomdag
 } GraphType;
 
 typedef struct {
@@ -52,6 +52,8 @@ typedef struct {
 static char *cmd;
 
 static char *Usage = "Usage: %s [-dv?] [options]\n\
+ -a<x>,<m>     : power law graph of x nodes, each added with m edges\n\
+ -A<x>,<e>     : random acyclic graph of x nodes and e edges\n\
  -c<n>         : cycle \n\
  -C<x,y>       : cylinder \n\
  -g[f]<h,w>    : grid (folded if f is used)\n\
@@ -77,6 +79,7 @@ static char *Usage = "Usage: %s [-dv?] [options]\n\
  -T<x,y>       : torus \n\
  -T<x,y,t1,t2> : twisted torus \n\
  -w<x>         : wheel\n\
+ -z<n>         : seed random graphs with <n> (default: the time)\n\
  -d            : directed graph\n\
  -v            : verbose mode\n\
  -?            : print usage\n";
@@ -132,10 +135,11 @@ static int setOne(char *s, opts_t* opts)
   return readOne(s, &opts->graphSize1);
 }
 
-/* setTwo:
+/* setTwoMin:
+ * Read 2 numbers, the second being at least min.
  * Return non-zero on error.
  */
-static int setTwo(char *s, opts_t* opts)
+static int setTwoMin(char *s, opts_t *opts, unsigned min)
 {
     char *next;
 
@@ -151,13 +155,21 @@ static int setTwo(char *s, opts_t* opts)
 
     s = next + 1;
     d = readPos(s, &(char *){NULL});
-    if (d > 1) {
+    if (d >= min) {
 	opts->graphSize2 = d;
 	return 0;
     }
     return -1;
 }
 
+/* setTwo:
+ * Return non-zero on error.
+ */
+static int setTwo(char *s, opts_t* opts)
+{
+    return setTwoMin(s, opts, 2);
+}
+
 /* setTwoTwoOpt:
  * Read 2 numbers
  * Read 2 more optional numbers
@@ -242,7 +254,7 @@ static char* setFold(char *s, opts_t* opts)
     return next;
 }
 
-static char *optList = ":i:M:m:n:N:c:C:dg:G:h:k:b:B:o:p:r:R:s:S:X:t:T:vw:";
+static char *optList = ":a:A:i:M:m:n:N:c:C:dg:G:h:k:b:B:o:p:r:R:s:S:X:t:T:vw:z:";
 
 static GraphType init(int argc, char *argv[], opts_t* opts)
 {
@@ -253,6 +265,16 @@ static GraphType init(int argc, char *argv[], opts_t* opts)
     opterr = 0;
     while ((c = getopt(argc, argv, optList)) != -1) {
 	switch (c) {
+	case 'a':
+	    graphType = powerlaw;
+	    if (setTwoMin(optarg, opts, 1))
+		errexit(c);
+	    break;
+	case 'A':
+	    graphType = randomdag;
+	    if (setTwoMin(optarg, opts, 1))
+		errexit(c);
+	    break;
 	case 'c':
 	    graphType = circle;
 	    if (setOne(optarg, opts))
@@ -366,6 +388,13 @@ static GraphType init(int argc, char *argv[], opts_t* opts)
 	    if (setOne(optarg, opts))
 		errexit(c);
 	    break;
+	case 'z': {
+	    unsigned seed;
+	    if (readOne(optarg, &seed))
+		errexit(c);
+	    seedRandom(seed);
+	    break;
+	}
 	case '?':
 	    if (optopt == '?')
 		usage(0);
@@ -504,6 +533,12 @@ int main(int argc, char *argv[])
     case wheel:
 	makeWheel(opts.graphSize1, ef);
 	break;
+    case powerlaw:
+	makePowerLaw(opts.graphSize1, opts.graphSize2, ef);
+	break;
+    case randomdag:
+	makeRandomDAG(opts.graphSize1, opts.graphSize2, ef);
+	break;
     default:
 	/* can't happen */
 	break;
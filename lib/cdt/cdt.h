@@ -122,6 +122,7 @@ struct _dtstat_s
 
 /* supported storage methods */
 #define DT_SET		0000001	/* set with unique elements		*/
+#define DT_FSET		0000002	/* set in a flat open addressing table	*/
 #define DT_OSET		0000004	/* ordered set (self-adjusting tree)	*/
 #define DT_OBAG		0000010	/* ordered multiset			*/
 #define DT_QUEUE	0000100	/* queue: insert at top, delete at tail	*/
@@ -142,6 +143,7 @@ struct _dtstat_s
 #define DT_DETACH	0010000	/* detach an object from the dictionary	*/
 
 CDT_API extern Dtmethod_t* 	Dtset; ///< set with unique elements
+CDT_API extern Dtmethod_t* 	Dtfset; ///< set in a flat open addressing table
 CDT_API extern Dtmethod_t* 	Dtoset; ///< ordered set (self-adjusting tree)
 CDT_API extern Dtmethod_t* 	Dtobag; ///< ordered multiset
 CDT_API extern Dtmethod_t*	Dtqueue; ///< queue: insert at top, delete at tail
@@ -1,5 +1,6 @@
 #include	<cdt/dthdr.h>
 #include	<stddef.h>
+#include	<string.h>
 
 /*	Change discipline.
 **	dt :	dictionary
@@ -43,6 +44,10 @@ Dtdisc_t *dtdisc(Dt_t *dt, Dtdisc_t *disc) {
 			while(s < ends)
 				*s++ = NULL;
 		}
+		else if((dt->data->type&DT_FSET) && dt->data->ntab > 0)
+		{	memset(FSCTRL(dt->data), FS_EMPTY, dt->data->ntab);
+			FSDELETED(dt->data) = 0;
+		}
 
 		/* reinsert them */
 		while(r)
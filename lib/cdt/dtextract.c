@@ -1,5 +1,6 @@
 #include	<cdt/dthdr.h>
 #include	<stddef.h>
+#include	<string.h>
 
 /*	Extract objects of a dictionary.
 **
@@ -17,6 +18,13 @@ Dtlink_t* dtextract(Dt_t* dt)
 		for(ends = (s = dt->data->htab) + dt->data->ntab; s < ends; ++s)
 			*s = NULL;
 	}
+	else if(dt->data->type&DT_FSET)
+	{	list = dtflatten(dt);
+		if(dt->data->ntab > 0)
+		{	memset(FSCTRL(dt->data), FS_EMPTY, dt->data->ntab);
+			FSDELETED(dt->data) = 0;
+		}
+	}
 	else /*if(dt->data->type&(DT_LIST|DT_STACK|DT_QUEUE))*/
 	{	list = dt->data->head;
 		dt->data->head = NULL;
@@ -0,0 +1,409 @@
+#include	<cdt/dthdr.h>
+#include	<limits.h>
+#include	<stdint.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+/*	Flat hash set.
+**	Links are kept in one open addressing table. Beside each slot is a
+**	control byte holding 7 bits of the object's hash, or a marker for an
+**	empty or deleted slot. Probes look at FS_GROUP control bytes at once,
+**	so most lookups touch a single cache line and compare at most one key.
+**	Walks visit objects in table order.
+**
+**	dt:	dictionary
+**	obj:	what to look for
+**	type:	type of search
+*/
+
+#define FS_NOSLOT	SIZE_MAX
+#define FS_LSBS		UINT64_C(0x0101010101010101)
+#define FS_MSBS		UINT64_C(0x8080808080808080)
+
+/* finish a string hash so that both its low and high bits are well mixed */
+static unsigned fsmix(unsigned h)
+{
+	uint32_t x = (uint32_t)h;
+	x ^= x >> 16;
+	x *= UINT32_C(0x85ebca6b);
+	x ^= x >> 13;
+	x *= UINT32_C(0xc2b2ae35);
+	x ^= x >> 16;
+	return (unsigned)x;
+}
+
+static unsigned fshash(Dtdisc_t* disc, void* key)
+{
+	return fsmix(dtstrhash(key, disc->size));
+}
+
+/* 7 bit fragment of a hash stored in a control byte */
+#define FSH2(h)		((unsigned)((h) >> 25))
+
+/* control bytes of a group, first slot in the least significant byte */
+static uint64_t fsgroup(const unsigned char* c)
+{
+	uint64_t w = 0;
+	for(int i = FS_GROUP - 1; i >= 0; --i)
+		w = (w << 8) | c[i];
+	return w;
+}
+
+/* bytes equal to h2; may give false positives, which key checks weed out */
+static uint64_t fsmatch(uint64_t w, unsigned h2)
+{
+	uint64_t x = w ^ (FS_LSBS * h2);
+	return (x - FS_LSBS) & ~x & FS_MSBS;
+}
+
+static uint64_t fsmatchempty(uint64_t w)
+{
+	return w & ~(w << 6) & FS_MSBS;
+}
+
+static uint64_t fsmatchfree(uint64_t w)
+{
+	return w & ~(w << 7) & FS_MSBS;
+}
+
+/* index within a group of the lowest byte flagged in a match mask */
+static size_t fsfirst(uint64_t m)
+{
+	size_t i = 0;
+	while(!(m & 0x80))
+	{	m >>= 8;
+		++i;
+	}
+	return i;
+}
+
+/* iterate the groups of the probe sequence for a hash */
+#define FSPROBE(d,h,g,step) \
+	for(size_t mask_ = (size_t)(d)->ntab / FS_GROUP - 1, step = 0, \
+	    g = ((size_t)(h) & mask_) * FS_GROUP; ; \
+	    ++step, g = ((g / FS_GROUP + step) & mask_) * FS_GROUP)
+
+/* find the slot of the object with the given key */
+static size_t fsfind(Dt_t* dt, void* key, unsigned hsh)
+{
+	Dtdata_t*	data = dt->data;
+	Dtdisc_t*	disc = dt->disc;
+	unsigned char*	ctrl;
+	int		lk, sz, ky;
+	Dtcompar_f	cmpf;
+
+	if(data->ntab <= 0)
+		return FS_NOSLOT;
+	ctrl = FSCTRL(data);
+	_DTDSC(disc,ky,sz,lk,cmpf);
+
+	FSPROBE(data, hsh, g, step)
+	{	uint64_t w = fsgroup(ctrl + g);
+		for(uint64_t m = fsmatch(w, FSH2(hsh)); m; m &= m - 1)
+		{	size_t i = g + fsfirst(m);
+			Dtlink_t* t = data->htab[i];
+			if(FSFULL(ctrl[i]) && t->hash == hsh)
+			{	void* k = _DTOBJ(t,lk);
+				k = _DTKEY(k,ky,sz);
+				if(_DTCMP(dt,key,k,disc,cmpf,sz) == 0)
+					return i;
+			}
+		}
+		if(fsmatchempty(w))
+			return FS_NOSLOT;
+	}
+}
+
+/* find the slot holding a given link */
+static size_t fsfindlink(Dtdata_t* data, Dtlink_t* t)
+{
+	unsigned char*	ctrl;
+
+	if(data->ntab <= 0)
+		return FS_NOSLOT;
+	ctrl = FSCTRL(data);
+
+	FSPROBE(data, t->hash, g, step)
+	{	uint64_t w = fsgroup(ctrl + g);
+		for(uint64_t m = fsmatch(w, FSH2(t->hash)); m; m &= m - 1)
+		{	size_t i = g + fsfirst(m);
+			if(FSFULL(ctrl[i]) && data->htab[i] == t)
+				return i;
+		}
+		if(fsmatchempty(w))
+			return FS_NOSLOT;
+	}
+}
+
+/* put a link in the first free slot of its probe sequence */
+static void fsplace(Dtdata_t* data, Dtlink_t* t)
+{
+	unsigned char*	ctrl = FSCTRL(data);
+
+	FSPROBE(data, t->hash, g, step)
+	{	uint64_t m = fsmatchfree(fsgroup(ctrl + g));
+		if(m)
+		{	size_t i = g + fsfirst(m);
+			if(ctrl[i] == FS_DELETED)
+				FSDELETED(data) -= 1;
+			data->htab[i] = t;
+			ctrl[i] = (unsigned char)FSH2(t->hash);
+			return;
+		}
+	}
+}
+
+/* resize the table to hold at least `size` objects at a low load */
+static int fsresize(Dtdata_t* data, size_t size)
+{
+	Dtlink_t	**olds = data->htab;
+	unsigned char	*oldc;
+	size_t		n, oldn = (size_t)data->ntab;
+
+	for(n = FS_GROUP * 2; n / 2 < size; n <<= 1)
+		;
+	if(n > INT_MAX)
+		return -1;
+
+	Dtlink_t** s = malloc(n * sizeof(Dtlink_t*) + n + sizeof(size_t));
+	if(!s)
+		return -1;
+	data->htab = s;
+	data->ntab = (int)n;
+	memset(FSCTRL(data), FS_EMPTY, n);
+	FSDELETED(data) = 0;
+
+	if(oldn > 0)
+	{	oldc = (unsigned char*)(olds + oldn);
+		for(size_t i = 0; i < oldn; ++i)
+			if(FSFULL(oldc[i]))
+				fsplace(data, olds[i]);
+		free(olds);
+	}
+	return 0;
+}
+
+/* make room for one more object */
+static int fsreserve(Dt_t* dt)
+{
+	Dtdata_t*	data = dt->data;
+	size_t		used, n = (size_t)data->ntab;
+
+	if(n == 0)
+		return fsresize(data, 1);
+
+	/* keep the load at most 7/8, counting deleted slots, so that probe
+	 * sequences always end; avoid reordering the table during a walk unless
+	 * it is about to fill up
+	 */
+	used = (size_t)data->size + FSDELETED(data) + 1;
+	if(used * 8 <= n * 7 || (data->loop > 0 && used < n))
+		return 0;
+	return fsresize(data, (size_t)data->size + 1);
+}
+
+/* remove the object in a slot from the table */
+static void fsremove(Dtdata_t* data, size_t i)
+{
+	unsigned char*	ctrl = FSCTRL(data);
+
+	/* a slot in a group that has never been full cannot be on a probe
+	 * sequence that continues past it, so it can become empty again
+	 */
+	size_t g = i - i % FS_GROUP;
+	if(fsmatchempty(fsgroup(ctrl + g)))
+		ctrl[i] = FS_EMPTY;
+	else
+	{	ctrl[i] = FS_DELETED;
+		FSDELETED(data) += 1;
+	}
+}
+
+void _dtfunlink(Dt_t* dt, Dtlink_t* e)
+{
+	size_t	i = fsfindlink(dt->data, e);
+
+	if(i != FS_NOSLOT)
+		fsremove(dt->data, i);
+}
+
+static void* dtfhash(Dt_t* dt, void* obj, int type)
+{
+	Dtlink_t	*t, *r;
+	void		*key;
+	unsigned	hsh;
+	int		lk, sz, ky;
+	Dtcompar_f	cmpf;
+	Dtdisc_t*	disc;
+	Dtdata_t*	data = dt->data;
+	unsigned char*	ctrl;
+	size_t		i, n;
+
+	UNFLATTEN(dt);
+
+	/* initialize discipline data */
+	disc = dt->disc; _DTDSC(disc,ky,sz,lk,cmpf);
+	(void)cmpf;
+	n = (size_t)data->ntab;
+	ctrl = n > 0 ? FSCTRL(data) : NULL;
+
+	if(!obj)
+	{	if(type&(DT_NEXT|DT_PREV))
+			goto end_walk;
+
+		if(data->size <= 0 || !(type&(DT_CLEAR|DT_FIRST|DT_LAST)) )
+			return NULL;
+
+		if(type&DT_CLEAR)
+		{	/* clean out all objects */
+			for(i = 0; i < n; ++i)
+			{	if(!FSFULL(ctrl[i]))
+					continue;
+				t = data->htab[i];
+				if(disc->freef)
+					disc->freef(_DTOBJ(t,lk), disc);
+				if(disc->link < 0)
+					free(t);
+			}
+			memset(ctrl, FS_EMPTY, n);
+			FSDELETED(data) = 0;
+			data->here = NULL;
+			data->size = 0;
+			data->loop = 0;
+			return NULL;
+		}
+		else	/* computing the first/last object */
+		{	t = NULL;
+			if(type&DT_FIRST)
+			{	for(i = 0; i < n && !t; ++i)
+					if(FSFULL(ctrl[i]))
+						t = data->htab[i];
+			}
+			else
+			{	for(i = n; i > 0 && !t; --i)
+					if(FSFULL(ctrl[i - 1]))
+						t = data->htab[i - 1];
+			}
+
+			data->loop += 1;
+			data->here = t;
+			return t ? _DTOBJ(t,lk) : NULL;
+		}
+	}
+
+	if(type&(DT_MATCH|DT_SEARCH|DT_INSERT) )
+	{	key = (type&DT_MATCH) ? obj : _DTKEY(obj,ky,sz);
+		hsh = fshash(disc, key);
+		i = fsfind(dt, key, hsh);
+	}
+	else if(type&(DT_RENEW|DT_VSEARCH) )
+	{	r = obj;
+		obj = _DTOBJ(r,lk);
+		key = _DTKEY(obj,ky,sz);
+		hsh = fshash(disc, key);
+		i = fsfind(dt, key, hsh);
+	}
+	else /*if(type&(DT_DELETE|DT_DETACH|DT_NEXT|DT_PREV))*/
+	{	if((t = data->here) && _DTOBJ(t,lk) == obj)
+			i = fsfindlink(data, t);
+		else
+		{	key = _DTKEY(obj,ky,sz);
+			hsh = fshash(disc, key);
+			i = fsfind(dt, key, hsh);
+		}
+	}
+	t = i == FS_NOSLOT ? NULL : data->htab[i];
+
+	if(type&(DT_MATCH|DT_SEARCH|DT_VSEARCH))
+	{	if(!t)
+			return NULL;
+		data->here = t;
+		return _DTOBJ(t,lk);
+	}
+	else if(type&DT_INSERT)
+	{	if(t)
+		{	data->here = t;
+			return _DTOBJ(t,lk);
+		}
+
+		if(disc->makef && !(obj = disc->makef(obj, disc)))
+			return NULL;
+		if(lk >= 0)
+			r = _DTLNK(obj,lk);
+		else
+		{	r = malloc(sizeof(Dthold_t));
+			if(r)
+				((Dthold_t*)r)->obj = obj;
+			else
+			{	if(disc->makef && disc->freef)
+					disc->freef(obj, disc);
+				return NULL;
+			}
+		}
+		r->hash = hsh;
+
+		/* insert object */
+	do_insert:
+		if(fsreserve(dt) != 0)
+		{	if(disc->freef && (type&DT_INSERT))
+				disc->freef(obj, disc);
+			if(disc->link < 0)
+				free(r);
+			return NULL;
+		}
+		fsplace(data, r);
+		data->size += 1;
+		data->here = r;
+		return obj;
+	}
+	else if(type&DT_RENEW)
+	{	if(!t)
+		{	r->hash = hsh;
+			goto do_insert;
+		}
+		if(disc->freef)
+			disc->freef(obj, disc);
+		if(disc->link < 0)
+			free(r);
+		return _DTOBJ(t,lk);
+	}
+	else if(type&(DT_NEXT|DT_PREV))
+	{	t = NULL;
+		if(i != FS_NOSLOT)
+		{	if(type&DT_NEXT)
+			{	for(++i; i < n && !t; ++i)
+					if(FSFULL(ctrl[i]))
+						t = data->htab[i];
+			}
+			else
+			{	for(; i > 0 && !t; --i)
+					if(FSFULL(ctrl[i - 1]))
+						t = data->htab[i - 1];
+			}
+		}
+		if(!(data->here = t) )
+		{ end_walk:
+			if((data->loop -= 1) < 0)
+				data->loop = 0;
+			return NULL;
+		}
+		return _DTOBJ(t,lk);
+	}
+	else /*if(type&(DT_DELETE|DT_DETACH))*/
+	{	/* take an element out of the dictionary */
+		if(!t)
+			return NULL;
+		fsremove(data, i);
+		data->size -= 1;
+		obj = _DTOBJ(t,lk);
+		data->here = NULL;
+		if(disc->freef && (type&DT_DELETE))
+			disc->freef(obj, disc);
+		if(disc->link < 0)
+			free(t);
+		return obj;
+	}
+}
+
+static Dtmethod_t	_Dtfset = { dtfhash, DT_FSET };
+Dtmethod_t* Dtfset = &_Dtfset;
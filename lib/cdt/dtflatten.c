@@ -28,6 +28,19 @@ Dtlink_t* dtflatten(Dt_t* dt)
 			}
 		}
 	}
+	else if(dt->data->type&DT_FSET)
+	{	unsigned char*	ctrl = FSCTRL(dt->data);
+		s = dt->data->htab;
+		for(int i = 0; i < dt->data->ntab; ++i)
+		{	if(FSFULL(ctrl[i]))
+			{	if(last)
+					last = last->right = s[i];
+				else	list = last = s[i];
+			}
+		}
+		if(last)
+			last->right = NULL;
+	}
 	else if(dt->data->type&DT_QUEUE)
 		list = dt->data->head;
 	else if((r = dt->data->here) ) /*if(dt->data->type&(DT_OSET|DT_OBAG))*/
@@ -24,6 +24,16 @@
 #define HLOAD(s)	((s) << 1)
 #define HINDEX(n,h)	((h)&((n)-1))
 
+/* flat hash set layout: ntab slots, then ntab control bytes, then the count
+ * of deleted slots, all in the one allocation at htab
+ */
+#define FS_GROUP	8	/* control bytes examined per probe	*/
+#define FS_EMPTY	0x80	/* slot has never been used		*/
+#define FS_DELETED	0xfe	/* slot held an object now deleted	*/
+#define FSFULL(c)	((c) < 0x80)
+#define FSCTRL(d)	((unsigned char*)((d)->htab + (d)->ntab))
+#define FSDELETED(d)	(*(size_t*)(FSCTRL(d) + (d)->ntab))
+
 #define UNFLATTEN(dt) \
 		((dt->data->type&DT_FLATTEN) ? dtrestore(dt,NULL) : 0)
 
@@ -35,3 +45,6 @@
 
 #define RROTATE(x,y)	(rrotate(x,y), (x) = (y))
 #define LROTATE(x,y)	(lrotate(x,y), (x) = (y))
+
+/* remove a link from a flat hash set without changing its size */
+void _dtfunlink(Dt_t*, Dtlink_t*);
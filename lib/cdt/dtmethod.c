@@ -20,7 +20,7 @@ Dtmethod_t* dtmethod(Dt_t* dt, Dtmethod_t* meth)
 
 	if(dt->data->type&DT_QUEUE)
 		dt->data->head = NULL;
-	else if(dt->data->type&DT_SET)
+	else if(dt->data->type&(DT_SET|DT_FSET))
 	{	if(dt->data->ntab > 0)
 			free(dt->data->htab);
 		dt->data->ntab = 0;
@@ -52,7 +52,15 @@ Dtmethod_t* dtmethod(Dt_t* dt, Dtmethod_t* meth)
 			list = r;
 		}
 	}
-	else if(oldmeth->type&DT_SET)
+	else if(meth->type&DT_FSET)
+	{	dt->data->size = dt->data->loop = 0;
+		while(list)
+		{	r = list->right;
+			(void)meth->searchf(dt, list, DT_RENEW);
+			list = r;
+		}
+	}
+	else if(meth->type&DT_SET)
 	{	int	rehash;
 		if((meth->type&DT_SET) && !(oldmeth->type&DT_SET))
 			rehash = 1;
@@ -33,6 +33,10 @@ void* dtrenew(Dt_t* dt, void* obj)
 			}
 		}
 	}
+	else if(dt->data->type&DT_FSET)
+	{	_dtfunlink(dt, e);
+		dt->data->here = NULL;
+	}
 	else /*if(dt->data->type&(DT_SET|DT_BAG))*/
 	{	s = dt->data->htab + HINDEX(dt->data->ntab,e->hash);
 		if((t = *s) == e)
@@ -47,6 +47,17 @@ int dtrestore(Dt_t* dt, Dtlink_t* list)
 			}
 		}
 	}
+	else if(dt->data->type&DT_FSET)
+	{	dt->data->here = NULL;
+		if(!type) /* restoring an extracted list of elements */
+		{	dt->data->size = 0;
+			while(list)
+			{	t = list->right;
+				searchf(dt, list, DT_RENEW);
+				list = t;
+			}
+		}
+	}
 	else
 	{	if(dt->data->type&(DT_OSET|DT_OBAG))
 			dt->data->here = list;
@@ -26,6 +26,8 @@ namespace CGraph {
 class AGRAPH_API AGraph {
 public:
   explicit AGraph(const std::string &dot);
+  // take ownership of an existing root graph
+  explicit AGraph(Agraph_t *g) : m_g(g) {}
   ~AGraph();
 
   // delete copy since we manage a C struct using a raw pointer and the struct
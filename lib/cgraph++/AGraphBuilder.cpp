@@ -0,0 +1,142 @@
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "AGraph.h"
+#include "AGraphBuilder.h"
+
+namespace CGraph {
+
+AGraphBuilder::AGraphBuilder(std::string name, Agdesc_t desc)
+    : m_name(std::move(name)), m_desc(desc) {}
+
+void AGraphBuilder::reserve(std::size_t nodes, std::size_t edges) {
+  m_nodes.reserve(nodes);
+  m_tails.reserve(edges);
+  m_heads.reserve(edges);
+}
+
+std::size_t AGraphBuilder::add_node(std::string name) {
+  m_nodes.push_back(std::move(name));
+  return m_nodes.size() - 1;
+}
+
+std::size_t AGraphBuilder::add_edge(std::size_t tail, std::size_t head) {
+  if (tail >= m_nodes.size() || head >= m_nodes.size()) {
+    throw std::out_of_range("Edge end point is not a node");
+  }
+  m_tails.push_back(tail);
+  m_heads.push_back(head);
+  return m_tails.size() - 1;
+}
+
+std::size_t AGraphBuilder::declare_node_attr(const std::string &name,
+                                             std::string_view default_value) {
+  m_node_attrs.push_back({name, intern(default_value)});
+  return m_node_attrs.size() - 1;
+}
+
+std::size_t AGraphBuilder::declare_edge_attr(const std::string &name,
+                                             std::string_view default_value) {
+  m_edge_attrs.push_back({name, intern(default_value)});
+  return m_edge_attrs.size() - 1;
+}
+
+void AGraphBuilder::set_graph_attr(const std::string &name,
+                                   std::string_view value) {
+  m_graph_attrs.emplace_back(name, intern(value));
+}
+
+std::size_t AGraphBuilder::intern(std::string_view value) {
+  if (const auto it = m_value_index.find(value); it != m_value_index.end()) {
+    return it->second;
+  }
+  const auto [it, inserted] =
+      m_value_index.emplace(std::string(value), m_values.size());
+  m_values.push_back(&it->first);
+  return it->second;
+}
+
+void AGraphBuilder::set_node_attr(std::size_t node, std::size_t attr,
+                                  std::size_t value) {
+  if (node >= m_nodes.size() || attr >= m_node_attrs.size() ||
+      value >= m_values.size()) {
+    throw std::out_of_range("Unknown node, attribute or value");
+  }
+  m_node_settings.push_back({node, attr, value});
+}
+
+void AGraphBuilder::set_edge_attr(std::size_t edge, std::size_t attr,
+                                  std::size_t value) {
+  if (edge >= m_tails.size() || attr >= m_edge_attrs.size() ||
+      value >= m_values.size()) {
+    throw std::out_of_range("Unknown edge, attribute or value");
+  }
+  m_edge_settings.push_back({edge, attr, value});
+}
+
+AGraph AGraphBuilder::finish() {
+  Agraph_t *root = agopen(m_name.data(), m_desc, nullptr);
+  if (!root) {
+    throw std::runtime_error("Could not create graph");
+  }
+  AGraph g(root);
+
+  auto value = [&](std::size_t index) { return m_values[index]->c_str(); };
+
+  for (const auto &[name, v] : m_graph_attrs) {
+    agattr(root, AGRAPH, const_cast<char *>(name.c_str()), value(v));
+  }
+  std::vector<Agsym_t *> node_syms;
+  node_syms.reserve(m_node_attrs.size());
+  for (const auto &attr : m_node_attrs) {
+    node_syms.push_back(agattr(root, AGNODE,
+                               const_cast<char *>(attr.name.c_str()),
+                               value(attr.default_value)));
+  }
+  std::vector<Agsym_t *> edge_syms;
+  edge_syms.reserve(m_edge_attrs.size());
+  for (const auto &attr : m_edge_attrs) {
+    edge_syms.push_back(agattr(root, AGEDGE,
+                               const_cast<char *>(attr.name.c_str()),
+                               value(attr.default_value)));
+  }
+
+  std::vector<char *> names;
+  names.reserve(m_nodes.size());
+  for (auto &name : m_nodes) {
+    names.push_back(name.data());
+  }
+  std::vector<Agnode_t *> nodes(m_nodes.size());
+  agnodes(root, names.data(), names.size(), nodes.data());
+
+  std::vector<Agnode_t *> tails;
+  std::vector<Agnode_t *> heads;
+  tails.reserve(m_tails.size());
+  heads.reserve(m_heads.size());
+  for (std::size_t i = 0; i < m_tails.size(); ++i) {
+    tails.push_back(nodes[m_tails[i]]);
+    heads.push_back(nodes[m_heads[i]]);
+  }
+  std::vector<Agedge_t *> edges(m_tails.size());
+  agedges(root, tails.data(), heads.data(), edges.size(), edges.data());
+
+  for (const auto &s : m_node_settings) {
+    agxset(nodes[s.object], node_syms[s.attr], value(s.value));
+  }
+  for (const auto &s : m_edge_settings) {
+    // edges that the graph does not allow, like loops in a graph without
+    // loops, are not created
+    if (edges[s.object] != nullptr) {
+      agxset(edges[s.object], edge_syms[s.attr], value(s.value));
+    }
+  }
+
+  *this = AGraphBuilder(std::move(m_name), m_desc);
+  return g;
+}
+
+} // namespace CGraph
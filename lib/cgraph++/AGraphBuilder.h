@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "AGraph.h"
+#include "cgraph.h"
+
+#ifdef GVDLL
+#if cgraph___EXPORTS // CMake's substitution of cgraph++_EXPORTS
+#define AGRAPHBUILDER_API __declspec(dllexport)
+#else
+#define AGRAPHBUILDER_API __declspec(dllimport)
+#endif
+#endif
+
+#ifndef AGRAPHBUILDER_API
+#define AGRAPHBUILDER_API /* nothing */
+#endif
+
+namespace CGraph {
+
+/**
+ * @brief The AGraphBuilder class constructs a graph in bulk
+ *
+ * Nodes, edges and attribute values are recorded by index and only turned
+ * into a cgraph graph by finish(), which creates them with @ref agnodes and
+ * @ref agedges. This avoids writing a graph as DOT only to parse it again.
+ * Attribute values are interned, so each distinct value is stored once.
+ */
+
+class AGRAPHBUILDER_API AGraphBuilder {
+public:
+  explicit AGraphBuilder(std::string name = "", Agdesc_t desc = Agdirected);
+
+  // delete copy since interned values are referred to by pointers into the
+  // index of the builder they were interned in
+  AGraphBuilder(const AGraphBuilder &) = delete;
+  AGraphBuilder &operator=(const AGraphBuilder &) = delete;
+
+  // moving the index takes its entries along, so those pointers stay valid
+  AGraphBuilder(AGraphBuilder &&) = default;
+  AGraphBuilder &operator=(AGraphBuilder &&) = default;
+
+  // make room for the given numbers of nodes and edges
+  void reserve(std::size_t nodes, std::size_t edges);
+
+  // add a node and return its index. Adding a name that was already added
+  // returns a new index that refers to the same node.
+  std::size_t add_node(std::string name);
+
+  // add an edge between the nodes with the given indices and return its index
+  std::size_t add_edge(std::size_t tail, std::size_t head);
+
+  // declare a node or edge attribute and return its index
+  std::size_t declare_node_attr(const std::string &name,
+                                std::string_view default_value = "");
+  std::size_t declare_edge_attr(const std::string &name,
+                                std::string_view default_value = "");
+
+  // set an attribute of the graph itself
+  void set_graph_attr(const std::string &name, std::string_view value);
+
+  // intern a value and return its index, for use with set_node_attr and
+  // set_edge_attr
+  std::size_t intern(std::string_view value);
+
+  // set the attribute with the given index of a node or an edge to the
+  // interned value with the given index
+  void set_node_attr(std::size_t node, std::size_t attr, std::size_t value);
+  void set_edge_attr(std::size_t edge, std::size_t attr, std::size_t value);
+
+  // create the graph. The builder is left empty.
+  AGraph finish();
+
+private:
+  struct Attribute {
+    std::string name;
+    std::size_t default_value; ///< index of an interned value
+  };
+
+  struct Setting {
+    std::size_t object;
+    std::size_t attr;
+    std::size_t value;
+  };
+
+  std::string m_name;
+  Agdesc_t m_desc;
+  std::vector<std::string> m_nodes;
+  std::vector<std::size_t> m_tails;
+  std::vector<std::size_t> m_heads;
+  std::vector<Attribute> m_node_attrs;
+  std::vector<Attribute> m_edge_attrs;
+  std::vector<std::pair<std::string, std::size_t>> m_graph_attrs;
+  std::vector<Setting> m_node_settings;
+  std::vector<Setting> m_edge_settings;
+  // allow looking up interned values by std::string_view
+  struct ValueHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view value) const {
+      return std::hash<std::string_view>{}(value);
+    }
+  };
+  std::unordered_map<std::string, std::size_t, ValueHash, std::equal_to<>>
+      m_value_index;
+  // the keys of m_value_index, by index
+  std::vector<const std::string *> m_values;
+};
+
+} // namespace CGraph
+
+#undef AGRAPHBUILDER_API
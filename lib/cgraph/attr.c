@@ -198,7 +198,7 @@ static Agrec_t *agmakeattrs(Agraph_t * context, void *obj)
 	rec->str = agalloc(agraphof(obj), (size_t) sz * sizeof(char *));
 	/* doesn't call agxset() so no obj-modified callbacks occur */
 	for (sym = dtfirst(datadict); sym; sym = dtnext(datadict, sym))
-	    rec->str[sym->id] = agstrdup(agraphof(obj), sym->defval);
+	    rec->str[sym->id] = agstrdupref(agraphof(obj), sym->defval);
     } else {
 	assert(rec->dict == datadict);
     }
@@ -243,7 +243,7 @@ static void addattr(Agraph_t * g, Agobj_t * obj, Agsym_t * sym)
 						     sizeof(char *),
 						     ((size_t) sym->id +
 						      1) * sizeof(char *));
-    attr->str[sym->id] = agstrdup(g, sym->defval);
+    attr->str[sym->id] = agstrdupref(g, sym->defval);
 }
 
 static Agsym_t *getattr(Agraph_t *g, int kind, char *name) {
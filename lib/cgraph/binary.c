@@ -0,0 +1,662 @@
+/// @file
+/// @brief implements @ref agwritebin and @ref agreadbin
+/// @ingroup cgraph_graph
+///
+/// The binary graph format is a compact alternative to DOT for caching a
+/// graph, including any layout attributes attached to it, and reloading it
+/// without going through the scanner and parser. All integers are unsigned
+/// LEB128 varints. A file consists of:
+///
+///   magic      "\211GVB\r\n\032\n"
+///   version    varint, currently 1
+///   length     varint, number of bytes in the payload
+///   payload:
+///     strings  count, then per string: flags (1 = HTML-like), length,
+///              content and a terminating NUL
+///     graph    flags (1 = directed, 2 = strict, 4 = no loops), name
+///     symbols  for each of graph, node, edge: count, then per symbol in ID
+///              order: name, default, flags (1 = print, 2 = fixed)
+///     nodes    count, then per node: name, attributes
+///     edges    count, then per edge: tail index, head index, key + 1 (0 for
+///              no key), attributes
+///     root     subgraphs
+///
+/// where subgraphs are a count of subgraphs, each a name, its local graph,
+/// node and edge attribute declarations (each a count of symbol index,
+/// value, flags triples), its member node
+/// and edge indices (each a count followed by indices) and its own subgraphs,
+/// and attributes are a count of (symbol index, string index) pairs. Names,
+/// defaults and values are string indices. Nodes and edges only record
+/// attributes that differ from the root's defaults. Like DOT, subgraphs only
+/// record attributes declared locally and the root only its defaults, which
+/// are also its values.
+
+/*************************************************************************
+ * Copyright (c) 2011 AT&T Intellectual Property
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * https://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors: Details at https://graphviz.org
+ *************************************************************************/
+
+#include <assert.h>
+#include <cgraph/agxbuf.h>
+#include <cgraph/alloc.h>
+#include <cgraph/cghdr.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char MAGIC[] = "\211GVB\r\n\032\n";
+enum { MAGIC_LEN = sizeof(MAGIC) - 1 };
+
+enum { VERSION = 1 };
+
+enum { STR_HTML = 1 };
+
+enum { G_DIRECTED = 1, G_STRICT = 2, G_NO_LOOP = 4 };
+
+enum { SYM_PRINT = 1, SYM_FIXED = 2 };
+
+/// attribute kinds, in the order their symbols are written
+static const int KINDS[] = {AGRAPH, AGNODE, AGEDGE};
+enum { NKINDS = sizeof(KINDS) / sizeof(KINDS[0]) };
+
+static void put_varint(agxbuf *xb, uint64_t v) {
+  do {
+    unsigned char c = v & 0x7f;
+    v >>= 7;
+    if (v != 0) {
+      c |= 0x80;
+    }
+    agxbputc(xb, (char)c);
+  } while (v != 0);
+}
+
+/* writer */
+
+/// an entry in the writer's string table
+typedef struct {
+  Dtlink_t link;
+  char *s;
+  uint64_t id;
+} strent_t;
+
+static void strent_free(void *p, Dtdisc_t *disc) {
+  (void)disc;
+  free(p);
+}
+
+static Dtdisc_t Strentdisc = {
+    .key = (int)offsetof(strent_t, s),
+    .size = -1,
+    .link = (int)offsetof(strent_t, link),
+    .freef = strent_free,
+};
+
+typedef struct {
+  Agraph_t *root;
+  Dict_t *strings; ///< content → string index
+  agxbuf strtab;   ///< serialized string table
+  uint64_t nstrings;
+  agxbuf body;         ///< serialized graph following the string table
+  uint64_t *node_idx;  ///< node sequence number → node index
+  uint64_t *edge_idx;  ///< edge sequence number → edge index
+  Agsym_t **syms[NKINDS]; ///< symbol ID → root symbol, per kind
+  size_t nsyms[NKINDS];
+} writer_t;
+
+/// index of a string in the table, adding it if necessary
+static uint64_t strid(writer_t *w, char *s) {
+  strent_t key = {.s = s};
+  strent_t *e = dtsearch(w->strings, &key);
+  if (e == NULL) {
+    const size_t len = strlen(s);
+    e = gv_alloc(sizeof(strent_t) + len + 1);
+    e->s = (char *)(e + 1);
+    memcpy(e->s, s, len + 1);
+    e->id = w->nstrings++;
+    dtinsert(w->strings, e);
+
+    agxbputc(&w->strtab, aghtmlstr(s) ? STR_HTML : 0);
+    put_varint(&w->strtab, len);
+    agxbput_n(&w->strtab, s, len + 1);
+  }
+  return e->id;
+}
+
+static int kind_index(int kind) {
+  switch (kind) {
+  case AGRAPH:
+    return 0;
+  case AGNODE:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+/// write the attributes of obj that differ from base[symbol ID]
+static void write_attrs(writer_t *w, void *obj, char **base) {
+  const int k = kind_index(AGTYPE(obj));
+  Agattr_t *data = agattrrec(obj);
+  uint64_t cnt = 0;
+
+  if (data != NULL) {
+    for (size_t i = 0; i < w->nsyms[k]; ++i) {
+      if (data->str[i] != base[i]) {
+        ++cnt;
+      }
+    }
+  }
+  put_varint(&w->body, cnt);
+  if (cnt == 0) {
+    return;
+  }
+  for (size_t i = 0; i < w->nsyms[k]; ++i) {
+    if (data->str[i] != base[i]) {
+      put_varint(&w->body, i);
+      put_varint(&w->body, strid(w, data->str[i]));
+    }
+  }
+}
+
+static unsigned sym_flags(const Agsym_t *sym) {
+  return (sym->print ? SYM_PRINT : 0) | (sym->fixed ? SYM_FIXED : 0);
+}
+
+/// write the attributes declared locally in a subgraph
+static void write_local_defaults(writer_t *w, Dict_t *dict) {
+  Dict_t *view = dtview(dict, NULL);
+  put_varint(&w->body, (uint64_t)dtsize(dict));
+  for (Agsym_t *sym = dtfirst(dict); sym; sym = dtnext(dict, sym)) {
+    put_varint(&w->body, (uint64_t)sym->id);
+    put_varint(&w->body, strid(w, sym->defval));
+    agxbputc(&w->body, (char)sym_flags(sym));
+  }
+  dtview(dict, view);
+}
+
+static void write_subgraphs(writer_t *w, Agraph_t *g);
+
+static void write_subgraph(writer_t *w, Agraph_t *subg) {
+  put_varint(&w->body, strid(w, agnameof(subg)));
+
+  Agdatadict_t *dd = agdatadict(subg, false);
+  if (dd != NULL) {
+    write_local_defaults(w, dd->dict.g);
+    write_local_defaults(w, dd->dict.n);
+    write_local_defaults(w, dd->dict.e);
+  } else {
+    put_varint(&w->body, 0);
+    put_varint(&w->body, 0);
+    put_varint(&w->body, 0);
+  }
+
+  put_varint(&w->body, (uint64_t)agnnodes(subg));
+  for (Agnode_t *n = agfstnode(subg); n; n = agnxtnode(subg, n)) {
+    put_varint(&w->body, w->node_idx[AGSEQ(n)]);
+  }
+  put_varint(&w->body, (uint64_t)agnedges(subg));
+  for (Agnode_t *n = agfstnode(subg); n; n = agnxtnode(subg, n)) {
+    for (Agedge_t *e = agfstout(subg, n); e; e = agnxtout(subg, e)) {
+      put_varint(&w->body, w->edge_idx[AGSEQ(e)]);
+    }
+  }
+
+  write_subgraphs(w, subg);
+}
+
+static void write_subgraphs(writer_t *w, Agraph_t *g) {
+  put_varint(&w->body, (uint64_t)agnsubg(g));
+  for (Agraph_t *subg = agfstsubg(g); subg; subg = agnxtsubg(subg)) {
+    write_subgraph(w, subg);
+  }
+}
+
+int agwritebin(Agraph_t *g, void *chan,
+               size_t (*write)(void *chan, const char *buf, size_t len)) {
+  writer_t w = {.root = g};
+  int rv = 0;
+
+  assert(g == agroot(g) && "agwritebin can only write root graphs");
+  w.strings = dtopen(&Strentdisc, Dtoset);
+
+  // collect the root symbols of each kind in ID order
+  Agdatadict_t *dd = agdatadict(g, false);
+  for (int k = 0; k < NKINDS; ++k) {
+    Dict_t *dict = NULL;
+    if (dd != NULL) {
+      dict = KINDS[k] == AGRAPH ? dd->dict.g
+             : KINDS[k] == AGNODE ? dd->dict.n
+                                  : dd->dict.e;
+    }
+    w.nsyms[k] = dict ? (size_t)dtsize(dict) : 0;
+    w.syms[k] = gv_calloc(w.nsyms[k], sizeof(Agsym_t *));
+    if (dict != NULL) {
+      for (Agsym_t *sym = dtfirst(dict); sym; sym = dtnext(dict, sym)) {
+        assert(sym->id >= 0 && (size_t)sym->id < w.nsyms[k]);
+        w.syms[k][sym->id] = sym;
+      }
+    }
+  }
+
+  unsigned flags = 0;
+  if (agisdirected(g)) {
+    flags |= G_DIRECTED;
+  }
+  if (agisstrict(g)) {
+    flags |= G_STRICT;
+  }
+  if (g->desc.no_loop) {
+    flags |= G_NO_LOOP;
+  }
+  agxbputc(&w.body, (char)flags);
+  put_varint(&w.body, strid(&w, agnameof(g)));
+
+  char **defaults[NKINDS];
+  for (int k = 0; k < NKINDS; ++k) {
+    put_varint(&w.body, w.nsyms[k]);
+    defaults[k] = gv_calloc(w.nsyms[k], sizeof(char *));
+    for (size_t i = 0; i < w.nsyms[k]; ++i) {
+      put_varint(&w.body, strid(&w, w.syms[k][i]->name));
+      put_varint(&w.body, strid(&w, w.syms[k][i]->defval));
+      agxbputc(&w.body, (char)sym_flags(w.syms[k][i]));
+      defaults[k][i] = w.syms[k][i]->defval;
+    }
+  }
+
+  // nodes, indexed in traversal order
+  w.node_idx = gv_calloc((size_t)g->clos->seq[AGNODE] + 1, sizeof(uint64_t));
+  put_varint(&w.body, (uint64_t)agnnodes(g));
+  uint64_t nidx = 0;
+  for (Agnode_t *n = agfstnode(g); n; n = agnxtnode(g, n)) {
+    w.node_idx[AGSEQ(n)] = nidx++;
+    put_varint(&w.body, strid(&w, agnameof(n)));
+    write_attrs(&w, n, defaults[1]);
+  }
+
+  // edges, indexed in creation order so the reader recreates the same
+  // sequence, and hence output, order
+  const size_t edge_seqs = (size_t)g->clos->seq[AGEDGE] + 1;
+  w.edge_idx = gv_calloc(edge_seqs, sizeof(uint64_t));
+  Agedge_t **by_seq = gv_calloc(edge_seqs, sizeof(Agedge_t *));
+  for (Agnode_t *n = agfstnode(g); n; n = agnxtnode(g, n)) {
+    for (Agedge_t *e = agfstout(g, n); e; e = agnxtout(g, e)) {
+      by_seq[AGSEQ(e)] = e;
+    }
+  }
+  put_varint(&w.body, (uint64_t)agnedges(g));
+  uint64_t eidx = 0;
+  for (size_t i = 0; i < edge_seqs; ++i) {
+    Agedge_t *e = by_seq[i];
+    if (e == NULL) {
+      continue;
+    }
+    w.edge_idx[i] = eidx++;
+    put_varint(&w.body, w.node_idx[AGSEQ(agtail(e))]);
+    put_varint(&w.body, w.node_idx[AGSEQ(aghead(e))]);
+    char *key = agnameof(e);
+    put_varint(&w.body, key ? strid(&w, key) + 1 : 0);
+    write_attrs(&w, e, defaults[2]);
+  }
+  free(by_seq);
+
+  write_subgraphs(&w, g);
+
+  // assemble the header and write everything out
+  agxbuf hdr = {0};
+  agxbput_n(&hdr, MAGIC, MAGIC_LEN);
+  put_varint(&hdr, VERSION);
+  agxbuf strcount = {0};
+  put_varint(&strcount, w.nstrings);
+  put_varint(&hdr, agxblen(&strcount) + agxblen(&w.strtab) + agxblen(&w.body));
+
+  agxbuf *parts[] = {&hdr, &strcount, &w.strtab, &w.body};
+  for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i) {
+    const size_t len = agxblen(parts[i]);
+    if (len > 0 && write(chan, agxbstart(parts[i]), len) != len) {
+      rv = EOF;
+      break;
+    }
+  }
+
+  agxbfree(&hdr);
+  agxbfree(&strcount);
+  agxbfree(&w.strtab);
+  agxbfree(&w.body);
+  free(w.node_idx);
+  free(w.edge_idx);
+  for (int k = 0; k < NKINDS; ++k) {
+    free(w.syms[k]);
+    free(defaults[k]);
+  }
+  dtclose(w.strings);
+  return rv;
+}
+
+/* reader */
+
+typedef struct {
+  unsigned char *data;       ///< payload
+  size_t len;                ///< bytes in data
+  size_t cur;                ///< read position in data
+  bool bad;                  ///< has a decoding error occurred?
+  Agraph_t *root;
+  char **strs;     ///< string table, interned in root
+  uint64_t nstrings;
+  Agsym_t **syms[NKINDS]; ///< symbol index → symbol, per kind
+  uint64_t nsyms[NKINDS];
+  Agnode_t **nodes;
+  uint64_t nnodes;
+  Agedge_t **edges;
+  uint64_t nedges;
+} reader_t;
+
+static uint64_t get_varint(reader_t *r) {
+  uint64_t v = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (r->cur >= r->len) {
+      break;
+    }
+    const unsigned char c = r->data[r->cur++];
+    v |= (uint64_t)(c & 0x7f) << shift;
+    if (!(c & 0x80)) {
+      return v;
+    }
+  }
+  r->bad = true;
+  return 0;
+}
+
+static unsigned get_byte(reader_t *r) {
+  if (r->cur >= r->len) {
+    r->bad = true;
+    return 0;
+  }
+  return r->data[r->cur++];
+}
+
+static void set_sym_flags(Agsym_t *sym, unsigned flags) {
+  if (sym != NULL) {
+    sym->print = (flags & SYM_PRINT) != 0;
+    sym->fixed = (flags & SYM_FIXED) != 0;
+  }
+}
+
+/// read an index that must be less than bound
+static uint64_t get_index(reader_t *r, uint64_t bound) {
+  const uint64_t i = get_varint(r);
+  if (i >= bound) {
+    r->bad = true;
+    return 0;
+  }
+  return i;
+}
+
+static char *get_str(reader_t *r) {
+  const uint64_t i = get_index(r, r->nstrings);
+  return r->bad ? NULL : r->strs[i];
+}
+
+static void read_attrs(reader_t *r, void *obj) {
+  const int k = kind_index(AGTYPE(obj));
+  const uint64_t cnt = get_varint(r);
+  for (uint64_t i = 0; i < cnt && !r->bad; ++i) {
+    const uint64_t sym = get_index(r, r->nsyms[k]);
+    char *value = get_str(r);
+    if (!r->bad) {
+      agxset(obj, r->syms[k][sym], value);
+    }
+  }
+}
+
+static void read_local_defaults(reader_t *r, Agraph_t *subg, int kind) {
+  const int k = kind_index(kind);
+  const uint64_t cnt = get_varint(r);
+  for (uint64_t i = 0; i < cnt && !r->bad; ++i) {
+    const uint64_t sym = get_index(r, r->nsyms[k]);
+    char *value = get_str(r);
+    const unsigned flags = get_byte(r);
+    if (!r->bad) {
+      set_sym_flags(agattr(subg, kind, r->syms[k][sym]->name, value), flags);
+    }
+  }
+}
+
+static void read_subgraphs(reader_t *r, Agraph_t *g);
+
+static void read_subgraph(reader_t *r, Agraph_t *parent) {
+  char *name = get_str(r);
+  if (r->bad) {
+    return;
+  }
+  Agraph_t *subg = agsubg(parent, name, 1);
+  read_local_defaults(r, subg, AGRAPH);
+  read_local_defaults(r, subg, AGNODE);
+  read_local_defaults(r, subg, AGEDGE);
+
+  const uint64_t nnodes = get_varint(r);
+  for (uint64_t i = 0; i < nnodes && !r->bad; ++i) {
+    const uint64_t n = get_index(r, r->nnodes);
+    if (!r->bad) {
+      agsubnode(subg, r->nodes[n], 1);
+    }
+  }
+  const uint64_t nedges = get_varint(r);
+  for (uint64_t i = 0; i < nedges && !r->bad; ++i) {
+    const uint64_t e = get_index(r, r->nedges);
+    if (!r->bad && r->edges[e] != NULL) {
+      agsubedge(subg, r->edges[e], 1);
+    }
+  }
+
+  read_subgraphs(r, subg);
+}
+
+static void read_subgraphs(reader_t *r, Agraph_t *g) {
+  const uint64_t cnt = get_varint(r);
+  for (uint64_t i = 0; i < cnt && !r->bad; ++i) {
+    read_subgraph(r, g);
+  }
+}
+
+/// decode a payload into a new graph
+static Agraph_t *read_payload(reader_t *r, Agdisc_t *disc) {
+  // the string table, pointing into the payload until we have a graph
+  r->nstrings = get_varint(r);
+  if (r->bad || r->nstrings > r->len) {
+    return NULL;
+  }
+  unsigned char *html = gv_calloc(r->nstrings, sizeof(unsigned char));
+  r->strs = gv_calloc(r->nstrings, sizeof(char *));
+  for (uint64_t i = 0; i < r->nstrings && !r->bad; ++i) {
+    html[i] = get_byte(r) & STR_HTML;
+    const uint64_t len = get_varint(r);
+    if (r->bad || len >= r->len - r->cur || r->data[r->cur + len] != '\0') {
+      r->bad = true;
+      break;
+    }
+    r->strs[i] = (char *)&r->data[r->cur];
+    r->cur += len + 1;
+  }
+
+  const unsigned flags = get_byte(r);
+  char *name = get_str(r);
+  if (r->bad) {
+    free(html);
+    return NULL;
+  }
+
+  Agdesc_t desc = {.directed = (flags & G_DIRECTED) != 0,
+                   .strict = (flags & G_STRICT) != 0,
+                   .no_loop = (flags & G_NO_LOOP) != 0,
+                   .maingraph = true};
+  Agraph_t *g = r->root = agopen(name, desc, disc);
+
+  // intern the string table so attribute updates find existing references
+  for (uint64_t i = 0; i < r->nstrings; ++i) {
+    r->strs[i] =
+        html[i] ? agstrdup_html(g, r->strs[i]) : agstrdup(g, r->strs[i]);
+  }
+  free(html);
+
+  for (int k = 0; k < NKINDS && !r->bad; ++k) {
+    r->nsyms[k] = get_varint(r);
+    if (r->nsyms[k] > r->len) {
+      r->bad = true;
+      break;
+    }
+    r->syms[k] = gv_calloc(r->nsyms[k], sizeof(Agsym_t *));
+    for (uint64_t i = 0; i < r->nsyms[k] && !r->bad; ++i) {
+      char *symname = get_str(r);
+      char *defval = get_str(r);
+      const unsigned symflags = get_byte(r);
+      if (!r->bad) {
+        r->syms[k][i] = agattr(g, KINDS[k], symname, defval);
+        set_sym_flags(r->syms[k][i], symflags);
+      }
+    }
+  }
+
+  if (!r->bad) {
+    r->nnodes = get_varint(r);
+    if (r->nnodes > r->len) {
+      r->bad = true;
+    } else {
+      r->nodes = gv_calloc(r->nnodes, sizeof(Agnode_t *));
+    }
+  }
+  for (uint64_t i = 0; i < r->nnodes && !r->bad; ++i) {
+    char *nodename = get_str(r);
+    if (r->bad) {
+      break;
+    }
+    r->nodes[i] = agnode(g, nodename, 1);
+    read_attrs(r, r->nodes[i]);
+  }
+
+  if (!r->bad) {
+    r->nedges = get_varint(r);
+    if (r->nedges > r->len) {
+      r->bad = true;
+    } else {
+      r->edges = gv_calloc(r->nedges, sizeof(Agedge_t *));
+    }
+  }
+  for (uint64_t i = 0; i < r->nedges && !r->bad; ++i) {
+    const uint64_t t = get_index(r, r->nnodes);
+    const uint64_t h = get_index(r, r->nnodes);
+    const uint64_t key = get_index(r, r->nstrings + 1);
+    if (r->bad) {
+      break;
+    }
+    r->edges[i] =
+        agedge(g, r->nodes[t], r->nodes[h], key ? r->strs[key - 1] : NULL, 1);
+    if (r->edges[i] != NULL) {
+      read_attrs(r, r->edges[i]);
+    } else {
+      // strict graphs can reject an edge; skip over its attributes
+      const uint64_t cnt = get_varint(r);
+      for (uint64_t j = 0; j < 2 * cnt && !r->bad; ++j) {
+        (void)get_varint(r);
+      }
+    }
+  }
+
+  if (!r->bad) {
+    read_subgraphs(r, g);
+  }
+  aginternalmapclearlocalnames(g);
+
+  for (uint64_t i = 0; i < r->nstrings; ++i) {
+    agstrfree(g, r->strs[i]);
+  }
+  if (r->bad) {
+    agclose(g);
+    return NULL;
+  }
+  return g;
+}
+
+Agraph_t *agreadbin(FILE *fp, Agdisc_t *disc) {
+  char magic[MAGIC_LEN];
+  if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic)) {
+    return NULL;
+  }
+  if (memcmp(magic, MAGIC, sizeof(magic)) != 0) {
+    agerrorf("not a binary graph file\n");
+    return NULL;
+  }
+
+  // read the header varints a byte at a time, so we do not over-read
+  uint64_t hdr[2] = {0};
+  for (size_t i = 0; i < sizeof(hdr) / sizeof(hdr[0]); ++i) {
+    unsigned shift = 0;
+    int c;
+    do {
+      if ((c = getc(fp)) == EOF || shift >= 64) {
+        agerrorf("truncated binary graph header\n");
+        return NULL;
+      }
+      hdr[i] |= (uint64_t)(c & 0x7f) << shift;
+      shift += 7;
+    } while (c & 0x80);
+  }
+  if (hdr[0] != VERSION) {
+    agerrorf("unsupported binary graph version %" PRIu64 "\n", hdr[0]);
+    return NULL;
+  }
+  if (hdr[1] > SIZE_MAX) {
+    agerrorf("binary graph too large\n");
+    return NULL;
+  }
+
+  // The length is untrusted, so read in chunks rather than allocating it up
+  // front. A truncated file then fails on reaching EOF, without first trying
+  // to allocate whatever length its header claims.
+  reader_t r = {.len = (size_t)hdr[1]};
+  agxbuf payload = {0};
+  while (agxblen(&payload) < r.len) {
+    char chunk[BUFSIZ];
+    const size_t want = r.len - agxblen(&payload);
+    const size_t got =
+        fread(chunk, 1, want < sizeof(chunk) ? want : sizeof(chunk), fp);
+    if (got == 0) {
+      agerrorf("truncated binary graph\n");
+      agxbfree(&payload);
+      return NULL;
+    }
+    agxbput_n(&payload, chunk, got);
+  }
+  unsigned char *data = (unsigned char *)agxbdisown(&payload);
+  r.data = data;
+
+  Agraph_t *g = read_payload(&r, disc);
+  if (g == NULL) {
+    agerrorf("corrupt binary graph\n");
+  }
+
+  free(data);
+  free(r.strs);
+  for (int k = 0; k < NKINDS; ++k) {
+    free(r.syms[k]);
+  }
+  free(r.nodes);
+  free(r.edges);
+  return g;
+}
+
+bool agisbinfile(FILE *fp) {
+  const int c = getc(fp);
+  if (c == EOF) {
+    return false;
+  }
+  ungetc(c, fp);
+  return c == (unsigned char)MAGIC[0];
+}
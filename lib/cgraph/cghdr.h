@@ -72,6 +72,7 @@ int agstrclose(Agraph_t * g);
 
 	/* ref string management */
 void agmarkhtmlstr(char *s);
+char *agstrdupref(Agraph_t *g, char *s);
 
 /// Mask of `Agtag_s.seq` width
 enum { SEQ_MASK = (1 << (sizeof(unsigned) * 8 - 4)) - 1 };
@@ -404,11 +404,14 @@ CGRAPH_API int agpopdisc(Agraph_t *g, Agcbdisc_t *disc);
 
 /// @}
 
+/// opaque type; the definition of this is internal to Graphviz
+struct graphviz_strdict;
+
 /// shared resources for Agraph_s
 struct Agclos_s {
   Agdisc_t disc;    /* resource discipline functions */
   Agdstate_t state; /* resource closures */
-  Dict_t *strdict;  /* shared string dict */
+  struct graphviz_strdict *strdict; /* shared string dict */
   uint64_t seq[3];  /* local object sequence number counter */
   Agcbstack_t *cb;  /* user and system callback function stacks */
   Dict_t *lookup_by_name[3];
@@ -471,6 +474,22 @@ CGRAPH_API Agraph_t *agconcat(Agraph_t *g, void *chan, Agdisc_t *disc);
  */
 
 CGRAPH_API int agwrite(Agraph_t *g, void *chan);
+
+CGRAPH_API int agwritebin(Agraph_t *g, void *chan,
+                          size_t (*write)(void *chan, const char *buf,
+                                          size_t len));
+/**< @brief writes a root graph, including its attributes, in the compact
+ * binary graph format
+ *
+ * The output is passed to `write` in large chunks. Returns 0 on success or
+ * `EOF` if `write` reports a short write.
+ */
+
+CGRAPH_API Agraph_t *agreadbin(FILE *fp, Agdisc_t *disc);
+///< reads a graph written by @ref agwritebin
+
+CGRAPH_API bool agisbinfile(FILE *fp);
+///< does the stream continue with a graph written by @ref agwritebin?
 CGRAPH_API int agisdirected(Agraph_t *g);
 CGRAPH_API int agisundirected(Agraph_t *g);
 CGRAPH_API int agisstrict(Agraph_t *g);
@@ -481,6 +500,12 @@ CGRAPH_API int agissimple(Agraph_t *g);
 /// @{
 CGRAPH_API Agnode_t *agnode(Agraph_t *g, char *name, int createflag);
 CGRAPH_API Agnode_t *agidnode(Agraph_t *g, IDTYPE id, int createflag);
+
+/// create or find many nodes at once
+///
+/// This is equivalent to `nodes[i] = agnode(g, names[i], 1)` for each `i` up
+/// to `n`, but makes room for all of the nodes up front.
+CGRAPH_API void agnodes(Agraph_t *g, char **names, size_t n, Agnode_t **nodes);
 CGRAPH_API Agnode_t *agsubnode(Agraph_t *g, Agnode_t *n, int createflag);
 CGRAPH_API Agnode_t *agfstnode(Agraph_t *g);
 CGRAPH_API Agnode_t *agnxtnode(Agraph_t *g, Agnode_t *n);
@@ -520,6 +545,15 @@ CGRAPH_API Agedge_t *agedge(Agraph_t *g, Agnode_t *t, Agnode_t *h, char *name,
 CGRAPH_API Agedge_t *agidedge(Agraph_t *g, Agnode_t *t, Agnode_t *h, IDTYPE id,
                               int createflag);
 CGRAPH_API Agedge_t *agsubedge(Agraph_t *g, Agedge_t *e, int createflag);
+
+/// create many anonymous edges at once
+///
+/// This is equivalent to `edges[i] = agedge(g, tails[i], heads[i], NULL, 1)`
+/// for each `i` up to `n`. In a root graph that permits multi-edges and loops,
+/// the edges are sorted and inserted into the edge sets of their end points in
+/// bulk, which is much faster than creating them one at a time.
+CGRAPH_API void agedges(Agraph_t *g, Agnode_t **tails, Agnode_t **heads,
+                        size_t n, Agedge_t **edges);
 CGRAPH_API Agedge_t *agfstin(Agraph_t *g, Agnode_t *n);
 CGRAPH_API Agedge_t *agnxtin(Agraph_t *g, Agedge_t *e);
 CGRAPH_API Agedge_t *agfstout(Agraph_t *g, Agnode_t *n);
@@ -527,6 +561,44 @@ CGRAPH_API Agedge_t *agnxtout(Agraph_t *g, Agedge_t *e);
 CGRAPH_API Agedge_t *agfstedge(Agraph_t *g, Agnode_t *n);
 CGRAPH_API Agedge_t *agnxtedge(Agraph_t *g, Agedge_t *e, Agnode_t *n);
 CGRAPH_API int agdeledge(Agraph_t *g, Agedge_t *arg_e);
+
+/// a frozen, compressed sparse row view of a graph's adjacency
+///
+/// Nodes are numbered 0 to `nnodes - 1` in @ref agfstnode order. The out-edges
+/// of node `i` are entries `out_offset[i]` up to `out_offset[i + 1]` of
+/// `out_edges` and `out_head`, in @ref agfstout order, and similarly for
+/// in-edges. Walking these arrays is much cheaper than walking cgraph's edge
+/// dictionaries. The snapshot does not track later changes to the graph.
+typedef struct {
+  size_t nnodes;       ///< number of nodes
+  size_t nedges;       ///< number of edges
+  Agnode_t **nodes;    ///< node for each index
+  size_t *out_offset;  ///< `nnodes + 1` offsets into the out-edge arrays
+  Agedge_t **out_edges; ///< out-edges, grouped by tail
+  size_t *out_head;    ///< index of the head of each out-edge
+  size_t *in_offset;   ///< `nnodes + 1` offsets into the in-edge arrays
+  Agedge_t **in_edges; ///< in-edges, grouped by head
+  size_t *in_tail;     ///< index of the tail of each in-edge
+} Agcsr_t;
+
+CGRAPH_API Agcsr_t *agcsr(Agraph_t *g);
+///< builds a compressed sparse row snapshot of a graph or subgraph
+
+CGRAPH_API size_t agcsrindex(const Agcsr_t *csr, Agnode_t *n);
+/**< @brief index of a node in a snapshot
+ *
+ * @return The index of `n`, or `SIZE_MAX` if `n` is not in the snapshot
+ */
+
+CGRAPH_API double *agcsrvalues(const Agcsr_t *csr, Agsym_t *sym, double dflt);
+/**< @brief numeric values of an edge attribute, one per out-edge
+ *
+ * Edges whose value does not parse as a number, or all edges if `sym` is
+ * `NULL`, get `dflt`. The caller owns the returned array.
+ */
+
+CGRAPH_API void agcsrfree(Agcsr_t *csr);
+///< releases a snapshot built by @ref agcsr
 /// @}
 
 /// @addtogroup cgraph_object
@@ -594,6 +666,21 @@ CGRAPH_API char *agstrbind(Agraph_t *g, const char *);
 ///< returns a pointer to a reference-counted string if it exists, or NULL if
 ///< not
 
+CGRAPH_API bool agstrtod(const char *, double *);
+///< @brief parse a reference-counted string with `strtod`, caching the result
+///< in the string
+///
+/// Returns true if a number was parsed. Repeated conversions of a shared
+/// string, such as an attribute default, only parse it once.
+///
+/// The first conversion of a string stores its result in the string, so this
+/// and @ref agstrtol are not thread-safe: concurrent calls on the same
+/// string, as from threads reading the same attribute default, race.
+
+CGRAPH_API bool agstrtol(const char *, long *);
+///< @brief parse a reference-counted string with `strtol` in base 10, caching
+///< the result in the string
+
 CGRAPH_API int agstrfree(Agraph_t *, const char *);
 CGRAPH_API char *agcanon(char *str, int html);
 CGRAPH_API char *agstrcanon(char *, char *);
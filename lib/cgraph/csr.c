@@ -0,0 +1,102 @@
+/// @file
+/// @brief implements @ref agcsr
+/// @ingroup cgraph_edge
+
+/*************************************************************************
+ * Copyright (c) 2011 AT&T Intellectual Property
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * https://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors: Details at https://graphviz.org
+ *************************************************************************/
+
+#include <cgraph/alloc.h>
+#include <cgraph/cghdr.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+Agcsr_t *agcsr(Agraph_t *g) {
+  Agcsr_t *csr = gv_alloc(sizeof(Agcsr_t));
+
+  csr->nnodes = (size_t)agnnodes(g);
+  csr->nedges = (size_t)agnedges(g);
+  csr->nodes = gv_calloc(csr->nnodes, sizeof(Agnode_t *));
+  csr->out_offset = gv_calloc(csr->nnodes + 1, sizeof(size_t));
+  csr->out_edges = gv_calloc(csr->nedges, sizeof(Agedge_t *));
+  csr->out_head = gv_calloc(csr->nedges, sizeof(size_t));
+  csr->in_offset = gv_calloc(csr->nnodes + 1, sizeof(size_t));
+  csr->in_edges = gv_calloc(csr->nedges, sizeof(Agedge_t *));
+  csr->in_tail = gv_calloc(csr->nedges, sizeof(size_t));
+
+  size_t i = 0;
+  for (Agnode_t *n = agfstnode(g); n; n = agnxtnode(g, n)) {
+    csr->nodes[i++] = n;
+  }
+
+  size_t out = 0, in = 0;
+  for (i = 0; i < csr->nnodes; ++i) {
+    Agnode_t *n = csr->nodes[i];
+    csr->out_offset[i] = out;
+    for (Agedge_t *e = agfstout(g, n); e; e = agnxtout(g, e)) {
+      csr->out_edges[out] = e;
+      csr->out_head[out] = agcsrindex(csr, aghead(e));
+      ++out;
+    }
+    csr->in_offset[i] = in;
+    for (Agedge_t *e = agfstin(g, n); e; e = agnxtin(g, e)) {
+      csr->in_edges[in] = e;
+      csr->in_tail[in] = agcsrindex(csr, agtail(e));
+      ++in;
+    }
+  }
+  csr->out_offset[csr->nnodes] = out;
+  csr->in_offset[csr->nnodes] = in;
+
+  return csr;
+}
+
+size_t agcsrindex(const Agcsr_t *csr, Agnode_t *n) {
+  // nodes are in sequence order, so we can binary search for this one
+  const uint64_t seq = AGSEQ(n);
+  size_t lo = 0, hi = csr->nnodes;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    const uint64_t s = AGSEQ(csr->nodes[mid]);
+    if (s == seq) {
+      return csr->nodes[mid] == n ? mid : SIZE_MAX;
+    }
+    if (s < seq) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return SIZE_MAX;
+}
+
+double *agcsrvalues(const Agcsr_t *csr, Agsym_t *sym, double dflt) {
+  double *values = gv_calloc(csr->nedges, sizeof(double));
+  for (size_t i = 0; i < csr->nedges; ++i) {
+    if (sym == NULL || !agstrtod(agxget(csr->out_edges[i], sym), &values[i])) {
+      values[i] = dflt;
+    }
+  }
+  return values;
+}
+
+void agcsrfree(Agcsr_t *csr) {
+  if (csr == NULL) {
+    return;
+  }
+  free(csr->nodes);
+  free(csr->out_offset);
+  free(csr->out_edges);
+  free(csr->out_head);
+  free(csr->in_offset);
+  free(csr->in_edges);
+  free(csr->in_tail);
+  free(csr);
+}
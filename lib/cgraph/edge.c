@@ -14,10 +14,14 @@
  *************************************************************************/
 
 #include <assert.h>
+#include <cgraph/alloc.h>
 #include <cgraph/cghdr.h>
 #include <cgraph/node_set.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* return first outedge of <n> */
 Agedge_t *agfstout(Agraph_t * g, Agnode_t * n)
@@ -170,7 +174,10 @@ static void del(Dict_t * d, Dtlink_t ** set, Agedge_t * e)
     *set = dtextract(d);
 }
 
-static void installedge(Agraph_t * g, Agedge_t * e)
+/* install <e> in <g> and its parents. Unless <e> was just created, and so
+ * cannot be in any of them yet, stop at the first graph that already has it.
+ */
+static void installedge(Agraph_t * g, Agedge_t * e, bool is_new)
 {
     Agnode_t *t, *h;
     Agedge_t *out, *in;
@@ -181,7 +188,7 @@ static void installedge(Agraph_t * g, Agedge_t * e)
     t = agtail(e);
     h = aghead(e);
     while (g) {
-	if (agfindedge_by_key(g, t, h, AGTAG(e))) break;
+	if (!is_new && agfindedge_by_key(g, t, h, AGTAG(e))) break;
 	sn = agsubrep(g, t);
 	ins(g->e_seq, &sn->out_seq, out);
 	ins(g->e_id, &sn->out_id, out);
@@ -194,18 +201,17 @@ static void installedge(Agraph_t * g, Agedge_t * e)
 
 static void subedge(Agraph_t * g, Agedge_t * e)
 {
-    installedge(g, e);
+    installedge(g, e, false);
     /* might an init method call be needed here? */
 }
 
-static Agedge_t *newedge(Agraph_t * g, Agnode_t * t, Agnode_t * h,
+/* allocate an edge, without installing it in any graph */
+static Agedge_t *allocedge(Agraph_t * g, Agnode_t * t, Agnode_t * h,
              IDTYPE id)
 {
     Agedgepair_t *e2;
     Agedge_t *in, *out;
 
-    (void)agsubnode(g, t, 1);
-    (void)agsubnode(g, h, 1);
     e2 = agalloc(g, sizeof(Agedgepair_t));
     in = &(e2->in);
     out = &(e2->out);
@@ -217,13 +223,32 @@ static Agedge_t *newedge(Agraph_t * g, Agnode_t * t, Agnode_t * h,
     AGSEQ(in) = AGSEQ(out) = seq & SEQ_MASK;
     in->node = t;
     out->node = h;
+    return out;
+}
 
-    installedge(g, out);
+/* initialize the attributes of an installed edge and announce it */
+static void initedge(Agraph_t * g, Agedge_t * out)
+{
     if (g->desc.has_attrs) {
 	(void)agbindrec(out, AgDataRecName, sizeof(Agattr_t), false);
 	agedgeattr_init(g, out);
     }
     agmethod_init(g, out);
+}
+
+static Agedge_t *newedge(Agraph_t * g, Agnode_t * t, Agnode_t * h,
+             IDTYPE id)
+{
+    Agedge_t *out;
+
+    /* every node is already in the root graph */
+    if (g != agroot(g)) {
+	(void)agsubnode(g, t, 1);
+	(void)agsubnode(g, h, 1);
+    }
+    out = allocedge(g, t, h, id);
+    installedge(g, out, true);
+    initedge(g, out);
     return out;
 }
 
@@ -308,6 +333,167 @@ Agedge_t *agedge(Agraph_t * g, Agnode_t * t, Agnode_t * h, char *name,
     return e;
 }
 
+/* the keys of a new edge, copied out of its end points once */
+typedef struct {
+    uint64_t tail_seq, head_seq;
+    IDTYPE tail_id, head_id;
+} bulkends_t;
+
+/* an edge half, with the keys that order it in the edge set it goes in */
+typedef struct {
+    uint64_t owner;	/* seq of the node whose edge set the half goes in */
+    uint64_t key;	/* seq or ID of the other end point */
+    uint64_t subkey;	/* seq or ID of the edge */
+    Agedge_t *e;
+} bulkedge_t;
+
+/* the order of the edge sets, see agedgeidcmpf and agedgeseqcmpf */
+static bool bulkedgelt(const bulkedge_t *a, const bulkedge_t *b)
+{
+    if (a->key != b->key)
+	return a->key < b->key;
+    return a->subkey < b->subkey;
+}
+
+static int bulkedgecmpf(const void *x, const void *y)
+{
+    if (bulkedgelt(x, y))
+	return -1;
+    if (bulkedgelt(y, x))
+	return 1;
+    return 0;
+}
+
+/* sort the halves going into one node's edge set */
+static void bulksort(bulkedge_t *halves, size_t n)
+{
+    /* most nodes have few edges, so avoid the overhead of qsort for them */
+    if (n > 16) {
+	qsort(halves, n, sizeof(halves[0]), bulkedgecmpf);
+	return;
+    }
+    for (size_t i = 1; i < n; ++i) {
+	bulkedge_t h = halves[i];
+	size_t j = i;
+	for (; j > 0 && bulkedgelt(&h, &halves[j - 1]); --j)
+	    halves[j] = halves[j - 1];
+	halves[j] = h;
+    }
+}
+
+/* install one kind of half of each of the n edges in the root graph g, in
+ * the out or in, and id or seq, sets of their nodes
+ */
+static void bulkinstall(Agraph_t * g, Agedge_t ** edges,
+			const bulkends_t * ends, size_t n,
+			bulkedge_t * halves, bulkedge_t * sorted,
+			size_t * start, bool out, bool by_id)
+{
+    Dict_t *d = by_id ? g->e_id : g->e_seq;
+    const size_t nseq = (size_t)g->clos->seq[AGNODE] + 1;
+    size_t m = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+	if (edges[i] == NULL)
+	    continue;
+	Agedge_t *e = out ? AGMKOUT(edges[i]) : AGMKIN(edges[i]);
+	halves[m].owner = out ? ends[i].tail_seq : ends[i].head_seq;
+	if (by_id)
+	    halves[m].key = out ? ends[i].head_id : ends[i].tail_id;
+	else
+	    halves[m].key = out ? ends[i].head_seq : ends[i].tail_seq;
+	halves[m].subkey = by_id ? AGID(e) : AGSEQ(e);
+	halves[m].e = e;
+	++m;
+    }
+
+    /* group the halves by node with a counting sort on the node seqs, which
+     * are dense, and then sort each group, which is usually small
+     */
+    memset(start, 0, (nseq + 1) * sizeof(start[0]));
+    for (size_t i = 0; i < m; ++i)
+	++start[halves[i].owner + 1];
+    for (size_t i = 0; i < nseq; ++i)
+	start[i + 1] += start[i];
+    for (size_t i = 0; i < m; ++i)
+	sorted[start[halves[i].owner]++] = halves[i];
+
+    for (size_t i = 0, j; i < m; i = j) {
+	for (j = i + 1; j < m && sorted[j].owner == sorted[i].owner; ++j) ;
+	bulksort(&sorted[i], j - i);
+	Agnode_t *owner = AGOPP(sorted[i].e)->node;
+	Agsubnode_t *sn = agsubrep(g, owner);
+	Dtlink_t **set = out ? (by_id ? &sn->out_id : &sn->out_seq)
+			     : (by_id ? &sn->in_id : &sn->in_seq);
+	if (*set != NULL) {
+	    for (size_t k = i; k < j; ++k)
+		ins(d, set, sorted[k].e);
+	    continue;
+	}
+	/* a sorted list linked through right children is a valid tree, which
+	 * the dictionary accepts back from dtextract form
+	 */
+	Dtlink_t *next = NULL;
+	for (size_t k = j; k-- > i; ) {
+	    Dtlink_t *link = by_id ? &sorted[k].e->id_link
+				   : &sorted[k].e->seq_link;
+	    link->right = next;
+	    link->hl._left = NULL;
+	    next = link;
+	}
+	*set = next;
+    }
+}
+
+void agedges(Agraph_t * g, Agnode_t ** tails, Agnode_t ** heads, size_t n,
+	     Agedge_t ** edges)
+{
+    /* in subgraphs, strict graphs and graphs without loops, new edges have to
+     * be checked against existing ones, so they are created one at a time
+     */
+    if (g != agroot(g) || agisstrict(g) || g->desc.no_loop) {
+	for (size_t i = 0; i < n; ++i)
+	    edges[i] = agedge(g, tails[i], heads[i], NULL, 1);
+	return;
+    }
+
+    bulkends_t *ends = gv_calloc(n, sizeof(ends[0]));
+    for (size_t i = 0; i < n; ++i) {
+	IDTYPE id;
+	edges[i] = NULL;
+	if (tails[i]->root != g || heads[i]->root != g)
+	    continue;
+	if (!agmapnametoid(g, AGEDGE, NULL, &id, true))
+	    continue;
+	edges[i] = allocedge(g, tails[i], heads[i], id);
+	ends[i] = (bulkends_t){.tail_seq = AGSEQ(tails[i]),
+			       .head_seq = AGSEQ(heads[i]),
+			       .tail_id = AGID(tails[i]),
+			       .head_id = AGID(heads[i])};
+    }
+
+    bulkedge_t *halves = gv_calloc(n, sizeof(halves[0]));
+    bulkedge_t *sorted = gv_calloc(n, sizeof(sorted[0]));
+    size_t *start = gv_calloc((size_t)g->clos->seq[AGNODE] + 2,
+			      sizeof(start[0]));
+    for (int i = 0; i < 4; ++i) {
+	const bool out = i < 2;
+	const bool by_id = i % 2 == 1;
+	bulkinstall(g, edges, ends, n, halves, sorted, start, out, by_id);
+    }
+    free(start);
+    free(sorted);
+    free(halves);
+    free(ends);
+
+    for (size_t i = 0; i < n; ++i) {
+	if (edges[i] == NULL)
+	    continue;
+	initedge(g, edges[i]);
+	agregister(g, AGEDGE, edges[i]);
+    }
+}
+
 void agdeledgeimage(Agraph_t * g, Agedge_t * e, void *ignored)
 {
     Agedge_t *in, *out;
@@ -370,7 +556,7 @@ Agedge_t *agsubedge(Agraph_t * g, Agedge_t * e, int cflag)
     if (t && h) {
 	rv = agfindedge_by_key(g, t, h, AGTAG(e));
 	if (cflag && rv == NULL) {
-	installedge(g, e);
+	installedge(g, e, false);
 	rv = e;
 	}
 	if (rv && (AGTYPE(rv) != AGTYPE(e)))
@@ -14,6 +14,7 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 #include <cgraph/cghdr.h>
 #if defined(_WIN32)
 #include <io.h>
@@ -46,34 +47,26 @@ typedef struct {
     size_t cur;
 } rdr_t;
 
+/* memiofread:
+ * The whole input is already in memory, so there is no need to mimic the
+ * line-at-a-time semantics of iofread. Hand the scanner as much of the
+ * remaining data as fits in its buffer in a single copy.
+ */
 static int
 memiofread(void *chan, char *buf, int bufsize)
 {
-    const char *ptr;
-    char *optr;
-    char c;
-    int l;
-    rdr_t *s;
+    rdr_t *s = chan;
+    size_t l;
 
-    if (bufsize == 0) return 0;
-    s = chan;
+    if (bufsize <= 0) return 0;
     if (s->cur >= s->len)
         return 0;
-    l = 0;
-    ptr = s->data + s->cur;
-    optr = buf;
-    /* We know we have at least one character */
-    c = *ptr++;
-    do {
-        *optr++ = c;
-        l++;
-	/* continue if c is not newline, we have space in buffer,
-	 * and next character is non-null (we are working with
-	 * null-terminated strings.
-	 */
-    } while (c != '\n' && l < bufsize && (c = *ptr++));
-    s->cur += (size_t)l;
-    return l;
+    l = s->len - s->cur;
+    if (l > (size_t)bufsize)
+        l = (size_t)bufsize;
+    memcpy(buf, s->data + s->cur, l);
+    s->cur += l;
+    return (int)l;
 }
 
 static Agiodisc_t memIoDisc = {memiofread, 0, 0};
@@ -94,6 +87,11 @@ static Agraph_t *agmemread0(Agraph_t *arg_g, const char *cp)
     disc.io = &memIoDisc;  
     if (arg_g) g = agconcat(arg_g, &rdr, &disc);
     else g = agread (&rdr, &disc);
+    /* The scanner may have buffered input beyond the end of the graph.
+     * It belongs to rdr, which goes out of scope here, so discard it
+     * rather than letting it leak into the next read.
+     */
+    aglexbad();
     /* Null out filename and reset line number 
      * The name may have been set with a ppDirective, and
      * we want to reset line_num.
@@ -17,6 +17,7 @@
 #include <cgraph/node_set.h>
 #include <cgraph/unreachable.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 Agnode_t *agfindnode_by_id(Agraph_t * g, IDTYPE id)
@@ -178,6 +179,15 @@ Agnode_t *agnode(Agraph_t * g, char *name, int cflag)
     return NULL;
 }
 
+void agnodes(Agraph_t * g, char **names, size_t n, Agnode_t ** nodes)
+{
+    /* make room in the node sets once, rather than growing them repeatedly */
+    for (Agraph_t *par = g; par; par = agparent(par))
+	node_set_reserve(par->n_id, node_set_size(par->n_id) + n);
+    for (size_t i = 0; i < n; ++i)
+	nodes[i] = agnode(g, names[i], 1);
+}
+
 /* removes image of node and its edges from graph.
    caller must ensure n belongs to g. */
 void agdelnodeimage(Agraph_t * g, Agnode_t * n, void *ignored)
@@ -404,9 +414,10 @@ node_set_t *node_set_new(void) { return gv_alloc(sizeof(node_set_t)); }
 /// implemented using linear probing, so steps sequentially through indices
 /// following this.
 ///
-/// If the suboptimal choice of using the ID here turns out to be bad for
-/// performance, this could be converted to a more sophisticated hashing
-/// algorithm. None of the callers depend on the exact implementation.
+/// IDs of named nodes are the addresses of their names, so their low bits are
+/// mostly zero. The bits are mixed before reduction so that these do not all
+/// start probing from a few slots. None of the callers depend on the exact
+/// implementation.
 ///
 /// @param self Set to compute with respect to
 /// @param item Element being sought/added
@@ -415,16 +426,61 @@ static size_t node_set_index(const node_set_t *self, const Agsubnode_t *item) {
   assert(self != NULL);
   assert(item != NULL);
   assert(self->capacity != 0);
-  return (size_t)AGID(item->node) % self->capacity;
+  // the finalizer of MurmurHash3
+  uint64_t h = (uint64_t)AGID(item->node);
+  h ^= h >> 33;
+  h *= UINT64_C(0xff51afd7ed558ccd);
+  h ^= h >> 33;
+  return (size_t)(h % self->capacity);
+}
+
+/// a watermark ratio at which the set capacity should be expanded
+static const double OCCUPANCY_THRESHOLD = 0.7; // 70%
+
+/// move the elements of a set to a backing store of the given capacity
+///
+/// @param self Set to operate on
+/// @param new_c New capacity, enough for all elements
+static void node_set_resize(node_set_t *self, size_t new_c) {
+  Agsubnode_t **new_slots = gv_calloc(new_c, sizeof(Agsubnode_t *));
+
+  // Construct a new set and copy everything into it. Note we need to rehash
+  // because capacity (and hence modulo wraparound behavior) has changed. This
+  // conveniently flushes out the tombstones too.
+  node_set_t new_self = {.slots = new_slots, .capacity = new_c};
+  for (size_t i = 0; i < self->capacity; ++i) {
+    // skip empty slots
+    if (self->slots[i] == NULL) {
+      continue;
+    }
+    // skip deleted slots
+    if (self->slots[i] == TOMBSTONE) {
+      continue;
+    }
+    node_set_add(&new_self, self->slots[i]);
+  }
+
+  // replace ourselves with this new set
+  free(self->slots);
+  *self = new_self;
+}
+
+void node_set_reserve(node_set_t *self, size_t n) {
+  assert(self != NULL);
+
+  size_t new_c = self->capacity == 0 ? 1024 : self->capacity;
+  while ((double)n / (double)new_c > OCCUPANCY_THRESHOLD) {
+    new_c *= 2;
+  }
+  if (new_c != self->capacity) {
+    node_set_resize(self, new_c);
+  }
 }
 
 void node_set_add(node_set_t *self, Agsubnode_t *item) {
   assert(self != NULL);
   assert(item != NULL);
 
-  // a watermark ratio at which the set capacity should be expanded
-  static const double OCCUPANCY_THRESHOLD = 0.7; // 70%
-
   // do we need to expand the backing store?
   bool grow = false;
 
@@ -434,33 +490,13 @@ void node_set_add(node_set_t *self, Agsubnode_t *item) {
   }
 
   // we might need to if it has exceeded the watermark
-  if (!grow && self->size / self->capacity > OCCUPANCY_THRESHOLD) {
+  if (!grow &&
+      (double)self->size / (double)self->capacity > OCCUPANCY_THRESHOLD) {
     grow = true;
   }
 
   if (grow) {
-    const size_t new_c = self->capacity == 0 ? 1024 : self->capacity * 2;
-    Agsubnode_t **new_slots = gv_calloc(new_c, sizeof(Agsubnode_t *));
-
-    // Construct a new set and copy everything into it. Note we need to rehash
-    // because capacity (and hence modulo wraparound behavior) has changed. This
-    // conveniently flushes out the tombstones too.
-    node_set_t new_self = {.slots = new_slots, .capacity = new_c};
-    for (size_t i = 0; i < self->capacity; ++i) {
-      // skip empty slots
-      if (self->slots[i] == NULL) {
-        continue;
-      }
-      // skip deleted slots
-      if (self->slots[i] == TOMBSTONE) {
-        continue;
-      }
-      node_set_add(&new_self, self->slots[i]);
-    }
-
-    // replace ourselves with this new set
-    free(self->slots);
-    *self = new_self;
+    node_set_resize(self, self->capacity == 0 ? 1024 : self->capacity * 2);
   }
 
   assert(self->capacity > self->size);
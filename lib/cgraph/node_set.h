@@ -27,6 +27,15 @@ node_set_t *node_set_new(void);
 /// @param item Element to add
 void node_set_add(node_set_t *self, Agsubnode_t *item);
 
+/// make room for a number of items
+///
+/// This avoids repeatedly expanding the backing store while adding many items.
+/// On allocation failure, `exit` is called.
+///
+/// @param self Set to operate on
+/// @param n Total number of items to make room for
+void node_set_reserve(node_set_t *self, size_t n);
+
 /// lookup an existing item in a set
 ///
 /// Only the `key->node` member of the `key` needs to be valid.
@@ -13,118 +13,236 @@
  * Contributors: Details at https://graphviz.org
  *************************************************************************/
 
+#include <cgraph/alloc.h>
+#include <assert.h>
 #include <cgraph/cghdr.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /*
  * reference counted strings.
  */
 
+/* The conversion cache is written by agstrtod and agstrtol, which look like
+ * reads to their callers. It is kept out of the refcnt word, so that filling
+ * it does not touch the bits agstrdup and agstrfree update.
+ */
 typedef struct {
-    Dtlink_t link;
     uint64_t refcnt: sizeof(uint64_t) * 8 - 1;
     uint64_t is_html: 1;
-    char *s;
+    bool has_dval;		/* dval/dval_ok hold the result of strtod */
+    bool dval_ok;
+    bool has_lval;		/* lval/lval_ok hold the result of strtol */
+    bool lval_ok;
+    double dval;
+    long lval;
+    uint64_t hash;		/* cached hash of the string content */
+    size_t len;			/* strlen(store) */
     char store[1];		/* this is actually a dynamic array */
 } refstr_t;
 
-static Dtdisc_t Refstrdisc = {
-    offsetof(refstr_t, s),	/* key */
-    -1,				/* size */
-    0,				/* link offset */
-    NULL,
-    agdictobjfree,
-    NULL,
+typedef struct graphviz_strdict strdict_t;
+
+/* An open addressing hash set of refstr_t, using linear probing. The hash of
+ * each entry is cached in the entry itself, so probing only compares string
+ * contents when the full hashes match, and growing never rehashes strings.
+ */
+struct graphviz_strdict {
+    refstr_t **slots;		/* backing store for elements */
+    size_t size;		/* number of elements in the set */
+    size_t deleted;		/* number of TOMBSTONE slots */
+    size_t capacity;		/* size of slots, a power of 2 */
 };
 
-static Dict_t *Refdict_default;
+/* a sentinel, marking a slot from which an element has been deleted */
+static refstr_t *const TOMBSTONE = (refstr_t *)-1;
+
+static strdict_t *Refdict_default;
 
 /* refdict:
  * Return the string dictionary associated with g.
  * If necessary, create it.
- * As a side-effect, set html masks. This assumes 8-bit bytes.
  */
-static Dict_t *refdict(Agraph_t * g)
+static strdict_t *refdict(Agraph_t * g)
 {
-    Dict_t **dictref;
+    strdict_t **dictref;
 
     if (g)
 	dictref = &(g->clos->strdict);
     else
 	dictref = &Refdict_default;
     if (*dictref == NULL) {
-	*dictref = agdtopen(g, &Refstrdisc, Dttree);
+	*dictref = gv_alloc(sizeof(strdict_t));
     }
     return *dictref;
 }
 
+static void refstrfree(Agraph_t *g, refstr_t *r)
+{
+    if (g)
+	agfree(g, r);
+    else
+	free(r);
+}
+
 int agstrclose(Agraph_t * g)
 {
-    return agdtclose(g, refdict(g));
+    strdict_t **dictref = g ? &g->clos->strdict : &Refdict_default;
+    strdict_t *strdict = *dictref;
+
+    if (strdict == NULL)
+	return SUCCESS;
+    for (size_t i = 0; i < strdict->capacity; ++i) {
+	refstr_t *r = strdict->slots[i];
+	if (r != NULL && r != TOMBSTONE)
+	    refstrfree(g, r);
+    }
+    free(strdict->slots);
+    free(strdict);
+    *dictref = NULL;
+    return SUCCESS;
 }
 
-static refstr_t *refsymbind(Dict_t * strdict, const char *s)
+/* strhash:
+ * 64-bit FNV-1a hash of the first len bytes of s.
+ */
+static uint64_t strhash(const char *s, size_t len)
 {
-    refstr_t key, *r;
-// Suppress Clang/GCC -Wcast-qual warning. Casting away const here is acceptable
-// as dtsearch does not modify its input key.
-#ifdef __GNUC__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif
-    key.s = (char*)s;
-#ifdef __GNUC__
-#pragma GCC diagnostic pop
-#endif
-    r = dtsearch(strdict, &key);
-    return r;
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; ++i) {
+	h ^= (unsigned char)s[i];
+	h *= 0x100000001b3ull;
+    }
+    return h;
 }
 
-static char *refstrbind(Dict_t * strdict, const char *s)
+/* refsymbind:
+ * Find the entry for the len bytes at s, whose hash is h.
+ */
+static refstr_t *refsymbind(const strdict_t *strdict, const char *s,
+                            size_t len, uint64_t h)
 {
-    refstr_t *r;
-    r = refsymbind(strdict, s);
-    if (r)
-	return r->s;
-    else
+    if (strdict->size == 0)
 	return NULL;
+
+    const size_t mask = strdict->capacity - 1;
+    for (size_t i = (size_t)h & mask; ; i = (i + 1) & mask) {
+	refstr_t *r = strdict->slots[i];
+	// an empty slot terminates the probe sequence
+	if (r == NULL)
+	    return NULL;
+	if (r == TOMBSTONE)
+	    continue;
+	if (r->hash == h && r->len == len && memcmp(r->store, s, len) == 0)
+	    return r;
+    }
+}
+
+/* refsyminsert:
+ * Add r, which must not already be present, to strdict.
+ */
+static void refsyminsert(strdict_t *strdict, refstr_t *r)
+{
+    // keep the load, including deleted slots, at or below 50%
+    if (2 * (strdict->size + strdict->deleted + 1) > strdict->capacity) {
+	size_t new_c = strdict->capacity == 0 ? 1024 : strdict->capacity;
+	// only grow if live entries warrant it, otherwise we are just flushing
+	// out tombstones
+	while (4 * (strdict->size + 1) > new_c)
+	    new_c *= 2;
+	refstr_t **new_slots = gv_calloc(new_c, sizeof(refstr_t *));
+	for (size_t i = 0; i < strdict->capacity; ++i) {
+	    refstr_t *e = strdict->slots[i];
+	    if (e == NULL || e == TOMBSTONE)
+		continue;
+	    size_t j = (size_t)e->hash & (new_c - 1);
+	    while (new_slots[j] != NULL)
+		j = (j + 1) & (new_c - 1);
+	    new_slots[j] = e;
+	}
+	free(strdict->slots);
+	strdict->slots = new_slots;
+	strdict->capacity = new_c;
+	strdict->deleted = 0;
+    }
+
+    const size_t mask = strdict->capacity - 1;
+    size_t i = (size_t)r->hash & mask;
+    while (strdict->slots[i] != NULL && strdict->slots[i] != TOMBSTONE)
+	i = (i + 1) & mask;
+    if (strdict->slots[i] == TOMBSTONE)
+	--strdict->deleted;
+    strdict->slots[i] = r;
+    ++strdict->size;
+}
+
+/* refsymdelete:
+ * Remove r, which must be present, from strdict.
+ */
+static void refsymdelete(strdict_t *strdict, const refstr_t *r)
+{
+    const size_t mask = strdict->capacity - 1;
+    for (size_t i = (size_t)r->hash & mask; ; i = (i + 1) & mask) {
+	assert(strdict->slots[i] != NULL && "deleting a missing string");
+	if (strdict->slots[i] == r) {
+	    strdict->slots[i] = TOMBSTONE;
+	    --strdict->size;
+	    ++strdict->deleted;
+	    return;
+	}
+    }
 }
 
 char *agstrbind(Agraph_t * g, const char *s)
 {
-    return refstrbind(refdict(g), s);
+    refstr_t *r;
+    size_t len;
+
+    if (s == NULL)
+	return NULL;
+    len = strlen(s);
+    r = refsymbind(refdict(g), s, len, strhash(s, len));
+    return r ? r->store : NULL;
 }
 
 static char *agstrdup_internal(Agraph_t *g, const char *s, bool is_html) {
     refstr_t *r;
-    Dict_t *strdict;
-    size_t sz;
+    strdict_t *strdict;
+    size_t len;
+    uint64_t h;
 
     if (s == NULL)
 	 return NULL;
     strdict = refdict(g);
-    r = refsymbind(strdict, s);
+    len = strlen(s);
+    h = strhash(s, len);
+    r = refsymbind(strdict, s, len, h);
     if (r)
 	r->refcnt++;
     else {
-	sz = sizeof(refstr_t) + strlen(s);
+	const size_t sz = sizeof(refstr_t) + len;
 	if (g)
 	    r = agalloc(g, sz);
 	else {
 	    r = malloc(sz);
-	    if (sz > 0 && r == NULL) {
+	    if (r == NULL) {
 	        return NULL;
 	    }
 	}
 	r->refcnt = 1;
 	r->is_html = is_html;
-	strcpy(r->store, s);
-	r->s = r->store;
-	dtinsert(strdict, r);
+	r->has_dval = false;
+	r->has_lval = false;
+	r->hash = h;
+	r->len = len;
+	memcpy(r->store, s, len + 1);
+	refsyminsert(strdict, r);
     }
-    return r->s;
+    return r->store;
 }
 
 char *agstrdup(Agraph_t *g, const char *s) {
@@ -135,20 +253,40 @@ char *agstrdup_html(Agraph_t *g, const char *s) {
   return agstrdup_internal(g, s, true);
 }
 
+/* agstrdupref:
+ * Take another reference to s, which must already be a string in the
+ * dictionary of g. This is agstrdup without the lookup.
+ */
+char *agstrdupref(Agraph_t *g, char *s)
+{
+    refstr_t *r;
+
+    (void)g;
+    if (s == NULL)
+	return NULL;
+    assert(agstrbind(g, s) == s && "string not from this graph's dictionary");
+    r = (refstr_t *) (s - offsetof(refstr_t, store[0]));
+    r->refcnt++;
+    return s;
+}
+
 int agstrfree(Agraph_t * g, const char *s)
 {
     refstr_t *r;
-    Dict_t *strdict;
+    strdict_t *strdict;
+    size_t len;
 
     if (s == NULL)
 	 return FAILURE;
 
     strdict = refdict(g);
-    r = refsymbind(strdict, s);
-    if (r && r->s == s) {
+    len = strlen(s);
+    r = refsymbind(strdict, s, len, strhash(s, len));
+    if (r && r->store == s) {
 	r->refcnt--;
 	if (r->refcnt == 0) {
-	    agdtdelete(g, strdict, r);
+	    refsymdelete(strdict, r);
+	    refstrfree(g, r);
 	}
     }
     if (r == NULL)
@@ -180,16 +318,72 @@ void agmarkhtmlstr(char *s)
     key->is_html = 1;
 }
 
-#ifdef DEBUG
-static int refstrprint(void *ptr, void *user) {
-    refstr_t *r = ptr;
-    (void)user;
-    fprintf(stderr, "%s\n", r->s);
-    return 0;
+/* agstrtod:
+ * Parse s with strtod, caching the result in its refstr.
+ * We assume s points to the datafield store[0] of a refstr.
+ */
+bool agstrtod(const char *s, double *result)
+{
+    refstr_t *r;
+
+    assert(s != NULL);
+    assert(result != NULL);
+// Suppress Clang/GCC -Wcast-qual warning. Casting away const here is acceptable
+// as the string content is not modified, only the conversion cache beside it.
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+    r = (refstr_t *) (s - offsetof(refstr_t, store[0]));
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+    if (!r->has_dval) {
+	char *endp;
+	r->dval = strtod(s, &endp);
+	r->dval_ok = endp != s;
+	r->has_dval = true;
+    }
+    *result = r->dval;
+    return r->dval_ok;
 }
 
+/* agstrtol:
+ * Parse s with strtol in base 10, caching the result in its refstr.
+ * We assume s points to the datafield store[0] of a refstr.
+ */
+bool agstrtol(const char *s, long *result)
+{
+    refstr_t *r;
+
+    assert(s != NULL);
+    assert(result != NULL);
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+    r = (refstr_t *) (s - offsetof(refstr_t, store[0]));
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+    if (!r->has_lval) {
+	char *endp;
+	r->lval = strtol(s, &endp, 10);
+	r->lval_ok = endp != s;
+	r->has_lval = true;
+    }
+    *result = r->lval;
+    return r->lval_ok;
+}
+
+#ifdef DEBUG
 void agrefstrdump(Agraph_t * g)
 {
-    dtwalk(refdict(g), refstrprint, 0);
+    const strdict_t *strdict = refdict(g);
+    for (size_t i = 0; i < strdict->capacity; ++i) {
+	const refstr_t *r = strdict->slots[i];
+	if (r != NULL && r != TOMBSTONE)
+	    fprintf(stderr, "%s\n", r->store);
+    }
 }
 #endif
@@ -22,6 +22,7 @@
 #include <stddef.h>
 #include <stdio.h>		/* need sprintf() */
 #include <ctype.h>
+#include <cgraph/agxbuf.h>
 #include <cgraph/cghdr.h>
 #include <cgraph/gv_ctype.h>
 #include <cgraph/strcasecmp.h>
@@ -33,10 +34,27 @@
 
 typedef void iochan_t;
 
-static int ioput(Agraph_t * g, iochan_t * ofile, char *str)
+/// output not yet handed to the I/O discipline
+///
+/// The writer produces many short tokens. Rather than calling `putstr` for
+/// each of them, they are collected here and passed on in blocks of around
+/// `OUTPUT_CHUNK` bytes.
+static agxbuf Outbuf;
+#define OUTPUT_CHUNK 8192
+
+static int ioflush(Agraph_t *g, iochan_t *ofile)
 {
-    return AGDISC(g, io)->putstr(ofile, str);
+    if (agxblen(&Outbuf) == 0)
+	return 0;
+    return AGDISC(g, io)->putstr(ofile, agxbuse(&Outbuf)) == EOF ? EOF : 0;
+}
 
+static int ioput(Agraph_t * g, iochan_t * ofile, char *str)
+{
+    agxbput(&Outbuf, str);
+    if (agxblen(&Outbuf) < OUTPUT_CHUNK)
+	return 0;
+    return ioflush(g, ofile);
 }
 
 #define MAX_OUTPUTLINE		128
@@ -270,6 +288,12 @@ static int _write_canonstr(Agraph_t *g, iochan_t *ofile, char *str, bool chk) {
     return ioput(g, ofile, str);
 }
 
+/// write a string that is already known to be a refstr of `g`
+static int write_refstr(Agraph_t *g, iochan_t *ofile, char *str)
+{
+    return _write_canonstr(g, ofile, str, true);
+}
+
 static int write_canonstr(Agraph_t * g, iochan_t * ofile, char *str)
 {
     char *s;
@@ -313,9 +337,9 @@ static int write_dict(Agraph_t * g, iochan_t * ofile, char *name,
 	    CHKRV(ioput(g, ofile, ",\n"));
 	    CHKRV(indent(g, ofile));
 	}
-	CHKRV(write_canonstr(g, ofile, sym->name));
+	CHKRV(write_refstr(g, ofile, sym->name));
 	CHKRV(ioput(g, ofile, "="));
-	CHKRV(write_canonstr(g, ofile, sym->defval));
+	CHKRV(write_refstr(g, ofile, sym->defval));
     }
     if (cnt > 0) {
 	Level--;
@@ -534,9 +558,9 @@ static int write_nondefault_attrs(void *obj, iochan_t * ofile,
 		    CHKRV(ioput(g, ofile, ",\n"));
 		    CHKRV(indent(g, ofile));
 		}
-		CHKRV(write_canonstr(g, ofile, sym->name));
+		CHKRV(write_refstr(g, ofile, sym->name));
 		CHKRV(ioput(g, ofile, "="));
-		CHKRV(write_canonstr(g, ofile, data->str[sym->id]));
+		CHKRV(write_refstr(g, ofile, data->str[sym->id]));
 	    }
 	}
     if (cnt > 0) {
@@ -716,9 +740,13 @@ int agwrite(Agraph_t * g, void *ofile)
 	    Max_outputline = (int)len;
     }
     set_attrwf(g, true, false);
-    CHKRV(write_hdr(g, ofile, true));
-    CHKRV(write_body(g, ofile));
-    CHKRV(write_trl(g, ofile));
+    agxbclear(&Outbuf);
+    if (write_hdr(g, ofile, true) == EOF || write_body(g, ofile) == EOF ||
+        write_trl(g, ofile) == EOF || ioflush(g, ofile) == EOF) {
+	agxbclear(&Outbuf);
+	Max_outputline = MAX_OUTPUTLINE;
+	return EOF;
+    }
     Max_outputline = MAX_OUTPUTLINE;
     return AGDISC(g, io)->flush(ofile);
 }
@@ -33,6 +33,7 @@
 #include <cgraph/streq.h>
 #include <cgraph/unreachable.h>
 #include <common/htmltable.h>
+#include <common/instrument.h>
 #include <gvc/gvc.h>
 #include <cdt/cdt.h>
 #include <pathplan/pathgeom.h>
@@ -3456,7 +3457,7 @@ static Dtdisc_t stringdict = {
 
 bool emit_once(char *str) {
     if (strings == 0)
-	strings = dtopen(&stringdict, Dtoset);
+	strings = dtopen(&stringdict, Dtfset);
     if (!dtsearch(strings, str)) {
 	dtinsert(strings, gv_strdup(str));
 	return true;
@@ -3917,7 +3918,19 @@ void gv_fixLocale (int set)
 
 #define FINISH() if (Verbose) fprintf(stderr,"gvRenderJobs %s: %.2f secs.\n", agnameof(g), elapsed_sec())
 
+static int render_jobs(GVC_t *gvc, graph_t *g);
+
 int gvRenderJobs (GVC_t * gvc, graph_t * g)
+{
+    gvtrace_t *const trace = gvtrace_activate(gvtrace_of(gvc));
+    gvtrace_begin("render");
+    const int rc = render_jobs(gvc, g);
+    gvtrace_end();
+    gvtrace_activate(trace);
+    return rc;
+}
+
+static int render_jobs(GVC_t *gvc, graph_t *g)
 {
     static GVJ_t *prevjob;
     GVJ_t *job, *firstjob;
@@ -33,6 +33,7 @@
 #include <assert.h>
 #include <common/render.h>
 #include <common/htmltable.h>
+#include <common/instrument.h>
 #include <cgraph/agxbuf.h>
 #include <cgraph/prisize_t.h>
 #include <common/pointset.h>
@@ -48,6 +49,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define DEFAULT_BORDER    1
 #define DEFAULT_CELLPADDING  2
@@ -1306,21 +1309,6 @@ static void sizeLinearArray(htmltbl_t * tbl)
     }
 }
 
-/* closeGraphs:
- * Clean up graphs made for setting column and row widths.
- */
-static void closeGraphs(graph_t * rowg, graph_t * colg)
-{
-    node_t *n;
-    for (n = GD_nlist(colg); n; n = ND_next(n)) {
-	free_list(ND_in(n));
-	free_list(ND_out(n));
-    }
-
-    agclose(rowg);
-    agclose(colg);
-}
-
 /* checkChain:
  * For each pair of nodes in the node list, add an edge if none exists.
  * Assumes node list has nodes ordered correctly.
@@ -1364,99 +1352,174 @@ checkEdge (graph_t* g, node_t* t, node_t* h, int sz)
     }
 }
 
-/* makeGraphs:
- * Generate dags modeling the row and column constraints.
- * If the table has column_count columns, we create the graph
- *  0 -> 1 -> 2 -> ... -> column_count
+/// the constraints on the rows or the columns of a table
+///
+/// These are all sizeArray looks at, so tables with the same constraints
+/// have the same row heights or column widths.
+typedef struct {
+    Dtlink_t link;
+    /* key */
+    size_t count;   ///< number of rows or columns
+    size_t n_cells; ///< number of cells
+    int *cells;     ///< first row or column, span and size of each cell
+    /* value */
+    double *sizes;  ///< size of each row or column
+} htmlsize_entry_t;
+
+struct htmlsize_cache_s {
+    Dtdisc_t disc;
+    Dt_t *dict;
+};
+
+#define HTMLSIZE_CACHE_SIZE 4096
+
+static void htmlsize_freef(void *obj, Dtdisc_t *disc) {
+    (void)disc;
+
+    htmlsize_entry_t *e = obj;
+    free(e->cells);
+    free(e->sizes);
+    free(e);
+}
+
+static int htmlsize_comparf(Dt_t *dt, void *key1, void *key2,
+                            Dtdisc_t *disc) {
+    (void)dt;
+    (void)disc;
+
+    const htmlsize_entry_t *e1 = key1, *e2 = key2;
+    if (e1->count != e2->count)
+	return e1->count < e2->count ? -1 : 1;
+    if (e1->n_cells != e2->n_cells)
+	return e1->n_cells < e2->n_cells ? -1 : 1;
+    for (size_t i = 0; i < 3 * e1->n_cells; i++) {
+	if (e1->cells[i] != e2->cells[i])
+	    return e1->cells[i] < e2->cells[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+void htmlsize_cache_close(GVC_t *gvc) {
+    htmlsize_cache_t *cache = gvc->htmlsize_cache;
+    if (cache == NULL)
+	return;
+    dtclose(cache->dict);
+    free(cache);
+    gvc->htmlsize_cache = NULL;
+}
+
+/* sizeGraph:
+ * Generate a dag modeling the constraints in key, and rank it to get the
+ * sizes. If there are count columns, we create the graph
+ *  0 -> 1 -> 2 -> ... -> count
  * and if a cell starts in column c with span colspan, with
  * width w, we add the edge c -> c+colspan [minlen = w].
  * Ditto for rows.
- *
  */
-static void makeGraphs(htmltbl_t * tbl, graph_t * rowg, graph_t * colg)
+static void sizeGraph(const htmlsize_entry_t *key, char *name, double *sizes)
 {
-    htmlcell_t *cp;
-    htmlcell_t **cells;
-    node_t *t;
-    node_t *lastn;
-    node_t *h;
+    graph_t *g = agopen(name, Agstrictdirected, NULL);
+    node_t **nodes = gv_calloc(key->count + 1, sizeof(node_t *));
     agxbuf value_buffer = {0};
 
-    lastn = NULL;
-    for (size_t i = 0; i <= tbl->column_count; i++) {
+    /* Only need GD_nlist */
+    agbindrec(g, "Agraphinfo_t", sizeof(Agraphinfo_t), true);	// graph custom data
+    for (size_t i = 0; i <= key->count; i++) {
 	agxbprint(&value_buffer, "%" PRISIZE_T, i);
-	t = agnode(colg, agxbuse(&value_buffer), 1);
-	agbindrec(t, "Agnodeinfo_t", sizeof(Agnodeinfo_t), true);
-	alloc_elist(tbl->row_count, ND_in(t));
-	alloc_elist(tbl->row_count, ND_out(t));
-	if (lastn) {
-	    ND_next(lastn) = t;
-	    lastn = t;
-	} else {
-	    lastn = GD_nlist(colg) = t;
-	}
+	nodes[i] = agnode(g, agxbuse(&value_buffer), 1);
+	agbindrec(nodes[i], "Agnodeinfo_t", sizeof(Agnodeinfo_t), true);
+	alloc_elist(key->n_cells, ND_in(nodes[i]));
+	alloc_elist(key->n_cells, ND_out(nodes[i]));
+	if (i > 0)
+	    ND_next(nodes[i - 1]) = nodes[i];
     }
-    lastn = NULL;
-    for (size_t i = 0; i <= tbl->row_count; i++) {
-	agxbprint(&value_buffer, "%" PRISIZE_T, i);
-	t = agnode(rowg, agxbuse(&value_buffer), 1);
-	agbindrec(t, "Agnodeinfo_t", sizeof(Agnodeinfo_t), true);
-	alloc_elist(tbl->column_count, ND_in(t));
-	alloc_elist(tbl->column_count, ND_out(t));
-	if (lastn) {
-	    ND_next(lastn) = t;
-	    lastn = t;
-	} else {
-	    lastn = GD_nlist(rowg) = t;
-	}
+    GD_nlist(g) = nodes[0];
+    agxbfree(&value_buffer);
+
+    for (size_t i = 0; i < key->n_cells; i++) {
+	const int *cell = &key->cells[3 * i];
+	checkEdge(g, nodes[cell[0]], nodes[cell[0] + cell[1]], cell[2]);
     }
 
-    for (cells = tbl->u.n.cells; *cells; cells++) {
-	cp = *cells;
-	agxbprint(&value_buffer, "%" PRIu16, cp->col);
-	t = agfindnode(colg, agxbuse(&value_buffer));
-	agxbprint(&value_buffer, "%d", cp->col + cp->colspan);
-	h = agfindnode(colg, agxbuse(&value_buffer));
-	checkEdge (colg, t, h, cp->data.box.UR.x);
+    /* Make sure that 0 <= 1 <= 2 ...k. This implies graph connected. */
+    checkChain(g);
 
-	agxbprint(&value_buffer, "%" PRIu16, cp->row);
-	t = agfindnode(rowg, agxbuse(&value_buffer));
-	agxbprint(&value_buffer, "%d", cp->row + cp->rowspan);
-	h = agfindnode(rowg, agxbuse(&value_buffer));
-	checkEdge (rowg, t, h, cp->data.box.UR.y);
-    }
+    rank(g, 2, INT_MAX);
 
-    agxbfree(&value_buffer);
+    /* The rank values give the coordinate, so to get the width/height,
+     * we have to subtract the previous value.
+     */
+    int prev = 0;
+    for (size_t i = 0; i < key->count; i++) {
+	sizes[i] = ND_rank(nodes[i + 1]) - prev;
+	prev = ND_rank(nodes[i + 1]);
+    }
 
-    /* Make sure that 0 <= 1 <= 2 ...k. This implies graph connected. */
-    checkChain(colg);
-    checkChain(rowg);
+    for (size_t i = 0; i <= key->count; i++) {
+	free_list(ND_in(nodes[i]));
+	free_list(ND_out(nodes[i]));
+    }
+    free(nodes);
+    agclose(g);
 }
 
-/* setSizes:
- * Use rankings to determine cell dimensions. The rank values
- * give the coordinate, so to get the width/height, we have
- * to subtract the previous value.
+/* sizeDim:
+ * Set the row heights or column widths of a table, reusing those of an
+ * earlier table with the same constraints.
  */
-static void setSizes(htmltbl_t * tbl, graph_t * rowg, graph_t * colg)
+static void sizeDim(GVC_t *gvc, htmltbl_t *tbl, bool rows)
 {
-    int i;
-    node_t *n;
-    int prev;
+    htmlsize_cache_t *cache = gvc->htmlsize_cache;
+    htmlsize_entry_t key = {.count = rows ? tbl->row_count : tbl->column_count};
+    double *sizes = rows ? tbl->heights : tbl->widths;
+
+    for (htmlcell_t **cells = tbl->u.n.cells; *cells; cells++)
+	key.n_cells++;
+    key.cells = gv_calloc(3 * key.n_cells, sizeof(int));
+    for (size_t i = 0; i < key.n_cells; i++) {
+	const htmlcell_t *cp = tbl->u.n.cells[i];
+	int *cell = &key.cells[3 * i];
+	if (rows) {
+	    cell[0] = cp->row;
+	    cell[1] = cp->rowspan;
+	    cell[2] = cp->data.box.UR.y;
+	} else {
+	    cell[0] = cp->col;
+	    cell[1] = cp->colspan;
+	    cell[2] = cp->data.box.UR.x;
+	}
+    }
 
-    prev = 0;
-    n = GD_nlist(rowg);
-    for (i = 0, n = ND_next(n); n; i++, n = ND_next(n)) {
-	tbl->heights[i] = ND_rank(n) - prev;
-	prev = ND_rank(n);
+    if (cache == NULL) {
+	cache = gvc->htmlsize_cache = gv_alloc(sizeof(htmlsize_cache_t));
+	DTDISC(&cache->disc, 0, 0, offsetof(htmlsize_entry_t, link), NULL,
+	       htmlsize_freef, htmlsize_comparf);
+	cache->dict = dtopen(&cache->disc, Dtoset);
     }
-    prev = 0;
-    n = GD_nlist(colg);
-    for (i = 0, n = ND_next(n); n; i++, n = ND_next(n)) {
-	tbl->widths[i] = ND_rank(n) - prev;
-	prev = ND_rank(n);
+
+    htmlsize_entry_t *e = dtsearch(cache->dict, &key);
+    if (e != NULL) {
+	memcpy(sizes, e->sizes, key.count * sizeof(double));
+	free(key.cells);
+	gvtrace_count("html table size cache hits", 1);
+	return;
     }
 
+    sizeGraph(&key, rows ? "rowg" : "colg", sizes);
+    gvtrace_count("html table sizings", 1);
+
+    /* tables rarely come in more varieties than this, so start over rather
+     * than track which constraints were used least recently
+     */
+    if (dtsize(cache->dict) == HTMLSIZE_CACHE_SIZE) {
+	dtclear(cache->dict);
+	gvtrace_count("html table size cache clears", 1);
+    }
+    e = gv_alloc(sizeof(htmlsize_entry_t));
+    *e = key;
+    e->sizes = gv_calloc(key.count, sizeof(double));
+    memcpy(e->sizes, sizes, key.count * sizeof(double));
+    dtinsert(cache->dict, e);
 }
 
 /* sizeArray:
@@ -1466,12 +1529,8 @@ static void setSizes(htmltbl_t * tbl, graph_t * rowg, graph_t * colg)
  * a dag on a chain. We then run network simplex, using
  * LR_balance.
  */
-static void sizeArray(htmltbl_t * tbl)
+static void sizeArray(GVC_t *gvc, htmltbl_t * tbl)
 {
-    graph_t *rowg;
-    graph_t *colg;
-    Agdesc_t dir = Agstrictdirected;
-
     /* Do the 1D cases by hand */
     if (tbl->row_count == 1 || tbl->column_count == 1) {
 	sizeLinearArray(tbl);
@@ -1481,16 +1540,8 @@ static void sizeArray(htmltbl_t * tbl)
     tbl->heights = gv_calloc(tbl->row_count + 1, sizeof(double));
     tbl->widths = gv_calloc(tbl->column_count + 1, sizeof(double));
 
-    rowg = agopen("rowg", dir, NULL);
-    colg = agopen("colg", dir, NULL);
-    /* Only need GD_nlist */
-    agbindrec(rowg, "Agraphinfo_t", sizeof(Agraphinfo_t), true);	// graph custom data
-    agbindrec(colg, "Agraphinfo_t", sizeof(Agraphinfo_t), true);	// graph custom data
-    makeGraphs(tbl, rowg, colg);
-    rank(rowg, 2, INT_MAX);
-    rank(colg, 2, INT_MAX);
-    setSizes(tbl, rowg, colg);
-    closeGraphs(rowg, colg);
+    sizeDim(gvc, tbl, true);
+    sizeDim(gvc, tbl, false);
 }
 
 static void pos_html_tbl(htmltbl_t *, boxf, int);	/* forward declaration */
@@ -1784,7 +1835,7 @@ size_html_tbl(graph_t * g, htmltbl_t * tbl, htmlcell_t * parent,
 	tbl->data.border = DEFAULT_BORDER;
     }
 
-    sizeArray(tbl);
+    sizeArray(GD_gvc(g), tbl);
 
     assert(tbl->column_count <= DBL_MAX);
     double wd = ((double)tbl->column_count + 1) * tbl->data.space + 2 * tbl->data.border;
@@ -12,6 +12,7 @@
 
 #include <common/render.h>
 #include <common/htmltable.h>
+#include <common/instrument.h>
 #include <errno.h>
 #include <gvc/gvc.h>
 #include <xdot/xdot.h>
@@ -269,6 +270,20 @@ int dotneato_args_initialize(GVC_t * gvc, int argc, char **argv)
 	} else if (argv[i] && startswith(argv[i], "--filepath=")) {
 	    free(Gvfilepath);
 	    Gvfilepath = gv_strdup(argv[i] + strlen("--filepath="));
+	} else if (argv[i] && startswith(argv[i], "--trace=")) {
+	    free(gvc->trace_file);
+	    gvc->trace_file = gv_strdup(argv[i] + strlen("--trace="));
+	    gvTraceEnable(gvc, true);
+	} else if (argv[i] && startswith(argv[i], "--trace-format=")) {
+	    const char *format = argv[i] + strlen("--trace-format=");
+	    if (strcmp(format, "chrome") == 0) {
+		gvc->trace_format = GVTRACE_CHROME;
+	    } else if (strcmp(format, "json") == 0) {
+		gvc->trace_format = GVTRACE_JSON;
+	    } else {
+		fprintf(stderr, "Unknown trace format \"%s\"\n", format);
+		return dotneato_usage(1);
+	    }
 	} else if (argv[i] && argv[i][0] == '-') {
 	    rest = &argv[i][2];
 	    switch (c = argv[i][1]) {
@@ -506,6 +521,7 @@ graph_t *gvNextInputGraph(GVC_t *gvc)
     static FILE *fp;
     static FILE *oldfp;
     static int gidx;
+    static bool binary; // is fp in the binary graph format?
 
     while (!g) {
 	if (!fp) {
@@ -525,8 +541,16 @@ graph_t *gvNextInputGraph(GVC_t *gvc)
 	if (oldfp != fp) {
 	    agsetfile(fn ? fn : "<stdin>");
 	    oldfp = fp;
+	    binary = agisbinfile(fp);
 	}
-	g = agread(fp,NULL);
+	gvtrace_t *const trace = gvtrace_activate(gvtrace_of(gvc));
+	gvtrace_begin("parse");
+	if (binary)
+	    g = agreadbin(fp, NULL);
+	else
+	    g = agread(fp,NULL);
+	gvtrace_end();
+	gvtrace_activate(trace);
 	if (g) {
 	    gvg_init(gvc, g, fn, gidx++);
 	    break;
@@ -0,0 +1,317 @@
+/// @file
+/// @ingroup common_utils
+/*************************************************************************
+ * Copyright (c) 2011 AT&T Intellectual Property
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * https://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors: Details at https://graphviz.org
+ *************************************************************************/
+
+#include "config.h"
+
+#include <cgraph/alloc.h>
+#include <cgraph/list.h>
+#include <cgraph/streq.h>
+#include <common/instrument.h>
+#include <gvc/gvcint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+DEFINE_LIST(spans, gvtrace_span_t)
+DEFINE_LIST(counters, gvtrace_counter_t)
+
+/// a span that has begun but not yet ended
+typedef struct {
+  size_t index;     ///< index of the span in the recording
+  double cpu_start; ///< processor time it began at
+} open_span_t;
+
+DEFINE_LIST(open_spans, open_span_t)
+
+struct gvtrace_s {
+  spans_t spans;
+  counters_t counters;
+  open_spans_t open; ///< stack of the spans not yet ended
+  double epoch;      ///< wall clock time the recording is relative to
+  double cpu_epoch;
+};
+
+/// thread-local storage specifier
+#ifdef _MSC_VER
+#define TLS __declspec(thread)
+#elif defined(__GNUC__)
+#define TLS __thread
+#else
+#define TLS /* nothing */
+#endif
+
+/// the recorder spans and counters made by this thread go to, if any
+static TLS gvtrace_t *Active;
+
+#ifdef _WIN32
+
+static double wall_now(void) {
+  static LARGE_INTEGER freq;
+  if (freq.QuadPart == 0)
+    QueryPerformanceFrequency(&freq);
+  LARGE_INTEGER t;
+  QueryPerformanceCounter(&t);
+  return (double)t.QuadPart / (double)freq.QuadPart;
+}
+
+static double cpu_now(void) {
+  FILETIME creation, exit, kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+    return 0;
+  // FILETIMEs count 100ns intervals
+  ULARGE_INTEGER k = {.LowPart = kernel.dwLowDateTime,
+                      .HighPart = kernel.dwHighDateTime};
+  ULARGE_INTEGER u = {.LowPart = user.dwLowDateTime,
+                      .HighPart = user.dwHighDateTime};
+  return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+}
+
+#else
+
+static double clock_now(clockid_t clock) {
+  struct timespec t;
+  if (clock_gettime(clock, &t) != 0)
+    return 0;
+  return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static double wall_now(void) { return clock_now(CLOCK_MONOTONIC); }
+
+static double cpu_now(void) { return clock_now(CLOCK_PROCESS_CPUTIME_ID); }
+
+#endif
+
+gvtrace_t *gvtrace_new(void) {
+  gvtrace_t *trace = gv_alloc(sizeof(gvtrace_t));
+  trace->epoch = wall_now();
+  trace->cpu_epoch = cpu_now();
+  return trace;
+}
+
+void gvtrace_free(gvtrace_t *trace) {
+  if (trace == NULL)
+    return;
+  if (Active == trace)
+    Active = NULL;
+  spans_free(&trace->spans);
+  counters_free(&trace->counters);
+  open_spans_free(&trace->open);
+  free(trace);
+}
+
+gvtrace_t *gvtrace_activate(gvtrace_t *trace) {
+  gvtrace_t *const previous = Active;
+  Active = trace;
+  return previous;
+}
+
+gvtrace_t *gvtrace_of(GVC_t *gvc) {
+  return gvc != NULL && gvc->tracing ? gvc->trace : NULL;
+}
+
+void gvtrace_clear(gvtrace_t *trace) {
+  spans_clear(&trace->spans);
+  counters_clear(&trace->counters);
+  open_spans_clear(&trace->open);
+  trace->epoch = wall_now();
+  trace->cpu_epoch = cpu_now();
+}
+
+bool gvtrace_enabled(void) { return Active != NULL; }
+
+void gvtrace_begin(const char *name) {
+  gvtrace_t *trace = Active;
+  if (trace == NULL)
+    return;
+  const size_t parent =
+      open_spans_is_empty(&trace->open)
+          ? SIZE_MAX
+          : open_spans_get(&trace->open, open_spans_size(&trace->open) - 1)
+                .index;
+  const gvtrace_span_t span = {.name = name,
+                               .parent = parent,
+                               .start = wall_now() - trace->epoch,
+                               .wall = -1,
+                               .cpu = -1};
+  open_spans_push(&trace->open,
+                  (open_span_t){.index = spans_size(&trace->spans),
+                                .cpu_start = cpu_now() - trace->cpu_epoch});
+  spans_append(&trace->spans, span);
+}
+
+void gvtrace_end(void) {
+  gvtrace_t *trace = Active;
+  if (trace == NULL || open_spans_is_empty(&trace->open))
+    return;
+  const open_span_t open = open_spans_pop(&trace->open);
+  gvtrace_span_t *span = spans_at(&trace->spans, open.index);
+  span->wall = wall_now() - trace->epoch - span->start;
+  span->cpu = cpu_now() - trace->cpu_epoch - open.cpu_start;
+}
+
+void gvtrace_count(const char *name, unsigned long long delta) {
+  gvtrace_t *trace = Active;
+  if (trace == NULL || open_spans_is_empty(&trace->open))
+    return;
+  const size_t span =
+      open_spans_get(&trace->open, open_spans_size(&trace->open) - 1).index;
+
+  // Counters of the innermost span were added after any of its enclosing
+  // spans' counters, so only the tail of the list needs searching.
+  for (size_t i = counters_size(&trace->counters); i > 0; --i) {
+    gvtrace_counter_t *c = counters_at(&trace->counters, i - 1);
+    if (c->span < span)
+      break;
+    if (c->span == span && (c->name == name || streq(c->name, name))) {
+      c->value += delta;
+      return;
+    }
+  }
+  counters_append(&trace->counters, (gvtrace_counter_t){
+                                        .span = span,
+                                        .name = name,
+                                        .value = delta,
+                                    });
+}
+
+const gvtrace_span_t *gvtrace_spans(const gvtrace_t *trace, size_t *count) {
+  *count = spans_size(&trace->spans);
+  return trace->spans.data;
+}
+
+const gvtrace_counter_t *gvtrace_counters(const gvtrace_t *trace,
+                                          size_t *count) {
+  *count = counters_size(&trace->counters);
+  return trace->counters.data;
+}
+
+/// write a string known to need no escaping beyond quotes and backslashes
+static void write_string(FILE *out, const char *s) {
+  fputc('"', out);
+  for (; *s != '\0'; ++s) {
+    if (*s == '"' || *s == '\\')
+      fputc('\\', out);
+    if ((unsigned char)*s >= ' ')
+      fputc(*s, out);
+  }
+  fputc('"', out);
+}
+
+/// elapsed times of a span, treating an open span as ending now
+static void span_times(const gvtrace_t *trace, size_t index, double *wall,
+                       double *cpu) {
+  const gvtrace_span_t span = spans_get(&trace->spans, index);
+  *wall = span.wall;
+  *cpu = span.cpu;
+  for (size_t i = 0; i < open_spans_size(&trace->open); ++i) {
+    const open_span_t open = open_spans_get(&trace->open, i);
+    if (open.index == index) {
+      *wall = wall_now() - trace->epoch - span.start;
+      *cpu = cpu_now() - trace->cpu_epoch - open.cpu_start;
+      break;
+    }
+  }
+}
+
+/// write the counters of a span as the members of an object
+static void write_counters(const gvtrace_t *trace, FILE *out, size_t span,
+                           bool leading_comma) {
+  for (size_t i = 0; i < counters_size(&trace->counters); ++i) {
+    const gvtrace_counter_t c = counters_get(&trace->counters, i);
+    if (c.span != span)
+      continue;
+    if (leading_comma)
+      fputc(',', out);
+    write_string(out, c.name);
+    fprintf(out, ":%llu", c.value);
+    leading_comma = true;
+  }
+}
+
+static void write_chrome(const gvtrace_t *trace, FILE *out) {
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+  for (size_t i = 0; i < spans_size(&trace->spans); ++i) {
+    const gvtrace_span_t span = spans_get(&trace->spans, i);
+    double wall, cpu;
+    span_times(trace, i, &wall, &cpu);
+    fputs(i == 0 ? "\n" : ",\n", out);
+    fputs("{\"name\":", out);
+    write_string(out, span.name);
+    fprintf(out,
+            ",\"cat\":\"graphviz\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+            "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"cpu_ms\":%.3f",
+            span.start * 1e6, wall * 1e6, cpu * 1e3);
+    write_counters(trace, out, i, true);
+    fputs("}}", out);
+  }
+  fputs("\n]}\n", out);
+}
+
+/// write a span and the spans nested in it, returning the index after them
+static size_t write_tree(const gvtrace_t *trace, FILE *out, size_t index,
+                         int depth) {
+  const gvtrace_span_t span = spans_get(&trace->spans, index);
+  double wall, cpu;
+  span_times(trace, index, &wall, &cpu);
+  fprintf(out, "%*s{\"name\":", 2 * depth, "");
+  write_string(out, span.name);
+  fprintf(out, ",\"start\":%.6f,\"wall\":%.6f,\"cpu\":%.6f,\"counters\":{",
+          span.start, wall, cpu);
+  write_counters(trace, out, index, false);
+  fputs("},\"children\":[", out);
+
+  // spans are stored in the order they began, so the spans nested in this one
+  // follow it contiguously
+  size_t next = index + 1;
+  bool first = true;
+  while (next < spans_size(&trace->spans) &&
+         spans_get(&trace->spans, next).parent == index) {
+    fputs(first ? "\n" : ",\n", out);
+    next = write_tree(trace, out, next, depth + 1);
+    first = false;
+  }
+  if (!first)
+    fprintf(out, "\n%*s", 2 * depth, "");
+  fputs("]}", out);
+  return next;
+}
+
+static void write_json(const gvtrace_t *trace, FILE *out) {
+  fputs("{\"spans\":[", out);
+  size_t index = 0;
+  while (index < spans_size(&trace->spans)) {
+    fputs(index == 0 ? "\n" : ",\n", out);
+    index = write_tree(trace, out, index, 1);
+  }
+  fputs("\n]}\n", out);
+}
+
+int gvtrace_write(const gvtrace_t *trace, FILE *out, gvtrace_format_t format) {
+  switch (format) {
+  case GVTRACE_CHROME:
+    write_chrome(trace, out);
+    break;
+  case GVTRACE_JSON:
+    write_json(trace, out);
+    break;
+  default:
+    return -1;
+  }
+  return ferror(out) ? -1 : 0;
+}
@@ -0,0 +1,89 @@
+/// @file
+/// @brief recording of per phase timings and algorithm counters
+/// @ingroup common_utils
+///
+/// Spans nest: each @ref gvtrace_begin is closed by a matching
+/// @ref gvtrace_end. They go to the recorder active in the calling thread,
+/// which the entry points of a context make its own while they run. When no
+/// recorder is active, all of these are a test of a thread-local and nothing
+/// else, so they can be left in place in layout code.
+/// Counters in hot loops should still be accumulated locally and passed to
+/// @ref gvtrace_count once.
+
+#pragma once
+
+#include <gvc/gvc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef GVDLL
+#ifdef GVC_EXPORTS
+#define INSTRUMENT_API __declspec(dllexport)
+#else
+#define INSTRUMENT_API __declspec(dllimport)
+#endif
+#endif
+
+#ifndef INSTRUMENT_API
+#define INSTRUMENT_API /* nothing */
+#endif
+
+typedef struct gvtrace_s gvtrace_t;
+
+/// create an empty recorder, with times taken relative to now
+gvtrace_t *gvtrace_new(void);
+
+/// free a recorder, deactivating it if it is active
+void gvtrace_free(gvtrace_t *trace);
+
+/// direct subsequent spans and counters made by this thread to the given
+/// recorder, or to none
+///
+/// @return the recorder they went to before, to be passed back here when done
+gvtrace_t *gvtrace_activate(gvtrace_t *trace);
+
+/// the recorder of a context, or NULL if the context is not recording
+gvtrace_t *gvtrace_of(GVC_t *gvc);
+
+/// discard everything recorded, restarting the clock
+void gvtrace_clear(gvtrace_t *trace);
+
+/// is a recorder active in this thread?
+///
+/// This is for guarding counts that are themselves costly to compute.
+INSTRUMENT_API bool gvtrace_enabled(void);
+
+/// open a span, nested within the innermost open one
+///
+/// @param name phase name; this must outlive the recorder, and is normally a
+///   string literal
+INSTRUMENT_API void gvtrace_begin(const char *name);
+
+/// close the innermost open span
+INSTRUMENT_API void gvtrace_end(void);
+
+/// add to a counter of the innermost open span
+///
+/// Counts made while no span is open are dropped.
+///
+/// @param name counter name, with the same lifetime requirement as a span name
+/// @param delta amount to add
+INSTRUMENT_API void gvtrace_count(const char *name, unsigned long long delta);
+
+const gvtrace_span_t *gvtrace_spans(const gvtrace_t *trace, size_t *count);
+const gvtrace_counter_t *gvtrace_counters(const gvtrace_t *trace,
+                                          size_t *count);
+
+/// write the recording, returning 0 on success
+int gvtrace_write(const gvtrace_t *trace, FILE *out, gvtrace_format_t format);
+
+#undef INSTRUMENT_API
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,6 +21,7 @@
 #include <cgraph/prisize_t.h>
 #include <cgraph/queue.h>
 #include <cgraph/streq.h>
+#include <common/instrument.h>
 #include <common/render.h>
 #include <limits.h>
 #include <stdbool.h>
@@ -972,6 +973,7 @@ int rank2(graph_t * g, int balance, int maxiter, int search_size)
 	if (iter >= maxiter)
 	    break;
     }
+    gvtrace_count("network simplex pivots", (unsigned long long)iter);
     switch (balance) {
     case 1:
 	TB_balance();
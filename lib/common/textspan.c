@@ -14,10 +14,13 @@
  * Contributors: Details at https://graphviz.org
  *************************************************************************/
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <cdt/cdt.h>
+#include <common/instrument.h>
 #include <common/render.h>
 #include <common/textspan_lut.h>
 #include <cgraph/alloc.h>
@@ -76,8 +79,145 @@ static PostscriptAlias* translate_postscript_fontname(char* fontname)
     return result;
 }
 
+/// maximum number of measurements remembered per context
+#define TEXTSPAN_CACHE_SIZE 4096
+
+/// a remembered text measurement
+///
+/// The key is everything the text layout plugins and the estimator look at.
+/// Font color does not affect measurement, so it is not part of the key.
+typedef struct textspan_cache_entry_s {
+    Dtlink_t link;
+    /* key */
+    char *fontname;
+    double fontsize;
+    unsigned flags;
+    char *str;
+    /* measurement */
+    pointf size;
+    double yoffset_layout;
+    double yoffset_centerline;
+    /* least recently used list, most recent first */
+    struct textspan_cache_entry_s *prev;
+    struct textspan_cache_entry_s *next;
+} textspan_cache_entry_t;
+
+struct textspan_cache_s {
+    Dtdisc_t disc;
+    Dt_t *dict;
+    size_t size;
+    textspan_cache_entry_t *head;
+    textspan_cache_entry_t *tail;
+};
+
+static void textspan_cache_freef(void *obj, Dtdisc_t *disc) {
+    (void)disc;
+
+    textspan_cache_entry_t *e = obj;
+    free(e->fontname);
+    free(e->str);
+    free(e);
+}
+
+static int textspan_cache_comparf(Dt_t *dt, void *key1, void *key2,
+                                  Dtdisc_t *disc) {
+    (void)dt;
+    (void)disc;
+
+    const textspan_cache_entry_t *e1 = key1, *e2 = key2;
+    int rc = strcmp(e1->str, e2->str);
+    if (rc) return rc;
+    rc = strcmp(e1->fontname, e2->fontname);
+    if (rc) return rc;
+    if (e1->flags < e2->flags) return -1;
+    if (e1->flags > e2->flags) return 1;
+    if (e1->fontsize < e2->fontsize) return -1;
+    if (e1->fontsize > e2->fontsize) return 1;
+    return 0;
+}
+
+static void lru_unlink(textspan_cache_t *cache, textspan_cache_entry_t *e) {
+    if (e->prev) e->prev->next = e->next;
+    else cache->head = e->next;
+    if (e->next) e->next->prev = e->prev;
+    else cache->tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void lru_push(textspan_cache_t *cache, textspan_cache_entry_t *e) {
+    e->prev = NULL;
+    e->next = cache->head;
+    if (cache->head) cache->head->prev = e;
+    cache->head = e;
+    if (!cache->tail) cache->tail = e;
+}
+
+static textspan_cache_t *textspan_cache_open(void) {
+    textspan_cache_t *cache = gv_alloc(sizeof(textspan_cache_t));
+    DTDISC(&cache->disc, 0, 0, offsetof(textspan_cache_entry_t, link), NULL,
+           textspan_cache_freef, textspan_cache_comparf);
+    cache->dict = dtopen(&cache->disc, Dtoset);
+    return cache;
+}
+
+static void textspan_cache_close(textspan_cache_t *cache) {
+    if (cache == NULL) return;
+    dtclose(cache->dict);
+    free(cache);
+}
+
+/// look up a previous measurement of this span's text and font
+static bool textspan_cache_get(textspan_cache_t *cache, textspan_t *span) {
+    textspan_cache_entry_t key = {.fontname = span->font->name,
+                                  .fontsize = span->font->size,
+                                  .flags = span->font->flags,
+                                  .str = span->str};
+    textspan_cache_entry_t *e = dtsearch(cache->dict, &key);
+    if (e == NULL) return false;
+
+    if (e != cache->head) {
+        lru_unlink(cache, e);
+        lru_push(cache, e);
+    }
+    span->size = e->size;
+    span->yoffset_layout = e->yoffset_layout;
+    span->yoffset_centerline = e->yoffset_centerline;
+    // Renderers that draw from a plugin layout recreate it on demand.
+    span->layout = NULL;
+    span->free_layout = NULL;
+    return true;
+}
+
+/// remember the measurement of a span, evicting the least recently used one
+/// if the cache is full
+static void textspan_cache_put(textspan_cache_t *cache,
+                               const textspan_t *span) {
+    if (cache->size == TEXTSPAN_CACHE_SIZE) {
+        textspan_cache_entry_t *victim = cache->tail;
+        lru_unlink(cache, victim);
+        dtdelete(cache->dict, victim);
+        --cache->size;
+        gvtrace_count("text measurement cache evictions", 1);
+    }
+
+    textspan_cache_entry_t *e = gv_alloc(sizeof(textspan_cache_entry_t));
+    e->fontname = gv_strdup(span->font->name);
+    e->fontsize = span->font->size;
+    e->flags = span->font->flags;
+    e->str = gv_strdup(span->str);
+    e->size = span->size;
+    e->yoffset_layout = span->yoffset_layout;
+    e->yoffset_centerline = span->yoffset_centerline;
+    dtinsert(cache->dict, e);
+    lru_push(cache, e);
+    ++cache->size;
+}
+
 pointf textspan_size(GVC_t *gvc, textspan_t * span)
 /// Estimates size of a textspan, in points.
+///
+/// Measurements are remembered per context, so repeated labels only go
+/// through the text layout plugin once.
 {
     char **fpp = NULL, *fontpath = NULL;
     textfont_t *font;
@@ -94,9 +234,20 @@ pointf textspan_size(GVC_t *gvc, textspan_t * span)
     if (Verbose && emit_once(font->name))
 	fpp = &fontpath;
 
+    /* bypass the cache when font resolution is to be reported */
+    textspan_cache_t *cache = fpp ? NULL : gvc->textspan_cache;
+    if (cache && textspan_cache_get(cache, span)) {
+	gvtrace_count("text measurement cache hits", 1);
+	return span->size;
+    }
+
+    gvtrace_count("text measurements", 1);
     if (! gvtextlayout(gvc, span, fpp))
 	estimate_textspan_size(span, fpp);
 
+    if (cache)
+	textspan_cache_put(cache, span);
+
     if (fpp) {
 	if (fontpath)
 	    fprintf(stderr, "fontname: \"%s\" resolved to: %s\n",
@@ -166,9 +317,12 @@ static int textfont_comparf (Dt_t* dt, void* key1, void* key2, Dtdisc_t* disc)
 void textfont_dict_open(GVC_t *gvc) {
     DTDISC(&gvc->textfont_disc, 0, sizeof(textfont_t), -1, textfont_makef, textfont_freef, textfont_comparf);
     gvc->textfont_dt = dtopen(&(gvc->textfont_disc), Dtoset);
+    gvc->textspan_cache = textspan_cache_open();
 }
 
 void textfont_dict_close(GVC_t *gvc)
 {
     dtclose(gvc->textfont_dt);
+    textspan_cache_close(gvc->textspan_cache);
+    gvc->textspan_cache = NULL;
 }
@@ -62,6 +62,8 @@ extern "C" {
 	void *data;                   /* data loaded by a renderer */
 	size_t datasize;              /* size of data (if mmap'ed) */
 	void (*datafree)(usershape_t *us); /* renderer's function for freeing data */
+	size_t datacost;              /* memory charged to data in the image cache */
+	usershape_t *lru_prev, *lru_next; /* image cache, most recently used first */
     };
 
 #ifdef __cplusplus
@@ -36,9 +36,8 @@ int late_int(void *obj, attrsym_t *attr, int defaultValue, int minimum) {
     char *p = ag_xget(obj, attr);
     if (!p || p[0] == '\0')
         return defaultValue;
-    char *endp;
-    long rv = strtol(p, &endp, 10);
-    if (p == endp || rv > INT_MAX)
+    long rv;
+    if (!agstrtol(p, &rv) || rv > INT_MAX)
         return defaultValue; /* invalid int format */
     if (rv < minimum)
         return minimum;
@@ -52,9 +51,8 @@ double late_double(void *obj, attrsym_t *attr, double defaultValue,
     char *p = ag_xget(obj, attr);
     if (!p || p[0] == '\0')
         return defaultValue;
-    char *endp;
-    double rv = strtod(p, &endp);
-    if (p == endp)
+    double rv;
+    if (!agstrtod(p, &rv))
         return defaultValue; /* invalid double format */
     if (rv < minimum)
         return minimum;
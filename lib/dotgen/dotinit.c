@@ -14,6 +14,7 @@
 #include <cgraph/streq.h>
 #include <limits.h>
 #include <time.h>
+#include <common/instrument.h>
 #include <dotgen/dot.h>
 #include <pack/pack.h>
 #include <dotgen/aspect.h>
@@ -290,37 +291,54 @@ attach_phase_attrs (Agraph_t * g, int maxphase)
     agxbfree(&buf);
 }
 
-static void dotLayout(Agraph_t * g)
+static void dotPhases(Agraph_t * g)
 {
     int maxphase = late_int(g, agfindgraphattr(g,"phase"), -1, 1);
 
-    setEdgeType (g, EDGETYPE_SPLINE);
-    setAspect(g);
-
-    dot_init_subg(g,g);
-    dot_init_node_edge(g);
-
+    gvtrace_begin("rank");
     dot_rank(g);
+    gvtrace_end();
     if (maxphase == 1) {
         attach_phase_attrs (g, 1);
         return;
     }
+    gvtrace_begin("mincross");
     dot_mincross(g);
+    gvtrace_end();
     if (maxphase == 2) {
         attach_phase_attrs (g, 2);
         return;
     }
+    gvtrace_begin("position");
     dot_position(g);
+    gvtrace_end();
     if (maxphase == 3) {
         attach_phase_attrs (g, 2);  /* positions will be attached on output */
         return;
     }
     if (GD_flags(g) & NEW_RANK)
 	removeFill (g);
+    gvtrace_begin("splines");
     dot_sameports(g);
     dot_splines(g);
     if (mapbool(agget(g, "compound")))
 	dot_compoundEdges(g);
+    gvtrace_end();
+}
+
+static void dotLayout(Agraph_t * g)
+{
+    setEdgeType (g, EDGETYPE_SPLINE);
+    setAspect(g);
+
+    gvtrace_begin("init");
+    dot_init_subg(g,g);
+    dot_init_node_edge(g);
+    dot_warm_init(g);
+    gvtrace_end();
+
+    dotPhases(g);
+    dot_warm_cleanup(g);
 }
 
 static void
@@ -77,6 +77,13 @@ DEFINE_LIST(ints, int)
     extern void dot_rank(Agraph_t *);
     extern void dot_sameports(Agraph_t *);
     extern void dot_splines(Agraph_t *);
+    extern void dot_warm_init(Agraph_t *);
+    extern bool dot_warm_pos(Agraph_t *, Agnode_t *, pointf *);
+    extern int dot_warm_rank(Agraph_t *, Agnode_t *);
+    extern bool dot_warm_rank_y(Agraph_t *, int, double *);
+    extern bool dot_warm_edge_x(Agraph_t *, Agedge_t *, double, double *);
+    extern bool dot_warm_spline(Agraph_t *, Agedge_t *, pointf);
+    extern void dot_warm_cleanup(Agraph_t *);
 
 #ifdef __cplusplus
 }
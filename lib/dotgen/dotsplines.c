@@ -204,6 +204,72 @@ static void edge_normalize(graph_t * g)
     }
 }
 
+static int doublecmpf(const void *x, const void *y)
+{
+    const double a = *(const double *)x;
+    const double b = *(const double *)y;
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/* warm_unmoved:
+ * Check whether node n is where it was in the previous layout, allowing for
+ * a translation of the whole layout by delta and for the rounding of the
+ * pos attribute.
+ */
+static bool warm_unmoved(graph_t *g, node_t *n, pointf delta)
+{
+    pointf p;
+
+    if (!dot_warm_pos(g, n, &p))
+	return false;
+    p = add_pointf(p, delta);
+    return fabs(ND_coord(n).x - p.x) <= fmax(0.5, fabs(p.x) * 1e-4) &&
+	   fabs(ND_coord(n).y - p.y) <= fmax(0.5, fabs(p.y) * 1e-4);
+}
+
+/* warm_splines:
+ * In an incremental layout, reuse the previous splines of edges whose end
+ * points have not moved. Loops and labelled edges are routed afresh.
+ */
+static void warm_splines(graph_t *g)
+{
+    node_t *n;
+    edge_t *e;
+    pointf p;
+    size_t cnt = 0;
+
+    double *dx = gv_calloc((size_t)agnnodes(g), sizeof(double));
+    double *dy = gv_calloc((size_t)agnnodes(g), sizeof(double));
+    for (n = agfstnode(g); n; n = agnxtnode(g, n)) {
+	if (dot_warm_pos(g, n, &p)) {
+	    dx[cnt] = ND_coord(n).x - p.x;
+	    dy[cnt] = ND_coord(n).y - p.y;
+	    cnt++;
+	}
+    }
+    if (cnt > 0) {
+	/* the translation of most nodes is taken to be that of the layout */
+	qsort(dx, cnt, sizeof(double), doublecmpf);
+	qsort(dy, cnt, sizeof(double), doublecmpf);
+	const pointf delta = {dx[cnt / 2], dy[cnt / 2]};
+	for (n = agfstnode(g); n; n = agnxtnode(g, n)) {
+	    for (e = agfstout(g, n); e; e = agnxtout(g, e)) {
+		if (agtail(e) == aghead(e) || ED_edge_type(e) == IGNORED ||
+		    ED_label(e) || ED_xlabel(e) || ED_head_label(e) ||
+		    ED_tail_label(e))
+		    continue;
+		if (!warm_unmoved(g, agtail(e), delta) ||
+		    !warm_unmoved(g, aghead(e), delta))
+		    continue;
+		if (dot_warm_spline(g, e, delta) && swap_ends_p(e))
+		    swap_spline(ED_spl(e)); // undone by edge_normalize
+	    }
+	}
+    }
+    free(dx);
+    free(dy);
+}
+
 /* resetRW:
  * In position, each node has its rw stored in mval and,
  * if a node is part of a loop, rw may be increased to
@@ -294,6 +360,10 @@ static void dot_splines_(graph_t *g, int normalize) {
 
     mark_lowclusters(g);
     if (routesplinesinit()) return;
+    const bool warm = normalize && GD_alg(g) && !Concentrate &&
+                      !mapbool(agget(g, "compound"));
+    if (warm)
+	warm_splines(g);
     spline_info_t sd = {.Splinesep = GD_nodesep(g) / 4,
                         .Multisep = GD_nodesep(g)};
     edges = gv_calloc(CHUNK, sizeof(edge_t*));
@@ -417,6 +487,19 @@ static void dot_splines_(graph_t *g, int normalize) {
 		break;
 	}
 
+	/* skip edges with reused splines, unless routed with others */
+	if (warm) {
+	    unsigned reused = 0;
+	    for (unsigned b = 0; b < cnt; b++) {
+		if (ED_spl(getmainedge(edges[ind + b])))
+		    reused++;
+	    }
+	    if (reused == cnt)
+		continue;
+	    for (unsigned b = 0; reused > 0 && b < cnt; b++)
+		gv_free_splines(getmainedge(edges[ind + b]));
+	}
+
 	if (et == EDGETYPE_CURVED) {
 	    edge_t** edgelist = gv_calloc(cnt, sizeof(edge_t*));
 	    edgelist[0] = getmainedge((edges+ind)[0]);
@@ -25,7 +25,9 @@
 #include <cgraph/list.h>
 #include <cgraph/queue.h>
 #include <cgraph/streq.h>
+#include <common/instrument.h>
 #include <dotgen/dot.h>
+#include <float.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -86,6 +88,7 @@ static int GlobalMinRank, GlobalMaxRank;
 static edge_t **TE_list;
 static int *TI_list;
 static bool ReMincross;
+static bool *Dirty; ///< ranks to reorder in an incremental layout, else NULL
 
 #if defined(DEBUG) && DEBUG > 1
 static void indent(graph_t* g)
@@ -370,6 +373,12 @@ void dot_mincross(graph_t *g) {
 
     init_mincross(g);
 
+    /* an incremental layout without clusters keeps the previous order, and
+     * only reorders ranks near nodes with no previous position
+     */
+    if (GD_alg(g) && GD_n_cluster(g) == 0)
+	Dirty = gv_calloc((size_t)GD_maxrank(g) + 2, sizeof(bool));
+
     ints_t scratch = {0};
 
     size_t comp;
@@ -399,6 +408,8 @@ void dot_mincross(graph_t *g) {
 #endif
     }
     ints_free(&scratch);
+    free(Dirty);
+    Dirty = NULL;
     cleanup2(g, nc);
 }
 
@@ -681,7 +692,7 @@ static void transpose(graph_t * g, bool reverse)
     int r, delta;
 
     for (r = GD_minrank(g); r <= GD_maxrank(g); r++)
-	GD_rank(g)[r].candidate = true;
+	GD_rank(g)[r].candidate = !Dirty || Dirty[r];
     do {
 	delta = 0;
 	for (r = GD_minrank(g); r <= GD_maxrank(g); r++) {
@@ -692,10 +703,82 @@ static void transpose(graph_t * g, bool reverse)
     } while (delta >= 1);
 }
 
+/* warm_key:
+ * Get the previous x coordinate of node v in an incremental layout. For a
+ * virtual node, this is where the previous spline of its edge crossed its
+ * rank, or failing that, on the line between the end points of the edge.
+ */
+static bool warm_key(graph_t *g, node_t *v, double *key)
+{
+    node_t *t, *h;
+    edge_t *e;
+    pointf pt, ph;
+    double y;
+
+    if (ND_node_type(v) == NORMAL) {
+	if (!dot_warm_pos(g, v, &pt))
+	    return false;
+	*key = pt.x;
+	return true;
+    }
+    for (t = v; ND_node_type(t) == VIRTUAL && ND_in(t).size == 1;)
+	t = agtail(ND_in(t).list[0]);
+    for (h = v; ND_node_type(h) == VIRTUAL && ND_out(h).size == 1;)
+	h = aghead(ND_out(h).list[0]);
+    if (t == v || h == v || !dot_warm_pos(g, t, &pt) || !dot_warm_pos(g, h, &ph))
+	return false;
+    for (e = ND_in(v).list[0]; ED_to_orig(e); e = ED_to_orig(e));
+    if (dot_warm_rank_y(g, dot_warm_rank(g, t) + ND_rank(v) - ND_rank(t), &y)
+	&& dot_warm_edge_x(g, e, y, key))
+	return true;
+    *key = pt.x + (ph.x - pt.x) * (ND_rank(v) - ND_rank(t)) /
+	(ND_rank(h) - ND_rank(t));
+    return true;
+}
+
+static int warmcmpf(const void *x, const void *y) {
+  node_t *n0 = *(node_t * const *)x;
+  node_t *n1 = *(node_t * const *)y;
+  if (ND_mval(n0) < ND_mval(n1))
+    return -1;
+  if (ND_mval(n0) > ND_mval(n1))
+    return 1;
+  return ND_order(n0) - ND_order(n1);
+}
+
+/* warm_order:
+ * In an incremental layout, sort the ranks installed by build_ranks by
+ * their previous x coordinates. A node without one follows its predecessor,
+ * and the ranks around it are marked to be reordered by mincross.
+ */
+static void warm_order(graph_t *g)
+{
+    for (int r = GD_minrank(g); r <= GD_maxrank(g); r++) {
+	rank_t *rk = &GD_rank(g)[r];
+	double prev = -DBL_MAX;
+	for (int i = 0; i < rk->n; i++) {
+	    node_t *v = rk->v[i];
+	    if (!warm_key(g, v, &ND_mval(v))) {
+		ND_mval(v) = prev;
+		Dirty[r] = true;
+		if (r > GD_minrank(g))
+		    Dirty[r - 1] = true;
+		Dirty[r + 1] = true;
+	    }
+	    prev = ND_mval(v);
+	}
+	qsort(rk->v, (size_t)rk->n, sizeof(rk->v[0]), warmcmpf);
+	for (int i = 0; i < rk->n; i++)
+	    ND_order(rk->v[i]) = i;
+	GD_rank(Root)[r].valid = false;
+    }
+}
+
 static int mincross(graph_t *g, int startpass, ints_t *scratch) {
     const int endpass = 2;
     int maxthispass = 0, iter, trying, pass;
     int cur_cross, best_cross;
+    unsigned long long steps = 0;
 
     if (startpass > 1) {
 	cur_cross = best_cross = ncross(scratch);
@@ -704,9 +787,13 @@ static int mincross(graph_t *g, int startpass, ints_t *scratch) {
 	cur_cross = best_cross = INT_MAX;
     for (pass = startpass; pass <= endpass; pass++) {
 	if (pass <= 1) {
+	    if (pass == 1 && Dirty)
+		continue;
 	    maxthispass = MIN(4, MaxIter);
 	    if (g == dot_root(g))
 		build_ranks(g, pass, scratch);
+	    if (Dirty)
+		warm_order(g);
 	    if (pass == 0)
 		flat_breakcycles(g);
 	    flat_reorder(g);
@@ -732,6 +819,7 @@ static int mincross(graph_t *g, int startpass, ints_t *scratch) {
 	    if (cur_cross == 0)
 		break;
 	    mincross_step(g, iter);
+	    ++steps;
 	    if ((cur_cross = ncross(scratch)) <= best_cross) {
 		save_best(g);
 		if (cur_cross < Convergence * best_cross)
@@ -748,6 +836,7 @@ static int mincross(graph_t *g, int startpass, ints_t *scratch) {
 	transpose(g, false);
 	best_cross = ncross(scratch);
     }
+    gvtrace_count("mincross iterations", steps);
 
     return best_cross;
 }
@@ -1490,6 +1579,8 @@ static void mincross_step(graph_t * g, int pass)
     }
 
     for (r = first; r != last + dir; r += dir) {
+	if (Dirty && !Dirty[r])
+	    continue;
 	other = r - dir;
 	bool hasfixed = medians(g, r, other);
 	reorder(g, r, reverse, hasfixed);
@@ -426,6 +426,73 @@ static void expand_ranksets(graph_t *g) {
     }
 }
 
+/* warm_ranks:
+ * For an incremental layout, start network simplex from the previous ranks.
+ * These are set on the set leaders, then nodes are pushed down as needed to
+ * make the ranking feasible, so network simplex does not have to rank the
+ * graph from scratch.
+ */
+static void warm_ranks(graph_t *g)
+{
+    node_t *n, *v;
+    edge_t *e;
+    int r;
+
+    for (n = agfstnode(g); n; n = agnxtnode(g, n)) {
+	if ((r = dot_warm_rank(g, n)) < 0)
+	    continue;
+	node_t *leader = UF_find(n);
+	ND_rank(leader) = r - (leader == n ? 0 : ND_rank(n));
+    }
+
+    for (size_t c = 0; c < GD_comp(g).size; c++) {
+	queue_t q = {0};
+	for (v = GD_comp(g).list[c]; v; v = ND_next(v)) {
+	    ND_priority(v) = (int)ND_in(v).size;
+	    if (ND_priority(v) == 0)
+		queue_push(&q, v);
+	}
+	while ((v = queue_pop(&q))) {
+	    for (size_t i = 0; (e = ND_in(v).list[i]); i++)
+		ND_rank(v) = MAX(ND_rank(v), ND_rank(agtail(e)) + ED_minlen(e));
+	    for (size_t i = 0; (e = ND_out(v).list[i]); i++) {
+		if (--ND_priority(aghead(e)) == 0)
+		    queue_push(&q, aghead(e));
+	    }
+	}
+	queue_free(&q);
+    }
+}
+
+/* warm_balance:
+ * Nodes whose in and out edges have the same weight can take any rank
+ * between their neighbors at the same cost, and network simplex may have
+ * moved them. Return them to their previous rank where they can be.
+ */
+static void warm_balance(graph_t *g)
+{
+    node_t *n;
+    edge_t *e;
+    int r;
+
+    for (n = agfstnode(g); n; n = agnxtnode(g, n)) {
+	if (UF_find(n) != n || (r = dot_warm_rank(g, n)) < 0)
+	    continue;
+	int low = INT_MIN, high = INT_MAX;
+	double w = 0;
+	for (size_t i = 0; (e = ND_in(n).list[i]); i++) {
+	    w += ED_weight(e);
+	    low = MAX(low, ND_rank(agtail(e)) + ED_minlen(e));
+	}
+	for (size_t i = 0; (e = ND_out(n).list[i]); i++) {
+	    w -= ED_weight(e);
+	    high = MIN(high, ND_rank(aghead(e)) - ED_minlen(e));
+	}
+	if (w == 0 && low <= high)
+	    ND_rank(n) = MIN(MAX(r, low), high);
+    }
+}
+
 static void dot1_rank(graph_t *g)
 {
     point p;
@@ -440,7 +507,11 @@ static void dot1_rank(graph_t *g)
     if (minmax_edges2(g, p))
 	decompose(g, 0);
 
+    if (GD_alg(g))
+	warm_ranks(g);
     rank1(g);
+    if (GD_alg(g))
+	warm_balance(g);
 
     expand_ranksets(g);
     cleanup1(g);
@@ -0,0 +1,279 @@
+/*************************************************************************
+ * Copyright (c) 2011 AT&T Intellectual Property
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * https://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors: Details at https://graphviz.org
+ *************************************************************************/
+
+/*
+ * Reading the previous layout for an incremental layout (see gvLayoutUpdate).
+ *
+ * The previous layout is taken from the pos attributes of the nodes and
+ * edges. These are in the output frame, after rankdir rotation and
+ * translation; the positions kept here are rotated back to dot's frame, in
+ * which ranks run down the y axis and order along the x axis. They may
+ * still differ from the new positions by a translation.
+ */
+
+#include <cgraph/alloc.h>
+#include <cgraph/gv_ctype.h>
+#include <cgraph/list.h>
+#include <dotgen/dot.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+DEFINE_LIST(pointfs, pointf)
+
+typedef struct {
+    size_t size;
+    pointf *pos;  ///< previous position of each node, by AGSEQ
+    bool *known;  ///< whether the previous position of each node is known
+    double *ys;   ///< distinct previous y coordinates, from the top
+    size_t nranks;
+} warm_t;
+
+/* toFrame:
+ * Map a point from the output frame of g back to dot's frame.
+ */
+static pointf toFrame(graph_t *g, pointf p)
+{
+    switch (GD_rankdir(agroot(g))) {
+    case RANKDIR_LR:
+	return (pointf){p.y, -p.x};
+    case RANKDIR_BT:
+	return (pointf){p.x, -p.y};
+    case RANKDIR_RL:
+	return (pointf){p.y, p.x};
+    default:
+	return p;
+    }
+}
+
+static int ycmpf(const void *x, const void *y)
+{
+    const double a = *(const double *)x;
+    const double b = *(const double *)y;
+    return a < b ? 1 : a > b ? -1 : 0;
+}
+
+/* dot_warm_init:
+ * If g is laid out incrementally, record the previous position of each of
+ * its nodes.
+ */
+void dot_warm_init(graph_t *g)
+{
+    Agsym_t *N_pos;
+    node_t *n;
+    double x, y;
+
+    if (!(GD_flags(agroot(g)) & WARM_START))
+	return;
+    if (!(N_pos = agattr(agroot(g), AGNODE, "pos", NULL)))
+	return;
+
+    warm_t *w = gv_alloc(sizeof(warm_t));
+    for (n = agfstnode(g); n; n = agnxtnode(g, n))
+	w->size = MAX(w->size, (size_t)AGSEQ(n) + 1);
+    w->pos = gv_calloc(w->size, sizeof(pointf));
+    w->known = gv_calloc(w->size, sizeof(bool));
+    w->ys = gv_calloc(w->size, sizeof(double));
+    for (n = agfstnode(g); n; n = agnxtnode(g, n)) {
+	if (sscanf(agxget(n, N_pos), "%lf,%lf", &x, &y) == 2) {
+	    w->pos[AGSEQ(n)] = toFrame(g, (pointf){x, y});
+	    w->known[AGSEQ(n)] = true;
+	    w->ys[w->nranks++] = w->pos[AGSEQ(n)].y;
+	}
+    }
+
+    /* nodes on a rank share a y coordinate */
+    if (w->nranks > 0) {
+	qsort(w->ys, w->nranks, sizeof(double), ycmpf);
+	size_t nys = w->nranks;
+	w->nranks = 1;
+	for (size_t i = 1; i < nys; i++) {
+	    if (w->ys[i] != w->ys[w->nranks - 1])
+		w->ys[w->nranks++] = w->ys[i];
+	}
+    }
+    GD_alg(g) = w;
+}
+
+/* dot_warm_pos:
+ * If the previous position of node n of g is known, store it in p and
+ * return true.
+ */
+bool dot_warm_pos(graph_t *g, node_t *n, pointf *p)
+{
+    warm_t *w = GD_alg(g);
+
+    if (!w || ND_node_type(n) != NORMAL || (size_t)AGSEQ(n) >= w->size ||
+	!w->known[AGSEQ(n)])
+	return false;
+    *p = w->pos[AGSEQ(n)];
+    return true;
+}
+
+/* dot_warm_rank:
+ * Return the previous rank of node n of g, counting the ranks with real
+ * nodes from the top, or -1 if it is not known.
+ */
+int dot_warm_rank(graph_t *g, node_t *n)
+{
+    warm_t *w = GD_alg(g);
+    pointf p;
+
+    if (!dot_warm_pos(g, n, &p))
+	return -1;
+    const double *y = bsearch(&p.y, w->ys, w->nranks, sizeof(double), ycmpf);
+    return (int)(y - w->ys);
+}
+
+/* dot_warm_rank_y:
+ * If there is a previous rank r in g, store its y coordinate in y and
+ * return true.
+ */
+bool dot_warm_rank_y(graph_t *g, int r, double *y)
+{
+    warm_t *w = GD_alg(g);
+
+    if (!w || r < 0 || (size_t)r >= w->nranks)
+	return false;
+    *y = w->ys[r];
+    return true;
+}
+
+/* parseBezier:
+ * Parse the next bezier of an edge pos attribute at *pos into pts and the
+ * arrow points, in dot's frame translated by delta. Return false if it is
+ * malformed.
+ */
+static bool parseBezier(graph_t *g, char **pos, pointf delta, pointfs_t *pts,
+                        bezier *bz)
+{
+    char *p = *pos;
+    double x, y;
+    int nc;
+
+    if (sscanf(p, " s,%lf,%lf%n", &x, &y, &nc) == 2) {
+	bz->sflag = 1;
+	bz->sp = add_pointf(toFrame(g, (pointf){x, y}), delta);
+	p += nc;
+    }
+    if (sscanf(p, " e,%lf,%lf%n", &x, &y, &nc) == 2) {
+	bz->eflag = 1;
+	bz->ep = add_pointf(toFrame(g, (pointf){x, y}), delta);
+	p += nc;
+    }
+    pointfs_clear(pts);
+    while (sscanf(p, " %lf,%lf%n", &x, &y, &nc) == 2) {
+	pointfs_append(pts, add_pointf(toFrame(g, (pointf){x, y}), delta));
+	p += nc;
+    }
+    while (gv_isspace(*p))
+	p++;
+    *pos = p;
+    return pointfs_size(pts) >= 4 && pointfs_size(pts) % 3 == 1 &&
+	   (*p == ';' || *p == '\0');
+}
+
+/* dot_warm_edge_x:
+ * If the previous spline of edge e crosses y, store the x coordinate where
+ * it first does in x and return true.
+ */
+bool dot_warm_edge_x(graph_t *g, edge_t *e, double y, double *x)
+{
+    char *pos = agget(e, "pos");
+    pointfs_t pts = {0};
+    bool found = false;
+
+    if (!GD_alg(g) || !pos)
+	return false;
+    while (!found && *pos != '\0') {
+	bezier bz = {0};
+	if (!parseBezier(g, &pos, (pointf){0}, &pts, &bz))
+	    break;
+	/* follow each cubic piece as a polyline */
+	for (size_t i = 0; !found && i + 3 < pointfs_size(&pts); i += 3) {
+	    pointf q = pointfs_get(&pts, i);
+	    for (int j = 1; !found && j <= 8; j++) {
+		pointf r = Bezier(pointfs_at(&pts, i), j / 8.0, NULL, NULL);
+		if ((q.y - y) * (r.y - y) <= 0 && q.y != r.y) {
+		    *x = q.x + (r.x - q.x) * (y - q.y) / (r.y - q.y);
+		    found = true;
+		}
+		q = r;
+	    }
+	}
+	if (*pos == ';')
+	    pos++;
+    }
+    pointfs_free(&pts);
+    return found;
+}
+
+/* dot_warm_spline:
+ * Install the previous spline of edge e, translated by delta, as read from
+ * its pos attribute. Return false, leaving e unchanged, if there is none.
+ */
+bool dot_warm_spline(graph_t *g, edge_t *e, pointf delta)
+{
+    char *pos = agget(e, "pos");
+    pointfs_t pts = {0};
+
+    if (!pos || *pos == '\0')
+	return false;
+
+    /* check that every bezier is well formed before installing any */
+    for (char *p = pos;;) {
+	bezier bz = {0};
+	if (!parseBezier(g, &p, delta, &pts, &bz)) {
+	    pointfs_free(&pts);
+	    return false;
+	}
+	if (*p++ == '\0')
+	    break;
+    }
+
+    uint32_t stype, etype;
+    arrow_flags(e, &stype, &etype);
+    for (char *p = pos;;) {
+	bezier bz = {0};
+	parseBezier(g, &p, delta, &pts, &bz);
+	const size_t npts = pointfs_size(&pts);
+	bezier *newspl = new_spline(e, npts);
+	for (size_t i = 0; i < npts; i++)
+	    newspl->list[i] = pointfs_get(&pts, i);
+	for (size_t i = 0; i + 3 < npts; i += 3)
+	    update_bb_bz(&GD_bb(g), &newspl->list[i]);
+	if (bz.sflag) {
+	    newspl->sflag = stype;
+	    newspl->sp = bz.sp;
+	}
+	if (bz.eflag) {
+	    newspl->eflag = etype;
+	    newspl->ep = bz.ep;
+	}
+	if (*p++ == '\0')
+	    break;
+    }
+    pointfs_free(&pts);
+    return true;
+}
+
+void dot_warm_cleanup(graph_t *g)
+{
+    warm_t *w = GD_alg(g);
+
+    if (!w)
+	return;
+    free(w->pos);
+    free(w->known);
+    free(w->ys);
+    free(w);
+    GD_alg(g) = NULL;
+}
@@ -1049,6 +1049,8 @@ static Extype_t eval(Expr_t *ex, Exnode_t *exnode, void *env) {
 		v.integer = 1;
 		return v;
 	}
+	if (exnode->code)
+		return exvmeval(ex, exnode->code, env);
 	x = exnode->data.operand.left;
 	switch (exnode->op)
 	{
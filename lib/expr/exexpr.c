@@ -32,7 +32,11 @@ exexpr(Expr_t* ex, const char* name, Exid_t* sym, int type)
 		if (sym && sym->lex == PROCEDURE && sym->value)
 		{
 			if (type != DELETE_T)
-				return excast(ex, sym->value->data.procedure.body, type, NULL, 0);
+			{
+				Exnode_t *x = excast(ex, sym->value->data.procedure.body, type, NULL, 0);
+				exvmcompile(ex, x);
+				return x;
+			}
 			exfreenode(ex, sym->value);
 			sym->lex = NAME;
 			sym->value = 0;
@@ -171,6 +171,8 @@ exfreenode(Expr_t* p, Exnode_t* x)
 			exfreenode(p, x->data.operand.right);
 		break;
 	}
+	if (x->code)
+		vmfree(p->vm, x->code);
 	vmfree(p->vm, x);
 }
 
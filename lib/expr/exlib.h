@@ -95,7 +95,8 @@ typedef struct Print_s			/* compiled printf arg node	*/
 	}		scan;		/* printf			*/
 
 #define _EX_NODE_PRIVATE_ \
-	int	subop;		/* operator qualifier		*/
+	int	subop;		/* operator qualifier		*/ \
+	struct Excode_s*code;	/* compiled subtree		*/
 
 #define _EX_PROG_PRIVATE_ \
 	Vmalloc_t*	ve;		/* eval tmp region		*/ \
@@ -170,6 +171,11 @@ extern Exstate_t	expr;
 
 extern int		ex_parse(void);	/* yacc should do this		*/
 
+typedef struct Excode_s Excode_t;
+
+extern void		exvmcompile(Expr_t*, Exnode_t*);
+extern Extype_t		exvmeval(Expr_t*, Excode_t*, void*);
+
 #endif
 
 #ifdef __cplusplus
@@ -57,3 +57,40 @@ exopen(Exdisc_t* disc)
 			dtinsert(program->symbols, sym);
 	return program;
 }
+
+/*
+ * allocate an environment that evaluates the expressions of program
+ * with its own string space, so that several threads can evaluate
+ * expressions that do not modify the program's variables at once
+ */
+
+Expr_t*
+exfork(Expr_t* program)
+{
+	Expr_t*	fork;
+
+	if (!(fork = malloc(sizeof(Expr_t))))
+		return 0;
+	*fork = *program;
+	if (!(fork->ve = vmopen()))
+	{
+		free(fork);
+		return 0;
+	}
+	fork->tmp = (agxbuf){0};
+	fork->loopcount = 0;
+	fork->loopop = 0;
+	return fork;
+}
+
+/*
+ * free an environment allocated by exfork()
+ */
+
+void
+exjoin(Expr_t* fork)
+{
+	vmclose(fork->ve);
+	agxbfree(&fork->tmp);
+	free(fork);
+}
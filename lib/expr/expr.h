@@ -244,7 +244,9 @@ __attribute__((format(printf, 1, 2)))
 extern void		exwarn(const char *, ...);
 extern Extype_t		exeval(Expr_t*, Exnode_t*, void*);
 extern Exnode_t*	exexpr(Expr_t*, const char*, Exid_t*, int);
+extern Expr_t*		exfork(Expr_t*);
 extern void		exfreenode(Expr_t*, Exnode_t*);
+extern void		exjoin(Expr_t*);
 extern Exnode_t*	exnewnode(Expr_t*, int, int, long, Exnode_t*, Exnode_t*);
 extern char*		exnospace(void);
 extern Expr_t*		exopen(Exdisc_t*);
@@ -0,0 +1,761 @@
+/*************************************************************************
+ * Copyright (c) 2011 AT&T Intellectual Property
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * https://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors: Details at https://graphviz.org
+ *************************************************************************/
+
+/*
+ * expression library bytecode
+ *
+ * Subtrees of a parsed expression made only of constants, variable and
+ * identifier references, builtin function calls, operators on the builtin
+ * types, assignments to scalar variables, and the statements sequencing them
+ * are translated into code for a small register machine. eval() runs the code
+ * attached to a node instead of walking its subtree. Everything else, notably
+ * break, continue and return, string construction and external types, is left
+ * to eval().
+ *
+ * Each instruction mirrors the corresponding case of eval(), so both give the
+ * same results, errors included.
+ */
+
+#include <expr/exlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGS	32	/* registers per code block			*/
+#define CODE	256	/* instructions per code block			*/
+
+typedef enum {
+	VM_RET,		/* return r[a]					*/
+	VM_JMP,		/* jump to a					*/
+	VM_JZ,		/* jump to b if r[a].integer is 0		*/
+	VM_JNZ,		/* jump to b if r[a].integer is not 0		*/
+	VM_TRUE,	/* r[d] = 1					*/
+	VM_CONST,	/* r[d] = constant of node			*/
+	VM_VAR,		/* r[d] = scalar variable of node		*/
+	VM_ID,		/* r[d] = getf(node), index in r[a] if a >= 0	*/
+	VM_FUNC,	/* r[d] = getf(node), arguments in r[a+1..]	*/
+	VM_STORE,	/* scalar variable of node = r[d] = r[a]	*/
+	VM_INCI,	/* add a to integer variable of node, r[d] =	*/
+	VM_INCF,	/* its new value if b else its old one		*/
+
+	/* conversions and unary operators */
+	VM_F2I, VM_I2F, VM_U2F, VM_S2B, VM_S2I, VM_S2F,
+	VM_NOTI, VM_COMI, VM_NEGI, VM_NOTF, VM_COMF, VM_NEGF,
+
+	/* r[d] = r[a] op r[b] */
+	VM_ADDI, VM_SUBI, VM_MULI, VM_DIVI, VM_MODI,
+	VM_ANDI, VM_IORI, VM_XORI, VM_LSHI, VM_RSHI,
+	VM_EQI, VM_NEI, VM_LTI, VM_LEI, VM_GEI, VM_GTI,
+	VM_LTU, VM_LEU, VM_GEU, VM_GTU,
+	VM_ADDF, VM_SUBF, VM_MULF, VM_DIVF, VM_MODF,
+	VM_ANDF, VM_IORF, VM_XORF, VM_LSHF, VM_RSHF,
+	VM_EQF, VM_NEF, VM_LTF, VM_LEF, VM_GEF, VM_GTF,
+	VM_EQS, VM_NES, VM_LTS, VM_LES, VM_GES, VM_GTS,
+} Exvmop_t;
+
+typedef struct
+{
+	Exvmop_t	op;		/* operation			*/
+	int		d;		/* destination register		*/
+	int		a;		/* first operand		*/
+	int		b;		/* second operand		*/
+	Exnode_t*	node;		/* source node			*/
+} Exinstr_t;
+
+struct Excode_s
+{
+	size_t		size;		/* number of instructions	*/
+	Exinstr_t	code[];		/* instructions			*/
+};
+
+typedef struct
+{
+	Exinstr_t	code[CODE];	/* instructions being generated	*/
+	size_t		size;		/* number of instructions	*/
+} Exgen_t;
+
+static int emit(Exgen_t *g, Exvmop_t op, int d, int a, int b, Exnode_t *node)
+{
+	if (g->size == CODE)
+		return -1;
+	g->code[g->size] = (Exinstr_t){op, d, a, b, node};
+	return (int)g->size++;
+}
+
+/*
+ * operator of a node with a builtin left operand type, or -1
+ */
+
+static int binop(Exnode_t *x)
+{
+	switch (x->op)
+	{
+	case F2I: case I2F: case S2B: case S2F: case S2I:
+	case '!': case '~': case '-': case '+': case '&': case '|': case '^':
+	case '*': case '/': case '%': case LSH: case RSH:
+	case '<': case LE: case EQ: case NE: case GE: case '>':
+		if (x->data.operand.left)
+			break;
+		/*FALLTHROUGH*/
+	default:
+		return -1;
+	}
+
+	const long type = x->data.operand.left->type;
+	const bool unary = x->data.operand.right == NULL;
+
+	switch (type)
+	{
+	case FLOATING:
+		switch (x->op)
+		{
+		case F2I:	return VM_F2I;
+		case '!':	return VM_NOTF;
+		case '~':	return VM_COMF;
+		case '-':	return unary ? VM_NEGF : VM_SUBF;
+		case '+':	return VM_ADDF;
+		case '&':	return VM_ANDF;
+		case '|':	return VM_IORF;
+		case '^':	return VM_XORF;
+		case '*':	return VM_MULF;
+		case '/':	return VM_DIVF;
+		case '%':	return VM_MODF;
+		case '<':	return VM_LTF;
+		case LE:	return VM_LEF;
+		case EQ:	return VM_EQF;
+		case NE:	return VM_NEF;
+		case GE:	return VM_GEF;
+		case '>':	return VM_GTF;
+		case LSH:	return VM_LSHF;
+		case RSH:	return VM_RSHF;
+		}
+		return -1;
+	case UNSIGNED:
+		switch (x->op)
+		{
+		case '<':	return VM_LTU;
+		case LE:	return VM_LEU;
+		case GE:	return VM_GEU;
+		case '>':	return VM_GTU;
+		}
+		/*FALLTHROUGH*/
+	case INTEGER:
+		switch (x->op)
+		{
+		case I2F:
+#ifndef _WIN32
+			if (x->type == UNSIGNED)
+				return VM_U2F;
+#endif
+			return VM_I2F;
+		case '!':	return VM_NOTI;
+		case '~':	return VM_COMI;
+		case '-':	return unary ? VM_NEGI : VM_SUBI;
+		case '+':	return VM_ADDI;
+		case '&':	return VM_ANDI;
+		case '|':	return VM_IORI;
+		case '^':	return VM_XORI;
+		case '*':	return VM_MULI;
+		case '/':	return VM_DIVI;
+		case '%':	return VM_MODI;
+		case EQ:	return VM_EQI;
+		case NE:	return VM_NEI;
+		case LSH:	return VM_LSHI;
+		case RSH:	return VM_RSHI;
+		case '<':	return VM_LTI;
+		case LE:	return VM_LEI;
+		case GE:	return VM_GEI;
+		case '>':	return VM_GTI;
+		}
+		return -1;
+	case STRING:
+		switch (x->op)
+		{
+		case S2B:	return VM_S2B;
+		case S2F:	return VM_S2F;
+		case S2I:	return VM_S2I;
+		case EQ:	return VM_EQS;
+		case NE:	return VM_NES;
+		case '<':	return VM_LTS;
+		case LE:	return VM_LES;
+		case GE:	return VM_GES;
+		case '>':	return VM_GTS;
+		}
+		return -1;
+	}
+	return -1;
+}
+
+/*
+ * scalar variable assigned by x, or NULL
+ */
+
+static Exnode_t *scalar(Exnode_t *x)
+{
+	Exnode_t *v = x->data.operand.left;
+
+	if (!v || v->op != DYNAMIC || v->data.variable.index)
+		return NULL;
+	return v;
+}
+
+/*
+ * generate code leaving the value of x in register d
+ * return -1 if x cannot be compiled
+ */
+
+static int gen(Exgen_t *g, Exnode_t *x, int d)
+{
+	Exnode_t*	a;
+	int		op;
+	int		n;
+	int		j;
+	int		k;
+
+	if (!x || d >= REGS)
+		return -1;
+	switch (x->op)
+	{
+	case CONSTANT:
+		return emit(g, VM_CONST, d, 0, 0, x) < 0 ? -1 : 0;
+	case DYNAMIC:
+		if (x->data.variable.index)
+			return -1;
+		return emit(g, VM_VAR, d, 0, 0, x) < 0 ? -1 : 0;
+	case ID:
+		if (x->data.variable.dyna)
+			return -1;
+		if (!x->data.variable.index)
+			return emit(g, VM_ID, d, -1, 0, x) < 0 ? -1 : 0;
+		if (gen(g, x->data.variable.index, d) < 0)
+			return -1;
+		return emit(g, VM_ID, d, d, 0, x) < 0 ? -1 : 0;
+	case FUNCTION:
+		/* r[d] is the environment slot, arguments follow */
+		n = d + 1;
+		for (a = x->data.operand.right; a; a = a->data.operand.right)
+			if (gen(g, a->data.operand.left, n++) < 0)
+				return -1;
+		return emit(g, VM_FUNC, d, d, n - d - 1, x) < 0 ? -1 : 0;
+	case AND:
+	case OR:
+		if (gen(g, x->data.operand.left, d) < 0)
+			return -1;
+		if ((j = emit(g, x->op == AND ? VM_JZ : VM_JNZ, 0, d, 0, NULL)) < 0)
+			return -1;
+		if (gen(g, x->data.operand.right, d) < 0)
+			return -1;
+		g->code[j].b = (int)g->size;
+		return 0;
+	case INC:
+	case DEC:
+		if (!(a = scalar(x)))
+			return -1;
+		switch (a->type)
+		{
+		case FLOATING:
+			op = VM_INCF;
+			break;
+		case INTEGER:
+		case UNSIGNED:
+			op = VM_INCI;
+			break;
+		default:
+			return -1;
+		}
+		return emit(g, (Exvmop_t)op, d, x->op == INC ? 1 : -1,
+		            x->subop == PRE, a) < 0 ? -1 : 0;
+	case '=':
+		if (!(a = scalar(x)) || a->type == STRING)
+			return -1;
+		if (x->subop == '=')
+		{
+			if (gen(g, x->data.operand.right, d) < 0)
+				return -1;
+			return emit(g, VM_STORE, d, d, 0, a) < 0 ? -1 : 0;
+		}
+		/* the operators whose compound assignment matches the binary one */
+		switch (a->type)
+		{
+		case FLOATING:
+			switch (x->subop)
+			{
+			case '+':	op = VM_ADDF; break;
+			case '-':	op = VM_SUBF; break;
+			case '*':	op = VM_MULF; break;
+			case '/':	op = VM_DIVF; break;
+			case '%':	op = VM_MODF; break;
+			case '&':	op = VM_ANDF; break;
+			case '|':	op = VM_IORF; break;
+			case '^':	op = VM_XORF; break;
+			default:	return -1;
+			}
+			break;
+		case INTEGER:
+		case UNSIGNED:
+			switch (x->subop)
+			{
+			case '+':	op = VM_ADDI; break;
+			case '-':	op = VM_SUBI; break;
+			case '*':	op = VM_MULI; break;
+			case '/':	op = VM_DIVI; break;
+			case '%':	op = VM_MODI; break;
+			case '&':	op = VM_ANDI; break;
+			case '|':	op = VM_IORI; break;
+			case '^':	op = VM_XORI; break;
+			case LSH:	op = VM_LSHI; break;
+			case RSH:	op = VM_RSHI; break;
+			default:	return -1;
+			}
+			break;
+		default:
+			return -1;
+		}
+		if (gen(g, x->data.operand.right, d + 1) < 0 ||
+		    emit(g, VM_VAR, d, 0, 0, a) < 0 ||
+		    emit(g, (Exvmop_t)op, d, d, d + 1, x) < 0)
+			return -1;
+		return emit(g, VM_STORE, d, d, 0, a) < 0 ? -1 : 0;
+	case ';':
+	case ',':
+		/* nothing compiled can break the sequence */
+		if (gen(g, x->data.operand.left, d) < 0)
+			return -1;
+		if (x->data.operand.right && gen(g, x->data.operand.right, d) < 0)
+			return -1;
+		return 0;
+	case IF:
+		a = x->data.operand.right;
+		if (gen(g, x->data.operand.left, d) < 0)
+			return -1;
+		if ((j = emit(g, VM_JZ, 0, d, 0, NULL)) < 0)
+			return -1;
+		if (a->data.operand.left && gen(g, a->data.operand.left, d) < 0)
+			return -1;
+		if ((k = emit(g, VM_JMP, 0, 0, 0, NULL)) < 0)
+			return -1;
+		g->code[j].b = (int)g->size;
+		if (a->data.operand.right && gen(g, a->data.operand.right, d) < 0)
+			return -1;
+		g->code[k].a = (int)g->size;
+		return emit(g, VM_TRUE, d, 0, 0, NULL) < 0 ? -1 : 0;
+	case FOR:
+	case WHILE:
+		/* nothing compiled can break or continue the loop */
+		a = x->data.operand.right;
+		k = (int)g->size;
+		j = -1;
+		if (x->data.operand.left)
+		{
+			if (gen(g, x->data.operand.left, d) < 0)
+				return -1;
+			if ((j = emit(g, VM_JZ, 0, d, 0, NULL)) < 0)
+				return -1;
+		}
+		if (a->data.operand.right && gen(g, a->data.operand.right, d) < 0)
+			return -1;
+		if (a->data.operand.left && gen(g, a->data.operand.left, d) < 0)
+			return -1;
+		if (emit(g, VM_JMP, 0, k, 0, NULL) < 0)
+			return -1;
+		if (j >= 0)
+			g->code[j].b = (int)g->size;
+		return emit(g, VM_TRUE, d, 0, 0, NULL) < 0 ? -1 : 0;
+	case '?':
+		a = x->data.operand.right;
+		if (gen(g, x->data.operand.left, d) < 0)
+			return -1;
+		if ((j = emit(g, VM_JZ, 0, d, 0, NULL)) < 0)
+			return -1;
+		if (gen(g, a->data.operand.left, d) < 0)
+			return -1;
+		if ((k = emit(g, VM_JMP, 0, 0, 0, NULL)) < 0)
+			return -1;
+		g->code[j].b = (int)g->size;
+		if (gen(g, a->data.operand.right, d) < 0)
+			return -1;
+		g->code[k].a = (int)g->size;
+		return 0;
+	}
+	if ((op = binop(x)) < 0)
+		return -1;
+	if ((a = x->data.operand.right) && !BUILTIN(a->type))
+		return -1;
+	if (gen(g, x->data.operand.left, d) < 0)
+		return -1;
+	if (a && gen(g, a, d + 1) < 0)
+		return -1;
+	return emit(g, (Exvmop_t)op, d, d, d + 1, x) < 0 ? -1 : 0;
+}
+
+/*
+ * compile the index expression of an assigned variable
+ */
+
+static void lvalue(Expr_t *ex, Exnode_t *x)
+{
+	if (x && (x->op == ID || x->op == DYNAMIC))
+		exvmcompile(ex, x->data.variable.index);
+}
+
+/*
+ * compile the largest subtrees of x that can be compiled
+ */
+
+void exvmcompile(Expr_t *ex, Exnode_t *x)
+{
+	Exgen_t*	g;
+	Exnode_t*	a;
+
+	/* a lone constant or variable is not worth it */
+	if (!x || x->code || x->op == CONSTANT ||
+	    ((x->op == ID || x->op == DYNAMIC) && !x->data.variable.index))
+		return;
+	if ((g = calloc(1, sizeof(Exgen_t))))
+	{
+		if (gen(g, x, 0) == 0 && emit(g, VM_RET, 0, 0, 0, NULL) >= 0 &&
+		    (x->code = vmalloc(ex->vm, sizeof(Excode_t) + g->size * sizeof(Exinstr_t))))
+		{
+			x->code->size = g->size;
+			memcpy(x->code->code, g->code, g->size * sizeof(Exinstr_t));
+			free(g);
+			return;
+		}
+		free(g);
+	}
+	switch (x->op)
+	{
+	case ID:
+	case DYNAMIC:
+		lvalue(ex, x);
+		break;
+	case INC:
+	case DEC:
+		lvalue(ex, x->data.operand.left);
+		break;
+	case '=':
+		lvalue(ex, x->data.operand.left);
+		exvmcompile(ex, x->data.operand.right);
+		break;
+	case CALL:
+		for (a = x->data.call.args; a; a = a->data.operand.right)
+			exvmcompile(ex, a->data.operand.left);
+		break;
+	case FUNCTION:
+		for (a = x->data.operand.right; a; a = a->data.operand.right)
+			exvmcompile(ex, a->data.operand.left);
+		break;
+	case ITERATE:
+	case ITERATER:
+		exvmcompile(ex, x->data.generate.statement);
+		break;
+	case SWITCH:
+		exvmcompile(ex, x->data.operand.left);
+		for (a = x->data.operand.right; a; a = a->data.select.next)
+			exvmcompile(ex, a->data.select.statement);
+		break;
+	case ADDRESS:
+	case ARRAY:
+	case GSUB:
+	case IN_OP:
+	case PRINT:
+	case PRINTF:
+	case RAND:
+	case SCANF:
+	case SPLIT:
+	case SPRINTF:
+	case SRAND:
+	case SSCANF:
+	case SUB:
+	case SUBSTR:
+	case TOKENS:
+	case UNSET:
+	case '#':
+		break;
+	default:
+		/* statements and the operators eval() applies to its operands */
+		exvmcompile(ex, x->data.operand.left);
+		exvmcompile(ex, x->data.operand.right);
+		break;
+	}
+}
+
+/*
+ * run the code of a compiled subtree
+ */
+
+Extype_t exvmeval(Expr_t *ex, Excode_t *code, void *env)
+{
+	Extype_t		r[REGS];
+	Extype_t		i;
+	Exnode_t		tmp;
+	char*			e;
+	const Exinstr_t*	pc = code->code;
+
+	for (;; pc++)
+	{
+#define RA	r[pc->a]
+#define RB	r[pc->b]
+#define RD	r[pc->d]
+		switch (pc->op)
+		{
+		case VM_RET:
+			return RA;
+		case VM_JMP:
+			pc = &code->code[pc->a] - 1;
+			continue;
+		case VM_JZ:
+			if (!RA.integer)
+				pc = &code->code[pc->b] - 1;
+			continue;
+		case VM_JNZ:
+			if (RA.integer)
+				pc = &code->code[pc->b] - 1;
+			continue;
+		case VM_TRUE:
+			RD.integer = 1;
+			continue;
+		case VM_CONST:
+			RD = pc->node->data.constant.value;
+			continue;
+		case VM_VAR:
+			RD = pc->node->data.variable.symbol->value->data.constant.value;
+			continue;
+		case VM_ID:
+			if (pc->a >= 0)
+				i = RA;
+			else
+				i.integer = EX_SCALAR;
+			RD = ex->disc->getf(ex, pc->node, pc->node->data.variable.symbol,
+			                    pc->node->data.variable.reference, env,
+			                    (int)i.integer, ex->disc);
+			continue;
+		case VM_FUNC:
+			r[pc->a].string = env;
+			RD = ex->disc->getf(ex, pc->node->data.operand.left,
+			                    pc->node->data.operand.left->data.variable.symbol,
+			                    pc->node->data.operand.left->data.variable.reference,
+			                    &r[pc->a + 1], EX_CALL, ex->disc);
+			continue;
+		case VM_STORE:
+			RD = pc->node->data.variable.symbol->value->data.constant.value = RA;
+			continue;
+		case VM_INCI:
+			i = pc->node->data.variable.symbol->value->data.constant.value;
+			pc->node->data.variable.symbol->value->data.constant.value.integer += pc->a;
+			RD = pc->b ? pc->node->data.variable.symbol->value->data.constant.value : i;
+			continue;
+		case VM_INCF:
+			i = pc->node->data.variable.symbol->value->data.constant.value;
+			pc->node->data.variable.symbol->value->data.constant.value.floating += pc->a;
+			RD = pc->b ? pc->node->data.variable.symbol->value->data.constant.value : i;
+			continue;
+		case VM_F2I:
+			RD.integer = RA.floating;
+			continue;
+		case VM_I2F:
+			RD.floating = RA.integer;
+			continue;
+		case VM_U2F:
+			RD.floating = (unsigned long long)RA.integer;
+			continue;
+		case VM_S2B:
+			RD.integer = *RA.string != 0;
+			continue;
+		case VM_S2F:
+			tmp = *pc->node->data.operand.left;
+			tmp.data.constant.value = RA;
+			if (ex->disc->convertf(&tmp, FLOATING, 0))
+			{
+				tmp.data.constant.value.floating = strtod(RA.string, &e);
+				if (*e)
+					tmp.data.constant.value.floating = *RA.string != 0;
+			}
+			RD = tmp.data.constant.value;
+			continue;
+		case VM_S2I:
+			tmp = *pc->node->data.operand.left;
+			tmp.data.constant.value = RA;
+			if (ex->disc->convertf(&tmp, INTEGER, 0))
+			{
+				if (RA.string) {
+					tmp.data.constant.value.integer = strtoll(RA.string, &e, 0);
+					if (*e)
+						tmp.data.constant.value.integer = *RA.string != 0;
+				}
+				else
+					tmp.data.constant.value.integer = 0;
+			}
+			RD = tmp.data.constant.value;
+			continue;
+		case VM_NOTI:
+			RD.integer = !RA.integer;
+			continue;
+		case VM_COMI:
+			RD.integer = ~RA.integer;
+			continue;
+		case VM_NEGI:
+			RD.integer = -RA.integer;
+			continue;
+		case VM_NOTF:
+			RD.floating = !(long long)RA.floating;
+			continue;
+		case VM_COMF:
+			RD.floating = ~(long long)RA.floating;
+			continue;
+		case VM_NEGF:
+			RD.floating = -RA.floating;
+			continue;
+		case VM_ADDI:
+			RD.integer = RA.integer + RB.integer;
+			continue;
+		case VM_SUBI:
+			RD.integer = RA.integer - RB.integer;
+			continue;
+		case VM_MULI:
+			RD.integer = RA.integer * RB.integer;
+			continue;
+		case VM_DIVI:
+			if (RB.integer == 0)
+				exerror("integer divide by 0");
+			else
+				RD.integer = RA.integer / RB.integer;
+			continue;
+		case VM_MODI:
+			if (RB.integer == 0)
+				exerror("integer 0 modulus");
+			else
+				RD.integer = RA.integer % RB.integer;
+			continue;
+		case VM_ANDI:
+			RD.integer = RA.integer & RB.integer;
+			continue;
+		case VM_IORI:
+			RD.integer = RA.integer | RB.integer;
+			continue;
+		case VM_XORI:
+			RD.integer = RA.integer ^ RB.integer;
+			continue;
+		case VM_LSHI:
+			RD.integer = RA.integer << RB.integer;
+			continue;
+		case VM_RSHI:
+			RD.integer = (unsigned long long)RA.integer >> RB.integer;
+			continue;
+		case VM_EQI:
+			RD.integer = RA.integer == RB.integer;
+			continue;
+		case VM_NEI:
+			RD.integer = RA.integer != RB.integer;
+			continue;
+		case VM_LTI:
+			RD.integer = RA.integer < RB.integer;
+			continue;
+		case VM_LEI:
+			RD.integer = RA.integer <= RB.integer;
+			continue;
+		case VM_GEI:
+			RD.integer = RA.integer >= RB.integer;
+			continue;
+		case VM_GTI:
+			RD.integer = RA.integer > RB.integer;
+			continue;
+		case VM_LTU:
+			RD.integer = (unsigned long long)RA.integer < (unsigned long long)RB.integer;
+			continue;
+		case VM_LEU:
+			RD.integer = (unsigned long long)RA.integer <= (unsigned long long)RB.integer;
+			continue;
+		case VM_GEU:
+			RD.integer = (unsigned long long)RA.integer >= (unsigned long long)RB.integer;
+			continue;
+		case VM_GTU:
+			RD.integer = (unsigned long long)RA.integer > (unsigned long long)RB.integer;
+			continue;
+		case VM_ADDF:
+			RD.floating = RA.floating + RB.floating;
+			continue;
+		case VM_SUBF:
+			RD.floating = RA.floating - RB.floating;
+			continue;
+		case VM_MULF:
+			RD.floating = RA.floating * RB.floating;
+			continue;
+		case VM_DIVF:
+			if (RB.floating == 0.0)
+				exerror("floating divide by 0");
+			else
+				RD.floating = RA.floating / RB.floating;
+			continue;
+		case VM_MODF:
+			if ((i.integer = RB.floating) == 0)
+				exerror("floating 0 modulus");
+			else
+				RD.floating = (long long)RA.floating % i.integer;
+			continue;
+		case VM_ANDF:
+			RD.floating = (long long)RA.floating & (long long)RB.floating;
+			continue;
+		case VM_IORF:
+			RD.floating = (long long)RA.floating | (long long)RB.floating;
+			continue;
+		case VM_XORF:
+			RD.floating = (long long)RA.floating ^ (long long)RB.floating;
+			continue;
+		case VM_LSHF:
+			RD.integer = (long long)((unsigned long long)RA.floating << (long long)RB.floating);
+			continue;
+		case VM_RSHF:
+			RD.integer = (long long)((unsigned long long)RA.floating >> (long long)RB.floating);
+			continue;
+		case VM_EQF:
+			RD.integer = RA.floating == RB.floating;
+			continue;
+		case VM_NEF:
+			RD.integer = RA.floating != RB.floating;
+			continue;
+		case VM_LTF:
+			RD.integer = RA.floating < RB.floating;
+			continue;
+		case VM_LEF:
+			RD.integer = RA.floating <= RB.floating;
+			continue;
+		case VM_GEF:
+			RD.integer = RA.floating >= RB.floating;
+			continue;
+		case VM_GTF:
+			RD.integer = RA.floating > RB.floating;
+			continue;
+		case VM_EQS:
+		case VM_NES:
+			RD.integer = ((RA.string && RB.string)
+			              ? strmatch(RA.string, RB.string)
+			              : (RA.string == RB.string)) == (pc->op == VM_EQS);
+			continue;
+		case VM_LTS:
+			RD.integer = strcoll(RA.string, RB.string) < 0;
+			continue;
+		case VM_LES:
+			RD.integer = strcoll(RA.string, RB.string) <= 0;
+			continue;
+		case VM_GES:
+			RD.integer = strcoll(RA.string, RB.string) >= 0;
+			continue;
+		case VM_GTS:
+			RD.integer = strcoll(RA.string, RB.string) > 0;
+			continue;
+		}
+	}
+}
+
+#undef RA
+#undef RB
+#undef RD
@@ -1,7 +1,15 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <new>
+#include <ostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "GVContext.h"
 #include "GVLayout.h"
@@ -25,6 +33,23 @@ GVLayout::GVLayout(const std::shared_ptr<GVContext> &gvc,
   }
 }
 
+GVLayout::GVLayout(const std::shared_ptr<GVContext> &gvc,
+                   const std::shared_ptr<CGraph::AGraph> &g,
+                   const std::string &engine,
+                   const std::vector<Agnode_t *> &changed)
+    : m_gvc(gvc), m_g(g) {
+  if (gvLayoutDone(g->c_struct())) {
+    gvFreeLayout(gvc->c_struct(), g->c_struct());
+    throw std::runtime_error("Previous layout not yet destroyed");
+  }
+  const auto rc =
+      gvLayoutUpdate(gvc->c_struct(), g->c_struct(), engine.c_str(),
+                     const_cast<Agnode_t **>(changed.data()), changed.size());
+  if (rc) {
+    throw std::runtime_error("Layout failed");
+  }
+}
+
 GVLayout::GVLayout(GVContext &&gvc, CGraph::AGraph &&g,
                    const std::string &engine)
     : GVLayout(std::make_shared<GVContext>(std::move(gvc)),
@@ -48,19 +73,87 @@ GVLayout::~GVLayout() {
   gvFreeLayout(m_gvc->c_struct(), m_g->c_struct());
 }
 
+namespace {
+
+// state passed through gvRenderSink to write_to_sink
+struct SinkContext {
+  const std::function<void(std::string_view)> &sink;
+  std::exception_ptr error;
+};
+
+size_t write_to_sink(void *context, const char *data, size_t length) {
+  auto &ctx = *static_cast<SinkContext *>(context);
+  // exceptions cannot propagate through the C rendering code, so they are
+  // saved to be rethrown when it returns. Short writes are fatal in gvc, so the
+  // rest of the output is consumed and dropped instead.
+  if (ctx.error) {
+    return length;
+  }
+  try {
+    ctx.sink(std::string_view{data, length});
+  } catch (...) {
+    ctx.error = std::current_exception();
+  }
+  return length;
+}
+
+} // namespace
+
 GVRenderData GVLayout::render(const std::string &format) const {
-  char *result = nullptr;
-  unsigned int length = 0;
-  const auto rc = gvRenderData(m_gvc->c_struct(), m_g->c_struct(),
-                               format.c_str(), &result, &length);
+  // grow the buffer geometrically, keeping it null terminated
+  std::size_t capacity = 4096;
+  std::size_t length = 0;
+  auto data = static_cast<char *>(std::malloc(capacity));
+  if (data == nullptr) {
+    throw std::bad_alloc();
+  }
+  data[0] = '\0';
+
+  try {
+    render(format, [&](std::string_view chunk) {
+      if (chunk.size() >= capacity - length) {
+        std::size_t new_capacity = capacity;
+        while (chunk.size() >= new_capacity - length) {
+          new_capacity *= 2;
+        }
+        auto new_data = static_cast<char *>(std::realloc(data, new_capacity));
+        if (new_data == nullptr) {
+          throw std::bad_alloc();
+        }
+        data = new_data;
+        capacity = new_capacity;
+      }
+      std::copy(chunk.begin(), chunk.end(), data + length);
+      length += chunk.size();
+      data[length] = '\0';
+    });
+  } catch (...) {
+    std::free(data);
+    throw;
+  }
+
+  return GVRenderData(data, length);
+}
+
+void GVLayout::render(const std::string &format,
+                      const std::function<void(std::string_view)> &sink) const {
+  SinkContext ctx{sink, nullptr};
+  const auto rc = gvRenderSink(m_gvc->c_struct(), m_g->c_struct(),
+                               format.c_str(), write_to_sink, &ctx);
+  if (ctx.error) {
+    std::rethrow_exception(ctx.error);
+  }
   if (rc) {
-    if (result) {
-      gvFreeRenderData(result);
-    }
     throw std::runtime_error("Rendering failed");
   }
+}
 
-  return GVRenderData(result, length);
+void GVLayout::render(const std::string &format, std::ostream &os) const {
+  render(format, [&](std::string_view chunk) {
+    if (!os.write(chunk.data(), static_cast<std::streamsize>(chunk.size()))) {
+      throw std::runtime_error("Writing rendered output failed");
+    }
+  });
 }
 
 } // namespace GVC
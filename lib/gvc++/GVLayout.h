@@ -1,6 +1,10 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <ostream>
+#include <string_view>
+#include <vector>
 
 #include "AGraph.h"
 #include "GVContext.h"
@@ -33,6 +37,12 @@ public:
            const std::string &engine);
   GVLayout(GVContext &&gvc, std::shared_ptr<CGraph::AGraph> g,
            const std::string &engine);
+  // lay out a graph starting from the layout in its pos attributes, as left
+  // by rendering a previous layout in the dot format, in which only the given
+  // nodes and their edges have changed
+  GVLayout(const std::shared_ptr<GVContext> &gvc,
+           const std::shared_ptr<CGraph::AGraph> &g, const std::string &engine,
+           const std::vector<Agnode_t *> &changed);
   ~GVLayout();
 
   // default copy since we manage resources through movable types
@@ -46,6 +56,15 @@ public:
   // render the layout in the specified format
   GVRenderData render(const std::string &format) const;
 
+  // render the layout in the specified format, passing each chunk of output to
+  // the sink as it is produced instead of accumulating it in memory. An
+  // exception thrown by the sink stops the rendering and is rethrown.
+  void render(const std::string &format,
+              const std::function<void(std::string_view)> &sink) const;
+
+  // render the layout in the specified format to an output stream
+  void render(const std::string &format, std::ostream &os) const;
+
 private:
   std::shared_ptr<GVContext> m_gvc;
   std::shared_ptr<CGraph::AGraph> m_g;
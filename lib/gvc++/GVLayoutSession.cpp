@@ -0,0 +1,103 @@
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "GVContext.h"
+#include "GVLayout.h"
+#include "GVLayoutSession.h"
+#include "GVRenderData.h"
+#include <cgraph++/AGraph.h>
+#include <gvc/gvc.h>
+
+namespace GVC {
+
+namespace {
+
+/// applies attribute overrides and restores the previous values on destruction
+class OverrideScope {
+public:
+  OverrideScope(
+      const std::vector<GVLayoutSession::AttributeOverride> &overrides) {
+    m_saved.reserve(overrides.size());
+    for (const auto &o : overrides) {
+      Agraph_t *g = agraphof(o.object);
+      Agraph_t *root = agroot(o.object);
+      auto name = const_cast<char *>(o.name.c_str());
+      Agsym_t *sym = agattr(root, AGTYPE(o.object), name, nullptr);
+      if (sym == nullptr) {
+        // declare the attribute with an empty default, which is what the
+        // layout engines assume for an attribute that is not set
+        sym = agattr(root, AGTYPE(o.object), name, "");
+      }
+      // take another reference to the current value, so that restoring it
+      // finds the same string, including whether it is an HTML-like label
+      char *previous = agstrdup(g, agxget(o.object, sym));
+      m_saved.push_back({o.object, sym, previous});
+      agxset(o.object, sym, o.value.c_str());
+    }
+  }
+
+  ~OverrideScope() {
+    // restore in reverse, so the oldest value wins if an attribute of an
+    // object was overridden more than once
+    for (auto it = m_saved.rbegin(); it != m_saved.rend(); ++it) {
+      agxset(it->object, it->sym, it->previous);
+      agstrfree(agraphof(it->object), it->previous);
+    }
+  }
+
+  OverrideScope(const OverrideScope &) = delete;
+  OverrideScope &operator=(const OverrideScope &) = delete;
+
+private:
+  struct Saved {
+    void *object;
+    Agsym_t *sym;
+    char *previous;
+  };
+  std::vector<Saved> m_saved;
+};
+
+} // namespace
+
+GVLayoutSession::GVLayoutSession(std::shared_ptr<GVContext> gvc,
+                                 std::shared_ptr<CGraph::AGraph> g,
+                                 std::string engine)
+    : m_gvc(std::move(gvc)), m_g(std::move(g)), m_engine(std::move(engine)) {}
+
+GVLayoutSession::GVLayoutSession(std::shared_ptr<GVContext> gvc,
+                                 const std::string &dot, std::string engine)
+    : GVLayoutSession(std::move(gvc), std::make_shared<CGraph::AGraph>(dot),
+                      std::move(engine)) {}
+
+void GVLayoutSession::layout(
+    const std::vector<AttributeOverride> &overrides,
+    const std::function<void(const GVLayout &)> &f) const {
+  OverrideScope scope(overrides);
+  // the layout is freed before the overrides are restored
+  const GVLayout layout(m_gvc, m_g, m_engine);
+  f(layout);
+}
+
+GVRenderData
+GVLayoutSession::render(const std::string &format,
+                        const std::vector<AttributeOverride> &overrides) const {
+  std::optional<GVRenderData> result;
+  layout(overrides,
+         [&](const GVLayout &layout) { result.emplace(layout.render(format)); });
+  return std::move(*result);
+}
+
+void GVLayoutSession::render(
+    const std::string &format, const std::vector<AttributeOverride> &overrides,
+    const std::function<void(std::string_view)> &sink) const {
+  layout(overrides,
+         [&](const GVLayout &layout) { layout.render(format, sink); });
+}
+
+} // namespace GVC
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AGraph.h"
+#include "GVContext.h"
+#include "GVLayout.h"
+#include "GVRenderData.h"
+
+#ifdef GVDLL
+#if gvc___EXPORTS // CMake's substitution of gvc++_EXPORTS
+#define GVLAYOUTSESSION_API __declspec(dllexport)
+#else
+#define GVLAYOUTSESSION_API __declspec(dllimport)
+#endif
+#endif
+
+#ifndef GVLAYOUTSESSION_API
+#define GVLAYOUTSESSION_API /* nothing */
+#endif
+
+namespace GVC {
+
+/**
+ * @brief The GVLayoutSession class lays out many variations of one graph
+ *
+ * The session keeps a parsed template graph. Each layout applies attribute
+ * overrides to it, lays it out, and then restores the template, so similar
+ * graphs can be laid out repeatedly without parsing DOT each time. Nodes,
+ * edges and subgraphs can be added to or deleted from the template between
+ * layouts through the graph() accessor; such changes persist.
+ */
+
+class GVLAYOUTSESSION_API GVLayoutSession {
+public:
+  /// an attribute value to use for a single layout instead of the template's
+  struct AttributeOverride {
+    void *object; ///< the graph, or a node, edge or subgraph of it
+    std::string name;
+    std::string value;
+  };
+
+  GVLayoutSession(std::shared_ptr<GVContext> gvc,
+                  std::shared_ptr<CGraph::AGraph> g, std::string engine);
+  GVLayoutSession(std::shared_ptr<GVContext> gvc, const std::string &dot,
+                  std::string engine);
+
+  // the template graph
+  CGraph::AGraph &graph() const { return *m_g; }
+
+  // lay out the template with the given attribute overrides, and pass the
+  // layout to f. The overrides are removed again once f returns.
+  void layout(const std::vector<AttributeOverride> &overrides,
+              const std::function<void(const GVLayout &)> &f) const;
+
+  // lay out the template with the given attribute overrides and render it in
+  // the specified format
+  GVRenderData render(const std::string &format,
+                      const std::vector<AttributeOverride> &overrides = {}) const;
+
+  // lay out the template with the given attribute overrides and pass the
+  // rendering in the specified format to the sink as it is produced
+  void render(const std::string &format,
+              const std::vector<AttributeOverride> &overrides,
+              const std::function<void(std::string_view)> &sink) const;
+
+private:
+  std::shared_ptr<GVContext> m_gvc;
+  std::shared_ptr<CGraph::AGraph> m_g;
+  std::string m_engine;
+};
+
+} // namespace GVC
+
+#undef GVLAYOUTSESSION_API
@@ -12,11 +12,14 @@
 
 #include <gvc/gvc.h>
 #include <common/const.h>
+#include <common/instrument.h>
+#include <common/render.h>
 #include <gvc/gvcjob.h>
 #include <gvc/gvcint.h>
 #include <gvc/gvcproc.h>
 #include <gvc/gvconfig.h>
 #include <gvc/gvio.h>
+#include <limits.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -44,12 +47,13 @@ GVC_t *gvContextPlugins(const lt_symlist_t *builtins, int demand_loading)
 
 
 
-/* gvLayout:
+/* layout:
  * Selects layout based on engine and binds it to gvc;
- * does the layout and sets the graph's bbox.
+ * does the layout with the given GD_flags and sets the graph's bbox.
  * Return 0 on success.
  */
-int gvLayout(GVC_t *gvc, graph_t *g, const char *engine)
+static int layout(GVC_t *gvc, graph_t *g, const char *engine,
+                  unsigned short flags)
 {
     char buf[256];
     int rc;
@@ -61,7 +65,7 @@ int gvLayout(GVC_t *gvc, graph_t *g, const char *engine)
         return -1;
     }
 
-    if (gvLayoutJobs(gvc, g) == -1)
+    if (gvlayout_jobs(gvc, g, flags) == -1)
 	return -1;
 
 /* set bb attribute for basic layout.
@@ -80,6 +84,49 @@ int gvLayout(GVC_t *gvc, graph_t *g, const char *engine)
     return 0;
 }
 
+/* gvLayout:
+ * Selects layout based on engine and binds it to gvc;
+ * does the layout and sets the graph's bbox.
+ * Return 0 on success.
+ */
+int gvLayout(GVC_t *gvc, graph_t *g, const char *engine)
+{
+    return layout(gvc, g, engine, 0);
+}
+
+/* gvLayoutUpdate:
+ * As gvLayout, but starting from the previous layout of g, as recorded in
+ * the pos attributes of its nodes and edges by attach_attrs or by rendering
+ * to the dot format. If g still has a layout, it is recorded and freed first;
+ * g must not have been edited since.
+ * The nodes in changed, and the edges at them, are placed afresh, so the
+ * caller lists the nodes that were added, resized or had edges added or
+ * removed. Their pos attributes are cleared.
+ * Return 0 on success.
+ */
+int gvLayoutUpdate(GVC_t *gvc, graph_t *g, const char *engine,
+                   Agnode_t **changed, size_t n_changed)
+{
+    if (gvLayoutDone(g)) {
+	attach_attrs(g);
+	gvFreeLayout(gvc, g);
+    }
+
+    Agsym_t *N_pos = agattr(g, AGNODE, "pos", NULL);
+    Agsym_t *E_pos = agattr(g, AGEDGE, "pos", NULL);
+    for (size_t i = 0; i < n_changed; i++) {
+	Agnode_t *n = changed[i];
+	if (N_pos)
+	    agxset(n, N_pos, "");
+	if (E_pos) {
+	    for (Agedge_t *e = agfstedge(g, n); e; e = agnxtedge(g, e, n))
+		agxset(e, E_pos, "");
+	}
+    }
+
+    return layout(gvc, g, engine, WARM_START);
+}
+
 /* Render layout in a specified format to an open FILE */
 int gvRender(GVC_t *gvc, graph_t *g, const char *format, FILE *out)
 {
@@ -207,15 +254,53 @@ int gvRenderData(GVC_t *gvc, graph_t *g, const char *format, char **result, unsi
     rc = gvRenderJobs(gvc, g);
     gvrender_end_job(job);
 
+    if (rc == 0 && job->output_data_position > UINT_MAX) {
+	agerrorf("rendered output is too large for gvRenderData; "
+	         "use gvRenderSink instead\n");
+	rc = -1;
+    }
+    *result = job->output_data;
     if (rc == 0) {
-	*result = job->output_data;
-	*length = job->output_data_position;
+	*length = (unsigned)job->output_data_position;
     }
     gvjobs_delete(gvc);
 
     return rc;
 }
 
+/* Render layout in a specified format, passing the output to a sink */
+int gvRenderSink(GVC_t *gvc, graph_t *g, const char *format,
+                 size_t (*sink)(void *context, const char *data, size_t length),
+                 void *context)
+{
+    int rc;
+    GVJ_t *job;
+
+    /* create a job for the required format */
+    bool r = gvjobs_output_langname(gvc, format);
+    job = gvc->job;
+    if (!r) {
+	agerrorf("Format: \"%s\" not recognized. Use one of:%s\n",
+                format, gvplugin_list(gvc, API_device, format));
+	return -1;
+    }
+
+    job->output_lang = gvrender_select(job, job->output_langname);
+    if (!LAYOUT_DONE(g) && !(job->flags & LAYOUT_NOT_REQUIRED)) {
+	agerrorf( "Layout was not done\n");
+	return -1;
+    }
+
+    job->output_sink = sink;
+    job->output_sink_context = context;
+
+    rc = gvRenderJobs(gvc, g);
+    gvrender_end_job(job);
+    gvjobs_delete(gvc);
+
+    return rc;
+}
+
 /* gvFreeRenderData:
  * Utility routine to free memory allocated in gvRenderData, as the application code may use
  * a different runtime library.
@@ -230,6 +315,47 @@ void gvAddLibrary(GVC_t *gvc, gvplugin_library_t *lib)
     gvconfig_plugin_install_from_library(gvc, NULL, lib);
 }
 
+void gvTraceEnable(GVC_t *gvc, bool enable)
+{
+    if (enable && gvc->trace == NULL)
+	gvc->trace = gvtrace_new();
+    gvc->tracing = enable;
+}
+
+const gvtrace_span_t *gvTraceSpans(GVC_t *gvc, size_t *count)
+{
+    if (gvc->trace == NULL) {
+	*count = 0;
+	return NULL;
+    }
+    return gvtrace_spans(gvc->trace, count);
+}
+
+const gvtrace_counter_t *gvTraceCounters(GVC_t *gvc, size_t *count)
+{
+    if (gvc->trace == NULL) {
+	*count = 0;
+	return NULL;
+    }
+    return gvtrace_counters(gvc->trace, count);
+}
+
+int gvTraceWrite(GVC_t *gvc, FILE *out, gvtrace_format_t format)
+{
+    if (gvc->trace == NULL)
+	gvc->trace = gvtrace_new();
+    gv_fixLocale(1);
+    int rc = gvtrace_write(gvc->trace, out, format);
+    gv_fixLocale(0);
+    return rc;
+}
+
+void gvTraceClear(GVC_t *gvc)
+{
+    if (gvc->trace != NULL)
+	gvtrace_clear(gvc->trace);
+}
+
 char **gvcInfo(GVC_t* gvc) { return gvc->common.info; }
 char *gvcVersion(GVC_t* gvc) { return gvc->common.info[1]; }
 char *gvcBuildDate(GVC_t* gvc) { return gvc->common.info[2]; }
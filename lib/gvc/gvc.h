@@ -24,6 +24,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "types.h"
 #include "gvplugin.h"
@@ -75,6 +76,27 @@ GVC_API graph_t *gvPluginsGraph(GVC_t *gvc);
 /* Compute a layout using a specified engine */
 GVC_API int gvLayout(GVC_t *gvc, graph_t *g, const char *engine);
 
+/** Compute a layout, starting from the previous layout of the graph
+ *
+ * The previous layout is read from the `pos` attributes of the nodes and
+ * edges, as recorded by @ref attach_attrs or by rendering to the dot format.
+ * If the graph still has a layout, it is recorded and freed first; this is
+ * only possible if the graph has not been edited since, so callers that edit
+ * the graph record and free the layout before doing so. Layout
+ * engines reuse what they can of it; dot keeps the ranks and order of the
+ * unchanged nodes and the splines of edges whose end points did not move.
+ *
+ * @param gvc Graphviz context
+ * @param g graph to lay out
+ * @param engine layout engine
+ * @param changed nodes that were added, resized, or had edges added or
+ *   removed since the previous layout; they and their edges are placed afresh
+ * @param n_changed number of nodes in changed
+ * @return 0 on success
+ */
+GVC_API int gvLayoutUpdate(GVC_t *gvc, graph_t *g, const char *engine,
+                           Agnode_t **changed, size_t n_changed);
+
 /* Compute a layout using layout engine from command line args */
 GVC_API int gvLayoutJobs(GVC_t *gvc, graph_t *g);
 
@@ -96,6 +118,26 @@ GVC_API int gvRenderContext(GVC_t *gvc, graph_t *g, const char *format, void *co
 /* Render layout in a specified format to a malloc'ed string */
 GVC_API int gvRenderData(GVC_t *gvc, graph_t *g, const char *format, char **result, unsigned int *length);
 
+/** Render layout in a specified format, passing the output to a sink
+ *
+ * Unlike @ref gvRenderData, the output is not accumulated in memory. The sink
+ * is called with each chunk of output as it is produced, so arbitrarily large
+ * outputs can be streamed to a socket, a compressor, or similar.
+ *
+ * @param gvc Graphviz context
+ * @param g graph to render
+ * @param format output format
+ * @param sink called with the given context and each chunk of output; it
+ *   returns the number of bytes it consumed, and anything less than the length
+ *   of the chunk is treated as a write error
+ * @param context passed to the sink unchanged
+ * @return 0 on success
+ */
+GVC_API int gvRenderSink(GVC_t *gvc, graph_t *g, const char *format,
+                         size_t (*sink)(void *context, const char *data,
+                                        size_t length),
+                         void *context);
+
 /* Free memory allocated and pointed to by *result in gvRenderData */
 GVC_API void gvFreeRenderData (char* data);
 
@@ -125,6 +167,85 @@ GVC_API char **gvPluginList(GVC_t *gvc, const char *kind, int *sz);
  */
 GVC_API void gvAddLibrary(GVC_t *gvc, gvplugin_library_t *lib);
 
+/** Bound the memory used by images decoded by the loadimage plugins
+ *
+ * Decoded images are kept between renders, so that an image used by many
+ * nodes or graphs is only read once. When they exceed the limit, the least
+ * recently rendered ones are freed and decoded again if they are needed. The
+ * default is 256 MiB.
+ *
+ * Images are shared by all contexts in the process, so this limit and the
+ * cache it bounds are process-wide.
+ *
+ * @param bytes limit, in bytes
+ */
+GVC_API void gvSetImageCacheLimit(size_t bytes);
+
+/// Get the memory used by the decoded images currently kept, in bytes
+GVC_API size_t gvImageCacheSize(void);
+
+/// a timed phase of processing, recorded while tracing is enabled
+typedef struct {
+  const char *name; ///< phase, e.g. "parse", "rank", "mincross" or "render"
+  size_t parent;    ///< index of the enclosing span, or SIZE_MAX if none
+  double start;     ///< wall clock start, in seconds since tracing was enabled
+  double wall;      ///< elapsed wall clock time, in seconds; < 0 while open
+  double cpu;       ///< elapsed processor time, in seconds; < 0 while open
+} gvtrace_span_t;
+
+/// an algorithm counter, accumulated over the span it was counted in
+typedef struct {
+  size_t span;      ///< index of the span the counter belongs to
+  const char *name; ///< e.g. "mincross iterations"
+  unsigned long long value;
+} gvtrace_counter_t;
+
+/// formats for @ref gvTraceWrite
+typedef enum {
+  GVTRACE_CHROME, ///< Chrome trace event format, as read by Perfetto
+  GVTRACE_JSON,   ///< a tree of spans with their counters
+} gvtrace_format_t;
+
+/** Start or stop recording per phase timings and counters
+ *
+ * While enabled, parsing, layout and rendering through this context record
+ * nested spans and algorithm counters, which accumulate until
+ * @ref gvTraceClear. Each context records only the work done through it.
+ *
+ * @param gvc Graphviz context
+ * @param enable whether to record
+ */
+GVC_API void gvTraceEnable(GVC_t *gvc, bool enable);
+
+/** Get the spans recorded so far
+ *
+ * @param gvc Graphviz context
+ * @param [out] count number of spans
+ * @return spans in the order they were started, valid until tracing is next
+ *   enabled, cleared, or records another span
+ */
+GVC_API const gvtrace_span_t *gvTraceSpans(GVC_t *gvc, size_t *count);
+
+/** Get the counters recorded so far
+ *
+ * @param gvc Graphviz context
+ * @param [out] count number of counters
+ * @return counters, valid as for @ref gvTraceSpans
+ */
+GVC_API const gvtrace_counter_t *gvTraceCounters(GVC_t *gvc, size_t *count);
+
+/** Write the spans and counters recorded so far
+ *
+ * @param gvc Graphviz context
+ * @param out file to write to
+ * @param format output format
+ * @return 0 on success
+ */
+GVC_API int gvTraceWrite(GVC_t *gvc, FILE *out, gvtrace_format_t format);
+
+/// Discard the spans and counters recorded so far
+GVC_API void gvTraceClear(GVC_t *gvc);
+
 /** Perform a Transitive Reduction on a graph
  * @param g  graph to be transformed.
  */
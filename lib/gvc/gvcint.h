@@ -20,6 +20,7 @@ extern "C" {
 #include "gvcommon.h"
 #include "gvcjob.h"
 #include "color.h"
+#include "gvc.h"
 #include <stdbool.h>
 
 #ifdef GVDLL
@@ -49,6 +50,8 @@ extern "C" {
     } gvplugin_active_textlayout_t;
 
     typedef struct gvplugin_package_s gvplugin_package_t;
+    typedef struct textspan_cache_s textspan_cache_t;
+    typedef struct htmlsize_cache_s htmlsize_cache_t;
 
     struct gvplugin_package_s {
         gvplugin_package_t *next;
@@ -105,6 +108,9 @@ extern "C" {
 	/* fonts and textlayout */
 	Dtdisc_t textfont_disc;
 	Dt_t *textfont_dt;
+	textspan_cache_t *textspan_cache; ///< memoized text measurements
+	htmlsize_cache_t *htmlsize_cache; ///< memoized HTML table row/column sizes
+
 	gvplugin_active_textlayout_t textlayout; /* always use best avail for all jobs */
 //	void (*free_layout) (void *layout);   /* function for freeing layouts (mostly used by pango) */
 	
@@ -152,6 +158,12 @@ extern "C" {
 
 	/* whether to mangle font names (at least in SVG), usually false */
 	int fontrenaming;
+
+	/* instrumentation */
+	struct gvtrace_s *trace; ///< recorder, created when tracing is enabled
+	bool tracing; ///< whether work through this context is recorded
+	char *trace_file; ///< from --trace, written by gvFreeContext
+	gvtrace_format_t trace_format; ///< from --trace-format
     };
 
 GVCINT_API GVC_t* gvCloneGVC (GVC_t *);
@@ -276,8 +276,11 @@ extern "C" {
 	const char *output_filename;
 	FILE *output_file;
 	char *output_data;
-	unsigned int output_data_allocated;
-	unsigned int output_data_position;
+	size_t output_data_allocated;
+	size_t output_data_position;
+	/* if non-NULL, output is passed to this as it is produced */
+	size_t (*output_sink)(void *context, const char *s, size_t len);
+	void *output_sink_context;
 
 	const char *output_langname;
 	int output_lang;
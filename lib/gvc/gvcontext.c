@@ -22,6 +22,7 @@
 
 #include "builddate.h"
 #include <cgraph/alloc.h>
+#include <common/instrument.h>
 #include <common/render.h>
 #include <common/types.h>
 #include <gvc/gvplugin.h>
@@ -33,6 +34,9 @@
 /* from common/textspan.c */
 extern void textfont_dict_close(GVC_t *gvc);
 
+/* from common/htmltable.c */
+extern void htmlsize_cache_close(GVC_t *gvc);
+
 /* from common/globals.c */
 extern int graphviz_errors;
 
@@ -67,6 +71,16 @@ int gvFreeContext(GVC_t * gvc)
     gvplugin_package_t *package, *package_next;
     gvplugin_available_t *api, *api_next;
 
+    if (gvc->trace_file) {
+	FILE *out = fopen(gvc->trace_file, "w");
+	if (out == NULL || gvTraceWrite(gvc, out, gvc->trace_format) != 0)
+	    agerrorf("could not write trace to %s\n", gvc->trace_file);
+	if (out != NULL)
+	    fclose(out);
+	free(gvc->trace_file);
+    }
+    gvtrace_free(gvc->trace);
+
     emit_once_reset();
     gvg_next = gvc->gvgs;
     while ((gvg = gvg_next)) {
@@ -84,6 +98,7 @@ int gvFreeContext(GVC_t * gvc)
     free(gvc->config_path);
     free(gvc->input_filenames);
     textfont_dict_close(gvc);
+    htmlsize_cache_close(gvc);
     for (size_t i = 0; i < sizeof(gvc->apis) / sizeof(gvc->apis[0]); ++i) {
 	for (api = gvc->apis[i]; api != NULL; api = api_next) {
 	    api_next = api->next;
@@ -63,6 +63,7 @@ gvplugin_available_t *gvplugin_load(GVC_t *gvc, api_t api, const char *type,
     point gvusershape_size_dpi(usershape_t *us, pointf dpi);
     point gvusershape_size(graph_t *g, char *name);
     usershape_t *gvusershape_find(const char *name);
+    void gvusershape_cache(usershape_t *us);
 
 /* device */
     int gvdevice_initialize(GVJ_t * job);
@@ -126,3 +127,4 @@ gvplugin_available_t *gvplugin_load(GVC_t *gvc, api_t api, const char *type,
 /* layout */
 
     int gvlayout_select(GVC_t * gvc, const char *str);
+    int gvlayout_jobs(GVC_t * gvc, graph_t * g, unsigned short flags);
@@ -61,15 +61,27 @@ static const int PAGE_ALIGN = 4095;		/* align to a 4K boundary (less one), typic
 static size_t gvwrite_no_z(GVJ_t * job, const void *s, size_t len) {
     if (job->gvc->write_fn)   /* externally provided write discipline */
 	return job->gvc->write_fn(job, s, len);
+    if (job->output_sink)
+	return job->output_sink(job->output_sink_context, s, len);
     if (job->output_data) {
 	if (len > job->output_data_allocated - (job->output_data_position + 1)) {
-	    /* ensure enough allocation for string = null terminator */
-	    job->output_data_allocated = (job->output_data_position + len + 1 + PAGE_ALIGN) & ~PAGE_ALIGN;
-	    job->output_data = realloc(job->output_data, job->output_data_allocated);
+	    /* ensure enough allocation for string = null terminator, growing
+	     * geometrically so that large outputs are not copied repeatedly
+	     */
+	    size_t allocated = job->output_data_allocated;
+	    while (len > allocated - (job->output_data_position + 1)) {
+		if (allocated > SIZE_MAX / 2) {
+		    job->common->errorfn("memory allocation failure\n");
+		    graphviz_exit(1);
+		}
+		allocated *= 2;
+	    }
+	    job->output_data = realloc(job->output_data, allocated);
 	    if (!job->output_data) {
                 job->common->errorfn("memory allocation failure\n");
 		graphviz_exit(1);
 	    }
+	    job->output_data_allocated = allocated;
 	}
 	memcpy(job->output_data + job->output_data_position, s, len);
         job->output_data_position += len;
@@ -121,7 +133,7 @@ int gvdevice_initialize(GVJ_t * job)
     if (gvde && gvde->initialize) {
 	gvde->initialize(job);
     }
-    else if (job->output_data) {
+    else if (job->output_data || job->output_sink) {
     }
     /* if the device has no initialization then it uses file output */
     else if (!job->output_file) {        /* if not yet opened */
@@ -240,7 +252,7 @@ int gvferror (FILE* stream)
 {
     GVJ_t *job = (GVJ_t*)stream;
 
-    if (!job->gvc->write_fn && !job->output_data)
+    if (!job->gvc->write_fn && !job->output_data && !job->output_sink)
 	return ferror(job->output_file);
 
     return 0;
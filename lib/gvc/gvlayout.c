@@ -16,6 +16,7 @@
 #include "config.h"
 
 #include <common/const.h>
+#include <common/instrument.h>
 #include <gvc/gvplugin_layout.h>
 #include <gvc/gvcint.h>
 #include <cgraph/cgraph.h>
@@ -51,6 +52,14 @@ int gvlayout_select(GVC_t * gvc, const char *layout)
  * Return 0 on success.
  */
 int gvLayoutJobs(GVC_t * gvc, Agraph_t * g)
+{
+    return gvlayout_jobs(gvc, g, 0);
+}
+
+/* gvlayout_jobs:
+ * As gvLayoutJobs, with the given GD_flags set for the layout engine.
+ */
+int gvlayout_jobs(GVC_t * gvc, Agraph_t * g, unsigned short flags)
 {
     gvlayout_engine_t *gvle;
     char *p;
@@ -78,8 +87,11 @@ int gvLayoutJobs(GVC_t * gvc, Agraph_t * g)
 	return -1;
 
     gv_fixLocale (1);
+    gvtrace_t *const trace = gvtrace_activate(gvtrace_of(gvc));
+    gvtrace_begin("layout");
     graph_init(g, !!(gvc->layout.features->flags & LAYOUT_USES_RANKDIR));
     GD_drawing(agroot(g)) = GD_drawing(g);
+    GD_flags(g) |= flags;
     if (gvle && gvle->layout) {
 	gvle->layout(g);
 
@@ -87,6 +99,8 @@ int gvLayoutJobs(GVC_t * gvc, Agraph_t * g)
 	if (gvle->cleanup)
 	    GD_cleanup(g) = gvle->cleanup;
     }
+    gvtrace_end();
+    gvtrace_activate(trace);
     gv_fixLocale (0);
     return 0;
 }
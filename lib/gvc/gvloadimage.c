@@ -57,8 +57,10 @@ void gvloadimage(GVJ_t * job, usershape_t *us, boxf b, bool filled, const char *
     if (gvloadimage_select(job, type) == NO_SUPPORT)
 	    agwarningf("No loadimage plugin for \"%s\"\n", type);
 
-    if ((gvli = job->loadimage.engine) && gvli->loadimage)
+    if ((gvli = job->loadimage.engine) && gvli->loadimage) {
 	gvli->loadimage(job, us, b, filled);
+	gvusershape_cache(us);
+    }
 
     agxbfree(&type_buf);
 }
@@ -21,6 +21,7 @@
 #include <common/const.h>
 #include <common/macros.h>
 #include <common/colorprocs.h>
+#include <common/instrument.h>
 #include <gvc/gvplugin_render.h>
 #include <cgraph/agxbuf.h>
 #include <cgraph/alloc.h>
@@ -117,12 +118,16 @@ void gvrender_end_job(GVJ_t * job)
 {
     gvrender_engine_t *gvre = job->render.engine;
 
+    gvtrace_t *const trace = gvtrace_activate(gvtrace_of(job->gvc));
+    gvtrace_begin("write");
     if (gvre) {
 	if (gvre->end_job)
 	    gvre->end_job(job);
     }
     job->gvc->common.lib = NULL;	/* FIXME - minimally this doesn't belong here */
     gvdevice_finalize(job);
+    gvtrace_end();
+    gvtrace_activate(trace);
 }
 
 /* font modifiers */
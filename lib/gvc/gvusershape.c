@@ -44,6 +44,13 @@ extern shape_desc *find_user_shape(const char *);
 
 static Dict_t *ImageDict;
 
+/* usershapes holding data loaded by a renderer, most recently used first,
+ * shared like ImageDict by all contexts
+ */
+static usershape_t *ImageLRU, *ImageLRUtail;
+static size_t ImageLRUcost;
+static size_t ImageLRUlimit = (size_t)256 << 20;
+
 typedef struct {
     char *template;
     size_t size;
@@ -589,11 +596,80 @@ static void pdf_size (usershape_t *us)
     }
 }
 
+static void lru_unlink(usershape_t *us)
+{
+    if (us->lru_prev)
+	us->lru_prev->lru_next = us->lru_next;
+    else if (ImageLRU == us)
+	ImageLRU = us->lru_next;
+    else
+	return; /* not in the list */
+    if (us->lru_next)
+	us->lru_next->lru_prev = us->lru_prev;
+    else
+	ImageLRUtail = us->lru_prev;
+    us->lru_prev = us->lru_next = NULL;
+    ImageLRUcost -= us->datacost;
+    us->datacost = 0;
+}
+
+static void lru_push(usershape_t *us, size_t cost)
+{
+    us->lru_prev = NULL;
+    us->lru_next = ImageLRU;
+    if (ImageLRU)
+	ImageLRU->lru_prev = us;
+    else
+	ImageLRUtail = us;
+    ImageLRU = us;
+    us->datacost = cost;
+    ImageLRUcost += cost;
+}
+
+/* gvusershape_cache:
+ * Called after a loadimage plugin has rendered us. Mark the data it holds as
+ * the most recently used, then free the data of the least recently used
+ * usershapes until the total is within the limit. The plugins load the data
+ * again if it is needed.
+ */
+void gvusershape_cache(usershape_t *us)
+{
+    lru_unlink(us);
+    if (!us->data || !us->datafree)
+	return;
+
+    /* mapped files know their size; otherwise, assume a 32-bit raster */
+    size_t cost = us->datasize;
+    if (cost == 0 && us->w > 0 && us->h > 0)
+	cost = (size_t)us->w * (size_t)us->h * 4;
+    lru_push(us, cost);
+
+    while (ImageLRUcost > ImageLRUlimit && ImageLRUtail != us) {
+	usershape_t *old = ImageLRUtail;
+	lru_unlink(old);
+	old->datafree(old);
+	old->data = NULL;
+	old->datafree = NULL;
+	old->datasize = 0;
+    }
+}
+
+void gvSetImageCacheLimit(size_t bytes)
+{
+    ImageLRUlimit = bytes;
+}
+
+size_t gvImageCacheSize(void)
+{
+    return ImageLRUcost;
+}
+
 static void usershape_close(void *p, Dtdisc_t *disc) {
     (void)disc;
 
     usershape_t *us = p;
 
+    lru_unlink(us);
     if (us->f)
 	fclose(us->f);
     if (us->data && us->datafree)
@@ -675,7 +751,7 @@ static usershape_t *gvusershape_open (const char *name)
     assert(name);
 
     if (!ImageDict)
-        ImageDict = dtopen(&ImageDictDisc, Dttree);
+        ImageDict = dtopen(&ImageDictDisc, Dtfset);
 
     if (! (us = gvusershape_find(name))) {
         us = gv_alloc(sizeof(usershape_t));
@@ -765,6 +841,7 @@ point gvusershape_size(graph_t * g, char *name)
     point rv;
     pointf dpi;
     static char* oldpath;
+    const char *imagepath = Gvimagepath ? Gvimagepath : "";
     usershape_t* us;
 
     /* no shape file, no shape size */
@@ -773,8 +850,11 @@ point gvusershape_size(graph_t * g, char *name)
 	return rv;
     }
 
-    if (!HTTPServerEnVar && (oldpath != Gvimagepath)) {
-	oldpath = Gvimagepath;
+    /* Gvimagepath is owned by the current graph, so compare contents; graphs
+     * sharing an image path share the usershapes already opened */
+    if (!HTTPServerEnVar && (!oldpath || strcmp(oldpath, imagepath) != 0)) {
+	free(oldpath);
+	oldpath = gv_strdup(imagepath);
 	if (ImageDict) {
 	    dtclose(ImageDict);
 	    ImageDict = NULL;
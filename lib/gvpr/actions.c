@@ -501,7 +501,7 @@ int lockGraph(Agraph_t *g, int v) {
     data->lock |= 1;
   else if (v == 0 && oldv) {
     if (data->lock & 2)
-      agclose(g);
+      closeG(g);
     else
       data->lock = 0;
   }
@@ -528,7 +528,7 @@ int deleteObj(Agraph_t *g, Agobj_t *obj) {
       data->lock |= 2;
       return -1;
     } else
-      return agclose(g);
+      return closeG(g);
   }
 
   /* node or edge */
@@ -337,11 +337,11 @@ static Agobj_t *deref(Expr_t * pgm, Exnode_t * x, Exref_t * ref,
 
 }
 
-/* assignable:
- * Check that attribute is not a read-only, pseudo-attribute.
- * fatal if not OK.
+/* pseudoAttr:
+ * Return true if name is a read-only pseudo-attribute of objects of the
+ * given kind.
  */
-static void assignable (Agobj_t *objp, unsigned char* name) {
+static bool pseudoAttr(int kind, unsigned char *name) {
     unsigned int ch;
     int rv;
     unsigned char* p = name;
@@ -352,20 +352,34 @@ static void assignable (Agobj_t *objp, unsigned char* name) {
         p++;
     }
     rv = TFA_Definition();
-    if (rv < 0) return;
+    if (rv < 0) return false;
+
+    switch (kind) {
+    case AGRAPH :
+	return rv & Y(G);
+    case AGNODE :
+	return rv & Y(V);
+    default :  /* edge */
+	return rv & Y(E);
+    }
+}
+
+/* assignable:
+ * Check that attribute is not a read-only, pseudo-attribute.
+ * fatal if not OK.
+ */
+static void assignable (Agobj_t *objp, unsigned char* name) {
+    if (!pseudoAttr(AGTYPE(objp), name)) return;
 
     switch (AGTYPE(objp)) {
     case AGRAPH :
-	if (rv & Y(G))
-	    exerror("Cannot assign to pseudo-graph attribute %s", name);
+	exerror("Cannot assign to pseudo-graph attribute %s", name);
 	break;
     case AGNODE :
-	if (rv & Y(V))
-	    exerror("Cannot assign to pseudo-node attribute %s", name);
+	exerror("Cannot assign to pseudo-node attribute %s", name);
 	break;
     default :  /* edge */
-	if (rv & Y(E))
-	    exerror("Cannot assign to pseudo-edge attribute %s", name);
+	exerror("Cannot assign to pseudo-edge attribute %s", name);
 	break;
     }
 }
@@ -384,6 +398,75 @@ setattr (Agobj_t *objp, char* name, char* val)
     return agxset(objp, gsym, val);
 }
 
+/* Number of root graphs closed by closeG. Root graphs are never
+ * reopened at the same address within the same count, so this together
+ * with the root graph identifies a set of attribute symbols.
+ */
+static uint64_t graphCloses;
+
+/* An attribute symbol resolved by an attribute reference in the program,
+ * one per object kind.
+ */
+typedef struct {
+    Agraph_t *root;
+    uint64_t closes;
+    Agsym_t *sym;
+    bool assignable;   /* name already checked by assignable() */
+} attrcache_t;
+
+/* attrCache:
+ * Return the cached symbol slot for the attribute reference node applied
+ * to objects of the given kind. All objects of a kind in a root graph share
+ * the same attribute symbols, so the symbol only needs to be searched for
+ * once per graph. The cache is kept in the node's local field and lives in
+ * the program store; it is only created if alloc is true.
+ */
+static attrcache_t *attrCache(Expr_t *pgm, Exnode_t *node, int kind,
+                              bool alloc)
+{
+    attrcache_t *cache = node->local;
+    if (!cache) {
+	if (!alloc)
+	    return NULL;
+	cache = vmalloc(pgm->vm, 3 * sizeof(attrcache_t));
+	if (!cache)
+	    return NULL;
+	memset(cache, 0, 3 * sizeof(attrcache_t));
+	node->local = cache;
+    }
+    switch (kind) {
+    case AGRAPH :
+	return &cache[0];
+    case AGNODE :
+	return &cache[1];
+    default :  /* edge */
+	return &cache[2];
+    }
+}
+
+/* attrSym:
+ * Return the symbol for the attribute referenced by node in objp,
+ * or NULL if the attribute is not declared.
+ * While clauses are evaluated in parallel, the cache is only read;
+ * localClauses() has filled it.
+ */
+static Agsym_t *attrSym(Expr_t *pgm, Gpr_t *state, Exnode_t *node,
+                        Agobj_t *objp, char *name)
+{
+    attrcache_t *cache = attrCache(pgm, node, AGTYPE(objp), !state->effects);
+    Agraph_t *root = agroot(agraphof(objp));
+    if (cache && cache->sym && cache->root == root && cache->closes == graphCloses)
+	return cache->sym;
+
+    Agsym_t *gsym = agattrsym(objp, name);
+    if (cache && gsym && !state->effects) {
+	cache->root = root;
+	cache->closes = graphCloses;
+	cache->sym = gsym;
+    }
+    return gsym;
+}
+
 /* kindToStr:
  */
 static char*
@@ -418,7 +501,8 @@ kindOf (Agobj_t* objp)
  * Apply symbol to get field value of objp
  * Assume objp != NULL
  */
-static int lookup(Expr_t *pgm, Agobj_t *objp, Exid_t *sym, Extype_t * v) {
+static int lookup(Expr_t *pgm, Gpr_t *state, Exnode_t *node, Agobj_t *objp,
+                  Exid_t *sym, Extype_t *v) {
     if (sym->lex == ID) {
 	switch (sym->index) {
 	case M_head:
@@ -534,7 +618,19 @@ static int lookup(Expr_t *pgm, Agobj_t *objp, Exid_t *sym, Extype_t * v) {
 	    break;
 	}
     } else {
-	Agsym_t *gsym = agattrsym(objp, sym->name);
+	Agsym_t *gsym = attrSym(pgm, state, node, objp, sym->name);
+	if (gsym && state->effects) {
+	    /* see our own deferred assignments to objp */
+	    for (size_t i = gpr_effects_size(state->effects); i-- > 0; ) {
+		const gpr_effect_t *ef = gpr_effects_at(state->effects, i);
+		if (ef->obj != objp)
+		    break;
+		if (ef->sym == gsym) {
+		    v->string = ef->value;
+		    return 0;
+		}
+	    }
+	}
 	if (!gsym) {
 	    gsym = agattr(agroot(agraphof(objp)), AGTYPE(objp), sym->name, "");
 	    agxbuf tmp = {0};
@@ -1580,7 +1676,7 @@ getval(Expr_t * pgm, Exnode_t * node, Exid_t * sym, Exref_t * ref,
     }
 
     if (objp) {
-	if (lookup(pgm, objp, sym, &v)) {
+	if (lookup(pgm, state, node, objp, sym, &v)) {
 	    agxbuf xb = {0};
 	    exerror("in expression %s", deparse(pgm, node, &xb));
 	    agxbfree(&xb);
@@ -1676,7 +1772,22 @@ setval(Expr_t * pgm, Exnode_t * x, Exid_t * sym, Exref_t * ref,
 	}
     }
     
-    assignable (objp, (unsigned char*)sym->name);
+    if (state->effects) {
+	/* evaluated in parallel; localClauses() checked the attribute */
+	gpr_effect_t ef = {.obj = objp, .sym = attrSym(pgm, state, x, objp, sym->name),
+	                   .value = v.string ? exstring(pgm, v.string) : NULL};
+	gpr_effects_append(state->effects, ef);
+	return 0;
+    }
+    attrcache_t *cache = attrCache(pgm, x, AGTYPE(objp), true);
+    if (!cache || !cache->assignable) {
+	assignable (objp, (unsigned char*)sym->name);
+	if (cache)
+	    cache->assignable = true;
+    }
+    Agsym_t *gsym = attrSym(pgm, state, x, objp, sym->name);
+    if (gsym)
+	return agxset(objp, gsym, v.string);
     return setattr(objp, sym->name, v.string);
 }
 
@@ -2528,6 +2639,136 @@ int walksGraph(comp_block * p)
     return p->walks;
 }
 
+/* localAttr:
+ * Return true if x is $.name, where name is an attribute declared in g
+ * for objects of the given kind that can be assigned if assign is true.
+ * The attribute's symbol is recorded for x.
+ */
+static bool localAttr(Expr_t *pgm, Exnode_t *x, int kind, Agraph_t *g,
+                      bool assign)
+{
+    Agraph_t *root = agroot(g);
+    Agsym_t *asym;
+    attrcache_t *cache;
+    Exid_t *sym = x->data.variable.symbol;
+    Exref_t *ref = x->data.variable.reference;
+
+    if (x->data.variable.index || x->data.variable.dyna)
+	return false;
+    if (!ref || ref->next || ref->index || ref->symbol->lex != ID ||
+        ref->symbol->index != V_this)
+	return false;
+    if (sym->lex == ID)  /* pseudo-attribute such as name or degree */
+	return false;
+    if (assign && pseudoAttr(kind, (unsigned char *)sym->name))
+	return false;
+    if (!(asym = agattr(root, kind, sym->name, NULL)))
+	return false;
+
+    /* resolve the attribute now, as looking it up is not thread safe */
+    if (!(cache = attrCache(pgm, x, kind, true)))
+	return false;
+    cache->root = root;
+    cache->closes = graphCloses;
+    cache->sym = asym;
+    return true;
+}
+
+/* localExpr:
+ * Return true if evaluating x only reads and assigns attributes of $,
+ * and cannot fail. Such expressions can be evaluated for several objects
+ * at once.
+ */
+static bool localExpr(Expr_t *pgm, Exnode_t *x, int kind, Agraph_t *g)
+{
+    if (!x)
+	return true;
+
+    switch (x->type) {
+    case 0:
+    case VOIDTYPE:
+    case INTEGER:
+    case UNSIGNED:
+    case FLOATING:
+    case STRING:
+	break;
+    default:
+	return false;
+    }
+
+    switch (x->op) {
+    case CONSTANT:
+	return true;
+    case ID:
+	return localAttr(pgm, x, kind, g, false);
+    case '=':
+	return exisAssign(x) && x->data.operand.left->op == ID &&
+	       localAttr(pgm, x->data.operand.left, kind, g, true) &&
+	       localExpr(pgm, x->data.operand.right, kind, g);
+    case '/':
+    case '%': {
+	/* avoid division by 0, which is an error */
+	Exnode_t *r = x->data.operand.right;
+	if (r->op != CONSTANT)
+	    return false;
+	if (r->type == FLOATING ? r->data.constant.value.floating == 0
+	                        : r->data.constant.value.integer == 0)
+	    return false;
+	return localExpr(pgm, x->data.operand.left, kind, g);
+    }
+    case ';':
+    case ',':
+    case '?':
+    case ':':
+    case IF:
+    case AND:
+    case OR:
+    case EQ:
+    case NE:
+    case LE:
+    case GE:
+    case '<':
+    case '>':
+    case '+':
+    case '-':
+    case '*':
+    case '&':
+    case '|':
+    case '^':
+    case LSH:
+    case RSH:
+    case '!':
+    case '~':
+    case F2I:
+    case F2S:
+    case I2F:
+    case I2S:
+    case S2B:
+    case S2F:
+    case S2I:
+	return localExpr(pgm, x->data.operand.left, kind, g) &&
+	       localExpr(pgm, x->data.operand.right, kind, g);
+    default:
+	return false;
+    }
+}
+
+/* localClauses:
+ * Return true if the n clauses in stmts, applied to objects of the given
+ * kind in g, only read and assign attributes of $ and do no I/O. These
+ * can be evaluated in parallel, provided assignments are deferred.
+ */
+bool localClauses(Expr_t *pgm, case_stmt *stmts, size_t n, int kind,
+                  Agraph_t *g)
+{
+    for (size_t i = 0; i < n; i++) {
+	if (!localExpr(pgm, stmts[i].guard, kind, g) ||
+	    !localExpr(pgm, stmts[i].action, kind, g))
+	    return false;
+    }
+    return true;
+}
+
 /* usesGraph;
  * Returns true if program uses the graph, i.e., has
  * N/E/BEG_G/END_G statments
@@ -2572,6 +2813,15 @@ Agraph_t *openG(char *name, Agdesc_t desc)
     return g;
 }
 
+/* closeG:
+ * Close root graph.
+ */
+int closeG(Agraph_t *g)
+{
+    graphCloses++;
+    return agclose(g);
+}
+
 /* openSubg:
  * Open subgraph and initialize dynamic data.
  */
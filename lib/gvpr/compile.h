@@ -83,8 +83,11 @@ extern "C" {
     extern void freeCompileProg (comp_prog *p);
     extern int usesGraph(comp_prog *);
     extern int walksGraph(comp_block *);
+    extern bool localClauses(Expr_t *pgm, case_stmt *stmts, size_t n, int kind,
+                             Agraph_t *g);
     extern Agraph_t *readG(FILE *fp);
     extern Agraph_t *openG(char *name, Agdesc_t);
+    extern int closeG(Agraph_t *g);
     extern Agraph_t *openSubg(Agraph_t * g, char *name);
     extern Agnode_t *openNode(Agraph_t * g, char *name);
     extern Agedge_t *openEdge(Agraph_t* g, Agnode_t * t, Agnode_t * h, char *key);
@@ -17,6 +17,7 @@ extern "C" {
 #include <sfio/sfio.h>
 #include "cgraph.h"
 #include <ast/ast.h>
+#include <cgraph/list.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -30,6 +31,15 @@ extern "C" {
                    TV_prepostdfs, TV_prepostfwd, TV_prepostrev,
     } trav_type;
 
+    /* change to a graph, deferred while clauses are evaluated in parallel */
+    typedef struct {
+	Agobj_t *obj;
+	Agsym_t *sym;		/* attribute to set, or NULL to add obj to $T */
+	char *value;
+    } gpr_effect_t;
+
+    DEFINE_LIST(gpr_effects, gpr_effect_t)
+
     typedef struct {
 	Agraph_t *curgraph;
 	Agraph_t *nextgraph;
@@ -52,6 +62,7 @@ extern "C" {
 	int flags;
 	gvprbinding* bindings;
 	size_t n_bindings;
+	gpr_effects_t *effects;	/* if non-NULL, graph changes are deferred here */
     } Gpr_t;
 
     typedef struct {
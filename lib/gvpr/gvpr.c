@@ -40,6 +40,13 @@
 #include <setjmp.h>
 #include <getopt.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* smallest number of objects for which clauses are evaluated in parallel */
+#define PARALLEL_MIN 1024
+
 #ifndef DFLT_GVPRPATH
 #define DFLT_GVPRPATH    "."
 #endif
@@ -449,6 +456,8 @@ static Agobj_t* evalEdge(Gpr_t * state, Expr_t* prog, comp_block * xprog, Agedge
 	if (okay) {
 	    if (cs->action)
 		exeval(prog, cs->action, state);
+	    else if (state->effects)
+		gpr_effects_append(state->effects, (gpr_effect_t){.obj = OBJ(e)});
 	    else
 		agsubedge(state->target, e, 1);
 	}
@@ -471,6 +480,8 @@ static Agobj_t* evalNode(Gpr_t * state, Expr_t* prog, comp_block * xprog, Agnode
 	if (okay) {
 	    if (cs->action)
 		exeval(prog, cs->action, state);
+	    else if (state->effects)
+		gpr_effects_append(state->effects, (gpr_effect_t){.obj = OBJ(n)});
 	    else
 		agsubnode(state->target, n, 1);
 	}
@@ -656,11 +667,123 @@ static void travDFS(Gpr_t * state, Expr_t* prog, comp_block * xprog, trav_fns *
     stack_reset(&stk);
 }
 
+DEFINE_LIST(objs, Agobj_t *)
+
+/* useParallel:
+ * Return true if the node clauses (if nodes is true) and the edge clauses
+ * (if edges is true) of xprog are worth evaluating in parallel for the n
+ * objects of the current graph, and only read and set attributes of $.
+ */
+static bool useParallel(Gpr_t *state, Expr_t *prog, comp_block *xprog, int n,
+                        bool nodes, bool edges)
+{
+#ifdef _OPENMP
+    Agraph_t *g = state->curgraph;
+
+    if (n < PARALLEL_MIN || omp_get_max_threads() < 2)
+	return false;
+    if (nodes && !localClauses(prog, xprog->node_stmts, xprog->n_nstmts, AGNODE, g))
+	return false;
+    if (edges && !localClauses(prog, xprog->edge_stmts, xprog->n_estmts, AGEDGE, g))
+	return false;
+    return true;
+#else
+    (void)state;
+    (void)prog;
+    (void)xprog;
+    (void)n;
+    (void)nodes;
+    (void)edges;
+    return false;
+#endif
+}
+
+/* travParallel:
+ * Apply the node clauses of xprog to the nodes and the edge clauses to
+ * the edges in objects, after useParallel() has allowed it. Each thread
+ * evaluates a contiguous range of objects, deferring its changes to the
+ * graphs, which are then made in the order of the objects, as if they had
+ * been evaluated one by one.
+ * Return false, having done nothing, if the threads cannot be set up.
+ */
+static bool travParallel(Gpr_t *state, Expr_t *prog, comp_block *xprog,
+                         objs_t *objects)
+{
+#ifdef _OPENMP
+    const size_t n = objs_size(objects);
+    const int nthreads = omp_get_max_threads();
+
+    Gpr_t *states = gv_calloc((size_t)nthreads, sizeof(Gpr_t));
+    Expr_t **progs = gv_calloc((size_t)nthreads, sizeof(Expr_t *));
+    gpr_effects_t *effects = gv_calloc((size_t)nthreads, sizeof(gpr_effects_t));
+    int forked = 0;
+    for (; forked < nthreads; forked++) {
+	if (!(progs[forked] = exfork(prog)))
+	    break;
+	states[forked] = *state;
+	states[forked].effects = &effects[forked];
+    }
+
+    const bool ok = forked == nthreads;
+    if (ok) {
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+	for (int t = 0; t < nthreads; t++) {
+	    const size_t lo = n * (size_t)t / (size_t)nthreads;
+	    const size_t hi = n * (size_t)(t + 1) / (size_t)nthreads;
+	    for (size_t i = lo; i < hi; i++) {
+		Agobj_t *obj = objs_get(objects, i);
+		if (AGTYPE(obj) == AGNODE)
+		    evalNode(&states[t], progs[t], xprog, (Agnode_t *)obj);
+		else
+		    evalEdge(&states[t], progs[t], xprog, (Agedge_t *)obj);
+	    }
+	}
+
+	for (int t = 0; t < nthreads; t++) {
+	    for (size_t i = 0; i < gpr_effects_size(&effects[t]); i++) {
+		const gpr_effect_t ef = gpr_effects_get(&effects[t], i);
+		if (ef.sym)
+		    agxset(ef.obj, ef.sym, ef.value);
+		else if (AGTYPE(ef.obj) == AGNODE)
+		    agsubnode(state->target, (Agnode_t *)ef.obj, 1);
+		else
+		    agsubedge(state->target, (Agedge_t *)ef.obj, 1);
+	    }
+	}
+	state->curobj = objs_get(objects, n - 1);
+    }
+
+    for (int t = 0; t < forked; t++) {
+	gpr_effects_free(&effects[t]);
+	exjoin(progs[t]);
+    }
+    free(effects);
+    free(progs);
+    free(states);
+    return ok;
+#else
+    (void)state;
+    (void)prog;
+    (void)xprog;
+    (void)objects;
+    return false;
+#endif
+}
+
 static void travNodes(Gpr_t * state, Expr_t* prog, comp_block * xprog)
 {
     Agnode_t *n;
     Agnode_t *next;
     Agraph_t *g = state->curgraph;
+    if (xprog->n_nstmts > 0 && useParallel(state, prog, xprog, agnnodes(g), true, false)) {
+	objs_t objects = {0};
+	for (n = agfstnode(g); n; n = agnxtnode(g, n))
+	    objs_append(&objects, OBJ(n));
+	const bool done = travParallel(state, prog, xprog, &objects);
+	objs_free(&objects);
+	if (done)
+	    return;
+    }
     for (n = agfstnode(g); n; n = next) {
 	next =  agnxtnode(g, n);
 	evalNode(state, prog, xprog, n);
@@ -674,6 +797,16 @@ static void travEdges(Gpr_t * state, Expr_t* prog, comp_block * xprog)
     Agedge_t *e;
     Agedge_t *nexte;
     Agraph_t *g = state->curgraph;
+    if (xprog->n_estmts > 0 && useParallel(state, prog, xprog, agnedges(g), false, true)) {
+	objs_t objects = {0};
+	for (n = agfstnode(g); n; n = agnxtnode(g, n))
+	    for (e = agfstout(g, n); e; e = agnxtout(g, e))
+		objs_append(&objects, OBJ(e));
+	const bool done = travParallel(state, prog, xprog, &objects);
+	objs_free(&objects);
+	if (done)
+	    return;
+    }
     for (n = agfstnode(g); n; n = next) {
 	next = agnxtnode(g, n);
 	for (e = agfstout(g, n); e; e = nexte) {
@@ -690,6 +823,19 @@ static void travFlat(Gpr_t * state, Expr_t* prog, comp_block * xprog)
     Agedge_t *e;
     Agedge_t *nexte;
     Agraph_t *g = state->curgraph;
+    if (useParallel(state, prog, xprog, agnnodes(g), true, xprog->n_estmts > 0)) {
+	objs_t objects = {0};
+	for (n = agfstnode(g); n; n = agnxtnode(g, n)) {
+	    objs_append(&objects, OBJ(n));
+	    if (xprog->n_estmts > 0)
+		for (e = agfstout(g, n); e; e = agnxtout(g, e))
+		    objs_append(&objects, OBJ(e));
+	}
+	const bool done = travParallel(state, prog, xprog, &objects);
+	objs_free(&objects);
+	if (done)
+	    return;
+    }
     for (n = agfstnode(g); n; n = next) {
 	next =  agnxtnode(g, n);
 	if (!evalNode(state, prog, xprog, n)) continue;
@@ -847,7 +993,7 @@ static void chkClose(Agraph_t * g)
     if (data->lock & 1)
 	data->lock |= 2;
     else
-	agclose(g);
+	closeG(g);
 }
 
 static Agraph_t *ing_read(void *fp)
@@ -10,7 +10,10 @@
 
 #include <stdlib.h>
 
+#include <cgraph/alloc.h>
+#include <common/arith.h>
 #include <label/index.h>
+#include <math.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <assert.h>
@@ -57,6 +60,79 @@ RTree_t *RTreeOpen(void)
     return rtp;
 }
 
+/* comparators for bulk loading, by the center of the branch rectangle in
+ * one dimension and then the other
+ */
+static int branchcmp(const Branch_t *b0, const Branch_t *b1, size_t d) {
+    for (size_t i = 0; i < NUMDIMS; i++, d = (d + 1) % NUMDIMS) {
+	const long long c0 = (long long)b0->rect.boundary[d] +
+	                     b0->rect.boundary[NUMDIMS + d];
+	const long long c1 = (long long)b1->rect.boundary[d] +
+	                     b1->rect.boundary[NUMDIMS + d];
+	if (c0 != c1)
+	    return c0 < c1 ? -1 : 1;
+    }
+    return 0;
+}
+
+static int xcmpf(const void *x, const void *y) {
+    return branchcmp(x, y, 0);
+}
+
+static int ycmpf(const void *x, const void *y) {
+    return branchcmp(x, y, 1);
+}
+
+/* RTreeLoad:
+ * Make an index of the n given leaves in one go, by Sort-Tile-Recursive
+ * packing. The branches at each level are sorted into vertical slices by x,
+ * and each slice by y, and then packed into full nodes in that order. This
+ * is much faster than inserting the leaves one by one, and the nodes
+ * overlap less.
+ */
+RTree_t *RTreeLoad(Leaf_t *leaves, size_t n) {
+    RTree_t *rtp = gv_alloc(sizeof(RTree_t));
+
+    Branch_t *bs = gv_calloc(n, sizeof(Branch_t));
+    for (size_t i = 0; i < n; i++) {
+	bs[i].rect = leaves[i].rect;
+	bs[i].child = leaves[i].data;
+    }
+
+    for (int level = 0;; level++) {
+	if (n <= NODECARD) {
+	    rtp->root = RTreeNewNode();
+	    rtp->root->level = level;
+	    rtp->root->count = (int)n;
+	    for (size_t i = 0; i < n; i++)
+		rtp->root->branch[i] = bs[i];
+	    break;
+	}
+
+	const size_t nnodes = (n + NODECARD - 1) / NODECARD;
+	size_t nslices = (size_t)ceil(sqrt((double)nnodes));
+	const size_t slice = ((nnodes + nslices - 1) / nslices) * NODECARD;
+	qsort(bs, n, sizeof(Branch_t), xcmpf);
+	for (size_t i = 0; i < n; i += slice)
+	    qsort(&bs[i], MIN(slice, n - i), sizeof(Branch_t), ycmpf);
+
+	Branch_t *parents = gv_calloc(nnodes, sizeof(Branch_t));
+	for (size_t i = 0; i < nnodes; i++) {
+	    Node_t *node = RTreeNewNode();
+	    node->level = level;
+	    for (size_t j = i * NODECARD; j < n && j < (i + 1) * NODECARD; j++)
+		node->branch[node->count++] = bs[j];
+	    parents[i].rect = NodeCover(node);
+	    parents[i].child = node;
+	}
+	free(bs);
+	bs = parents;
+	n = nnodes;
+    }
+    free(bs);
+    return rtp;
+}
+
 /* Make a new index, empty.  Consists of a single node. */
 Node_t *RTreeNewIndex(void ) {
     Node_t *x = RTreeNewNode();
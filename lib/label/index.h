@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -72,6 +74,7 @@ typedef struct LeafList {
 };
 
 RTree_t *RTreeOpen(void);
+RTree_t *RTreeLoad(Leaf_t *leaves, size_t n);
 int RTreeClose(RTree_t * rtp);
 Node_t *RTreeNewIndex(void);
 LeafList_t *RTreeSearch(RTree_t *, Node_t *, Rect_t *);
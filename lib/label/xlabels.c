@@ -10,7 +10,6 @@
 
 #include <assert.h>
 #include <cgraph/alloc.h>
-#include <cgraph/exit.h>
 #include <errno.h>
 #include <limits.h>
 #include <math.h>
@@ -21,41 +20,10 @@
 #define XLABEL_INT
 #include <label/xlabels.h>
 
-static int icompare(Dt_t *, void *, void *, Dtdisc_t *);
-
-Dtdisc_t Hdisc = { offsetof(HDict_t, key), sizeof(int), -1, 0, 0,
-    icompare
-};
-
-static int icompare(Dt_t * dt, void * v1, void * v2, Dtdisc_t * disc)
-{
-    (void)dt;
-    (void)disc;
-    int k1 = *((int *) v1), k2 = *((int *) v2);
-    if (k1 < k2) {
-      return -1;
-    }
-    if (k1 > k2) {
-      return 1;
-    }
-    return 0;
-}
-
 static XLabels_t *xlnew(object_t *objs, size_t n_objs, xlabel_t *lbls,
                         size_t n_lbls, label_params_t *params) {
     XLabels_t *xlp = gv_alloc(sizeof(XLabels_t));
 
-    /* used to load the rtree in hilbert space filling curve order */
-    if (!(xlp->hdx = dtopen(&Hdisc, Dtobag))) {
-	fprintf(stderr, "out of memory\n");
-	graphviz_exit(EXIT_FAILURE);
-    }
-
-    /* for querying intersection candidates */
-    if (!(xlp->spdx = RTreeOpen())) {
-	fprintf(stderr, "out of memory\n");
-	graphviz_exit(EXIT_FAILURE);
-    }
     /* save arg pointers in the handle */
     xlp->objs = objs;
     xlp->n_objs = n_objs;
@@ -68,73 +36,15 @@ static XLabels_t *xlnew(object_t *objs, size_t n_objs, xlabel_t *lbls,
 
 static void xlfree(XLabels_t * xlp)
 {
+    for (size_t i = 0; i < xlp->n_objs; i++)
+	leaves_free(&xlp->nbrs[i]);
+    free(xlp->nbrs);
     RTreeClose(xlp->spdx);
     free(xlp);
 }
 
 /***************************************************************************/
 
-/*
- * determine the order(depth) of the hilbert sfc so that we satisfy the
- * precondition of hd_hil_s_from_xy()
- */
-static unsigned int xlhorder(XLabels_t * xlp)
-{
-    double maxx = xlp->params->bb.UR.x, maxy = xlp->params->bb.UR.y;
-    return (unsigned)floor(log2(round(fmax(maxx, maxy)))) + 1;
-}
-
-/* from http://www.hackersdelight.org/ site for the book by Henry S Warren */
-/*
- * precondition
- * pow(2, n) >= max(p.x, p.y)
- */
-/* adapted from lams1.c
-Given the "order" n of a Hilbert curve and coordinates x and y, this
-program computes the length s of the curve from the origin to (x, y).
-The square that the Hilbert curve traverses is of size 2**n by 2**n.
-   The method is that given in [Lam&Shap], described by the following
-table.  Here i = n-1 for the most significant bit of x and y, and i = 0
-for the least significant bits.
-
-		    x[i]  y[i] | s[2i+1:2i]   x   y
-		    -----------|-------------------
-		     0     0   |     00       y   x
-		     0     1   |     01       x   y
-		     1     0   |     11      ~y  ~x
-		     1     1   |     10       x   y
-
-To use this table, start at the most significant bits of x and y
-(i = n - 1).  If they are both 0 (first row), set the most significant
-two bits of s to 00 and interchange x and y.  (Actually, it is only
-necessary to interchange the remaining bits of x and y.)  If the most
-significant bits of x and y are 10 (third row), output 11, interchange x
-and y, and complement x and y.
-   Then, consider the next most significant bits of x and y (which may
-have been changed by this process), and select the appropriate row of
-the table to determine the next two bits of s, and how to change x and
-y.  Continue until the least significant bits of x and y have been
-processed. */
-
-static unsigned int hd_hil_s_from_xy(point p, int n)
-{
-    int x = p.x, y = p.y;
-
-    unsigned s = 0;			/* Initialize. */
-    for (int i = n - 1; i >= 0; i--) {
-	int xi = (x >> i) & 1;	/* Get bit i of x. */
-	int yi = (y >> i) & 1;	/* Get bit i of y. */
-	s = 4 * s + 2 * (unsigned)xi + ((unsigned)xi ^ (unsigned)yi); // Append two bits to s.
-
-	x = x ^ y;		/* These 3 lines swap */
-	y = y ^ (x & (yi - 1));	/* x and y if yi = 0. */
-	x = x ^ y;
-	x = x ^ (-xi & (yi - 1));	/* Complement x and y if */
-	y = y ^ (-xi & (yi - 1));	/* xi = 1 and yi = 0. */
-    }
-    return s;
-}
-
 /* intersection test from
  * from Real-Time Collision Detection 4.2.1 by Christer Ericson
  * intersection area from
@@ -320,11 +230,12 @@ recordlintrsx(object_t * op, object_t * cp, Rect_t * rp,
     return a;
 }
 
-/* find the objects and labels intersecting lp */
+/* find the objects and labels intersecting lp, among the neighbors of objp */
 static BestPos_t
 xlintersections(XLabels_t * xlp, object_t * objp, object_t * intrsx[XLNBR])
 {
     BestPos_t bp;
+    const leaves_t *nbrs = &xlp->nbrs[objp - xlp->objs];
 
     assert(objp->lbl);
 
@@ -332,27 +243,22 @@ xlintersections(XLabels_t * xlp, object_t * objp, object_t * intrsx[XLNBR])
     bp.area = 0.0;
     bp.pos = objp->lbl->pos;
 
-    for (size_t i = 0; i < xlp->n_objs; i++) {
-      if(objp == &xlp->objs[i]) continue;
-      if(xlp->objs[i].sz.x > 0 && xlp->objs[i].sz.y > 0) continue;
-      if(lblenclosing(objp, &xlp->objs[i]) ) {
-	bp.n++;
-      }
-    }
-
     Rect_t rect = objplp2rect(objp);
 
-    LeafList_t *llp = RTreeSearch(xlp->spdx, xlp->spdx->root, &rect);
-    if (!llp)
-	return bp;
-
-    for (LeafList_t *ilp = llp; ilp; ilp = ilp->next) {
+    for (size_t i = 0; i < leaves_size(nbrs); i++) {
 	double a, ra;
-	object_t *cp = ilp->leaf->data;
+	const Leaf_t *lp = leaves_get(nbrs, i);
+	object_t *cp = lp->data;
 
 	if (cp == objp)
 	    continue;
 
+	if (!(cp->sz.x > 0 && cp->sz.y > 0) && lblenclosing(objp, cp))
+	    bp.n++;
+
+	if (!Overlap(&rect, &lp->rect))
+	    continue;
+
 	/*label-object intersect */
 	Rect_t srect = objp2rect(cp);
 	a = aabbaabb(&rect, &srect);
@@ -372,7 +278,6 @@ xlintersections(XLabels_t * xlp, object_t * objp, object_t * intrsx[XLNBR])
 	  bp.area += ra;
 	}
     }
-    RTreeLeafListFree(llp);
     return bp;
 }
 
@@ -519,64 +424,52 @@ static BestPos_t xladjust(XLabels_t * xlp, object_t * objp)
     return bp;
 }
 
-/* load the hilbert sfc keyed tree */
-static int xlhdxload(XLabels_t * xlp)
-{
-    int order = xlhorder(xlp);
-
+/* load the rtree with the area each object and its label may occupy */
+static void xlspdxload(XLabels_t *xlp) {
+    Leaf_t *leaves = gv_calloc(xlp->n_objs, sizeof(Leaf_t));
     for (size_t i = 0; i < xlp->n_objs; i++) {
-	HDict_t *hp;
-	point pi;
-
-	hp = gv_alloc(sizeof(HDict_t));
-
-	hp->d.data = &xlp->objs[i];
-	hp->d.rect = objplpmks(&xlp->objs[i]);
-	/* center of the labeling area */
-	pi.x = hp->d.rect.boundary[0] +
-	    (hp->d.rect.boundary[2] - hp->d.rect.boundary[0]) / 2;
-	pi.y = hp->d.rect.boundary[1] +
-	    (hp->d.rect.boundary[3] - hp->d.rect.boundary[1]) / 2;
-
-	hp->key = hd_hil_s_from_xy(pi, order);
-
-	if (!dtinsert(xlp->hdx, hp))
-	    return -1;
+	leaves[i].rect = objplpmks(&xlp->objs[i]);
+	leaves[i].data = &xlp->objs[i];
     }
-    return 0;
+    xlp->spdx = RTreeLoad(leaves, xlp->n_objs);
+    free(leaves);
 }
 
-static void xlhdxunload(XLabels_t * xlp)
-{
-  int size=dtsize(xlp->hdx), freed=0;
-  while(dtsize(xlp->hdx) ) {
-    void*vp=dtfinger(xlp->hdx);
-    assert(vp);
-    if(vp) {
-      dtdetach(xlp->hdx, vp);
-      free(vp);
-      freed++;
-    }
-  }
-  assert(size==freed);
-  (void)size;
+/* order leaves by the index of their object */
+static int leafcmpf(const Leaf_t **x, const Leaf_t **y) {
+    const object_t *a = (*x)->data;
+    const object_t *b = (*y)->data;
+    return a < b ? -1 : a > b;
 }
 
-static void xlspdxload(XLabels_t *xlp) {
-    for (HDict_t *op = dtfirst(xlp->hdx); op; op = dtnext(xlp->hdx, op)) {
-	/*          tree       rectangle    data        node             lvl */
-	RTreeInsert(xlp->spdx, &op->d.rect, op->d.data, &xlp->spdx->root, 0);
+/* Find the neighbors of each labelled object: those whose area overlaps the
+ * area in which its label may be placed. All the candidate positions tried
+ * by xladjust lie in it, so it only has to look through these. They are kept
+ * in the order of the objects, so the placement does not depend on the shape
+ * of the rtree. The searches are independent, so they are run concurrently.
+ */
+static void xlnbrsload(XLabels_t *xlp) {
+    xlp->nbrs = gv_calloc(xlp->n_objs, sizeof(leaves_t));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (long i = 0; i < (long)xlp->n_objs; i++) {
+	object_t *objp = &xlp->objs[i];
+	if (!objp->lbl)
+	    continue;
+	Rect_t rect = objplpmks(objp);
+	LeafList_t *llp = RTreeSearch(xlp->spdx, xlp->spdx->root, &rect);
+	for (LeafList_t *ilp = llp; ilp; ilp = ilp->next)
+	    leaves_append(&xlp->nbrs[i], ilp->leaf);
+	if (llp)
+	    RTreeLeafListFree(llp);
+	leaves_sort(&xlp->nbrs[i], leafcmpf);
     }
 }
 
-static int xlinitialize(XLabels_t * xlp)
-{
-    int r=0;
-    if ((r = xlhdxload(xlp)) < 0)
-	return r;
+static void xlinitialize(XLabels_t *xlp) {
     xlspdxload(xlp);
-    xlhdxunload(xlp);
-    return dtclose(xlp->hdx);
+    xlnbrsload(xlp);
 }
 
 int placeLabels(object_t *objs, size_t n_objs, xlabel_t *lbls, size_t n_lbls,
@@ -584,8 +477,7 @@ int placeLabels(object_t *objs, size_t n_objs, xlabel_t *lbls, size_t n_lbls,
     int r;
     BestPos_t bp;
     XLabels_t *xlp = xlnew(objs, n_objs, lbls, n_lbls, params);
-    if ((r = xlinitialize(xlp)) < 0)
-	return r;
+    xlinitialize(xlp);
 
     /* Place xlabel_t* lp near lp->obj so that the rectangle whose lower-left
      * corner is lp->pos, and size is lp->sz does not intersect any object
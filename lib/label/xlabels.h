@@ -40,8 +40,8 @@ int placeLabels(object_t *objs, size_t n_objs, xlabel_t *lbls, size_t n_lbls,
                 label_params_t *params);
 
 #ifdef XLABEL_INT
+#include <cgraph/list.h>
 #include <label/index.h>
-#include <cdt.h>
 
 #ifndef XLNDSCALE
 #define XLNDSCALE 72.0
@@ -79,11 +79,7 @@ int placeLabels(object_t *objs, size_t n_objs, xlabel_t *lbls, size_t n_lbls,
     pointf pos;
 } BestPos_t;
 
-typedef struct obyh {
-    Dtlink_t link;
-    int key;
-    Leaf_t d;
-} HDict_t;
+DEFINE_LIST(leaves, Leaf_t *)
 
 typedef struct XLabels_s {
     object_t *objs;
@@ -92,8 +88,8 @@ typedef struct XLabels_s {
     size_t n_lbls;
     label_params_t *params;
 
-    Dt_t *hdx;			// splay tree keyed with hilbert spatial codes
     RTree_t *spdx;		// rtree
+    leaves_t *nbrs;		// neighbors of each labelled object, in spdx
 
 } XLabels_t;
 
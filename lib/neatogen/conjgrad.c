@@ -9,6 +9,7 @@
  *************************************************************************/
 
 #include <cgraph/alloc.h>
+#include <common/instrument.h>
 #include <neatogen/matrix_ops.h>
 #include <neatogen/conjgrad.h>
 #include <stdbool.h>
@@ -73,6 +74,7 @@ int conjugate_gradient
     }
 
 cleanup0 :
+    gvtrace_count("conjugate gradient iterations", (unsigned long long)i);
     free(r);
     free(p);
     free(Ap);
@@ -147,6 +149,7 @@ int conjugate_gradient_f
 	}
     }
 cleanup1:
+    gvtrace_count("conjugate gradient iterations", (unsigned long long)i);
     free(r);
     free(p);
     free(Ap);
@@ -226,6 +229,7 @@ conjugate_gradient_mkernel(float *A, float *x, float *b, int n,
     }
 
 cleanup2 :
+    gvtrace_count("conjugate gradient iterations", (unsigned long long)i);
     free(r);
     free(p);
     free(Ap);
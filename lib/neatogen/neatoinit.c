@@ -29,6 +29,7 @@
 #include <neatogen/digcola.h>
 #endif
 #include <neatogen/kkutils.h>
+#include <common/instrument.h>
 #include <common/pointset.h>
 #include <neatogen/sgd.h>
 #include <cgraph/alloc.h>
@@ -1336,12 +1337,14 @@ neatoLayout(Agraph_t * mg, Agraph_t * g, int layoutMode, int layoutModel,
     nG = scan_graph_mode(g, layoutMode);
     if (nG < 2 || MaxIter < 0)
 	return;
+    gvtrace_begin("position");
     if (layoutMode == MODE_KK)
 	kkNeato(g, nG, layoutModel);
     else if (layoutMode == MODE_SGD)
 	sgd(g, layoutModel);
     else
 	majorization(mg, g, nG, layoutMode, layoutModel, Ndim, am);
+    gvtrace_end();
 }
 
 /* addZ;
@@ -1411,7 +1414,9 @@ void neato_layout(Agraph_t * g)
     } else {
 	bool noTranslate = mapbool(agget(g, "notranslate"));
 	PSinputscale = get_inputscale (g);
+	gvtrace_begin("init");
 	neato_init_graph(g);
+	gvtrace_end();
 	layoutMode = neatoMode(g);
 	graphAdjustMode (g, &am, 0);
 	model = neatoModel(g);
@@ -12,6 +12,7 @@
 #include "config.h"
 #include <cgraph/alloc.h>
 #include <cgraph/unreachable.h>
+#include <common/instrument.h>
 #include <limits.h>
 #include <math.h>
 #include <neatogen/neato.h>
@@ -788,7 +789,10 @@ splineEdges(graph_t * g, int (*edgefn) (graph_t *, expand_t*, int),
  */
 int spline_edges1(graph_t * g, int edgetype)
 {
-    return splineEdges(g, _spline_edges, edgetype);
+    gvtrace_begin("splines");
+    const int rc = splineEdges(g, _spline_edges, edgetype);
+    gvtrace_end();
+    return rc;
 }
 
 /* spline_edges0:
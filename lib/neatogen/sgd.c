@@ -39,49 +39,51 @@ static void fisheryates_shuffle(term_sgd *terms, int n_terms) {
 
 // graph_sgd data structure exists only to make dijkstras faster
 static graph_sgd * extract_adjacency(graph_t *G, int model) {
-    node_t *np;
-    edge_t *ep;
-    size_t n_nodes = 0, n_edges = 0;
-    for (np = agfstnode(G); np; np = agnxtnode(G,np)) {
-        assert(ND_id(np) == n_nodes);
-        n_nodes++;
-        for (ep = agfstedge(G, np); ep; ep = agnxtedge(G, ep, np)) {
-            if (agtail(ep) != aghead(ep)) { // ignore self-loops and double edges
-                n_edges++;
-            }
+    Agcsr_t *csr = agcsr(G);
+    size_t n_edges = 0;
+    for (size_t i = 0; i < csr->nedges; i++) {
+        if (aghead(csr->out_edges[i]) != agtail(csr->out_edges[i])) { // ignore self-loops
+            n_edges += 2; // once from each end
         }
     }
     graph_sgd *graph = gv_alloc(sizeof(graph_sgd));
-    graph->sources = gv_calloc(n_nodes + 1, sizeof(size_t));
-    graph->pinneds = bitarray_new(n_nodes);
+    graph->sources = gv_calloc(csr->nnodes + 1, sizeof(size_t));
+    graph->pinneds = bitarray_new(csr->nnodes);
     graph->targets = gv_calloc(n_edges, sizeof(size_t));
     graph->weights = gv_calloc(n_edges, sizeof(float));
 
-    graph->n = n_nodes;
+    graph->n = csr->nnodes;
     assert(n_edges <= INT_MAX);
-    graph->sources[graph->n] = n_edges; // to make looping nice
 
-    n_nodes = 0, n_edges = 0;
-    for (np = agfstnode(G); np; np = agnxtnode(G,np)) {
-        assert(n_edges <= INT_MAX);
-        graph->sources[n_nodes] = n_edges;
-        bitarray_set(&graph->pinneds, n_nodes, isFixed(np));
-        for (ep = agfstedge(G, np); ep; ep = agnxtedge(G, ep, np)) {
-            if (agtail(ep) == aghead(ep)) { // ignore self-loops and double edges
+    // neighbours of each node, from its out-edges then its in-edges, as
+    // agfstedge/agnxtedge would visit them
+    n_edges = 0;
+    for (size_t i = 0; i < csr->nnodes; i++) {
+        node_t *np = csr->nodes[i];
+        assert(ND_id(np) == (int)i);
+        graph->sources[i] = n_edges;
+        bitarray_set(&graph->pinneds, i, isFixed(np));
+        for (size_t x = csr->out_offset[i]; x < csr->out_offset[i + 1]; x++) {
+            if (csr->out_head[x] == i) { // ignore self-loops
                 continue;
             }
-            node_t *target = (agtail(ep) == np) ? aghead(ep) : agtail(ep); // in case edge is reversed
-            graph->targets[n_edges] = (size_t)ND_id(target);
-            graph->weights[n_edges] = ED_dist(ep);
+            graph->targets[n_edges] = csr->out_head[x];
+            graph->weights[n_edges] = ED_dist(csr->out_edges[x]);
+            assert(graph->weights[n_edges] > 0);
+            n_edges++;
+        }
+        for (size_t x = csr->in_offset[i]; x < csr->in_offset[i + 1]; x++) {
+            if (csr->in_tail[x] == i) { // ignore self-loops
+                continue;
+            }
+            graph->targets[n_edges] = csr->in_tail[x];
+            graph->weights[n_edges] = ED_dist(csr->in_edges[x]);
             assert(graph->weights[n_edges] > 0);
             n_edges++;
         }
-        n_nodes++;
     }
-    assert(n_nodes == graph->n);
-    assert(n_edges <= INT_MAX);
-    assert(n_edges == graph->sources[graph->n]);
-    graph->sources[n_nodes] = n_edges;
+    graph->sources[graph->n] = n_edges; // to make looping nice
+    agcsrfree(csr);
 
     if (model == MODEL_SHORTPATH) {
         // do nothing
@@ -12,146 +12,142 @@
 
 #include "config.h"
 #include <cgraph/alloc.h>
+#include <cgraph/cgraph.h>
 #include <assert.h>
+#include <stdio.h>
 
 #include <ortho/fPQ.h>
 
-static snode**  pq;
-static int     PQcnt;
-static snode    guard;
-static int     PQsize;
-
 void
-PQgen(int sz)
+PQgen(PQ *pq, int sz, double *vals, int *idxs)
 {
-  if (!pq) {
-    pq = gv_calloc(sz + 1, sizeof(snode*));
-    pq[0] = &guard;
-    PQsize = sz;
-  }
-  PQcnt = 0;
+  pq->pq = gv_calloc(sz + 1, sizeof(int));
+  pq->PQsize = sz;
+  pq->PQcnt = 0;
+  pq->vals = vals;
+  pq->idxs = idxs;
 }
 
 void
-PQfree(void)
+PQfree(PQ *pq)
 {
-  free (pq);
-  pq = NULL;
-  PQcnt = 0;
+  free (pq->pq);
+  pq->pq = NULL;
+  pq->PQcnt = 0;
 }
 
 void
-PQinit(void)
+PQinit(PQ *pq)
 {
-  PQcnt = 0;
+  pq->PQcnt = 0;
 }
 
 void
-PQcheck (void)
+PQcheck (PQ *pq)
 {
   int i;
  
-  for (i = 1; i <= PQcnt; i++) {
-    if (N_IDX(pq[i]) != i) {
+  for (i = 1; i <= pq->PQcnt; i++) {
+    if (pq->idxs[pq->pq[i]] != i) {
       assert (0);
     }
   }
 }
 
 void
-PQupheap(int k)
+PQupheap(PQ *pq, int k)
 {
-  snode* x = pq[k];
-  int     v = x->n_val;
+  int     x = pq->pq[k];
+  double  v = pq->vals[x];
   int     next = k/2;
-  snode*  n;
+  int     n;
   
-  while (N_VAL(n = pq[next]) < v) {
-    pq[k] = n;
-    N_IDX(n) = k;
+  while (next > 0 && pq->vals[n = pq->pq[next]] < v) {
+    pq->pq[k] = n;
+    pq->idxs[n] = k;
     k = next;
     next /= 2;
   }
-  pq[k] = x;
-  N_IDX(x) = k;
+  pq->pq[k] = x;
+  pq->idxs[x] = k;
 }
 
 int
-PQ_insert(snode* np)
+PQ_insert(PQ *pq, int np)
 {
-  if (PQcnt == PQsize) {
+  if (pq->PQcnt == pq->PQsize) {
     agerrorf("Heap overflow\n");
     return 1;
   }
-  PQcnt++;
-  pq[PQcnt] = np;
-  PQupheap (PQcnt);
-  PQcheck();
+  pq->PQcnt++;
+  pq->pq[pq->PQcnt] = np;
+  PQupheap (pq, pq->PQcnt);
+  PQcheck(pq);
   return 0;
 }
 
 void
-PQdownheap (int k)
+PQdownheap (PQ *pq, int k)
 {
-  snode*    x = pq[k];
-  int      v = N_VAL(x);
-  int      lim = PQcnt/2;
-  snode*    n;
+  int      x = pq->pq[k];
+  double   v = pq->vals[x];
+  int      lim = pq->PQcnt/2;
+  int      n;
   int      j;
 
   while (k <= lim) {
     j = k+k;
-    n = pq[j];
-    if (j < PQcnt) {
-      if (N_VAL(n) < N_VAL(pq[j+1])) {
+    n = pq->pq[j];
+    if (j < pq->PQcnt) {
+      if (pq->vals[n] < pq->vals[pq->pq[j+1]]) {
         j++;
-        n = pq[j];
+        n = pq->pq[j];
       }
     }
-    if (v >= N_VAL(n)) break;
-    pq[k] = n;
-    N_IDX(n) = k;
+    if (v >= pq->vals[n]) break;
+    pq->pq[k] = n;
+    pq->idxs[n] = k;
     k = j;
   }
-  pq[k] = x;
-  N_IDX(x) = k;
+  pq->pq[k] = x;
+  pq->idxs[x] = k;
 }
 
-snode*
-PQremove (void)
+int
+PQremove (PQ *pq)
 {
-  snode* n;
-
-  if (PQcnt) {
-    n = pq[1];
-    pq[1] = pq[PQcnt];
-    PQcnt--;
-    if (PQcnt) PQdownheap (1);
-    PQcheck();
+  int n;
+
+  if (pq->PQcnt) {
+    n = pq->pq[1];
+    pq->pq[1] = pq->pq[pq->PQcnt];
+    pq->PQcnt--;
+    if (pq->PQcnt) PQdownheap (pq, 1);
+    PQcheck(pq);
     return n;
   }
-  else return 0;
+  else return -1;
 }
 
 void
-PQupdate (snode* n, int d)
+PQupdate (PQ *pq, int n, double d)
 {
-  N_VAL(n) = d;
-  PQupheap (n->n_idx);
-  PQcheck();
+  pq->vals[n] = d;
+  PQupheap (pq, pq->idxs[n]);
+  PQcheck(pq);
 }
 
 void
-PQprint (void)
+PQprint (PQ *pq)
 {
   int    i;
-  snode*  n;
+  int    n;
 
   fprintf (stderr, "Q: ");
-  for (i = 1; i <= PQcnt; i++) {
-    n = pq[i];
-    fprintf (stderr, "%d(%d:%d) ",  
-      n->index, N_IDX(n), N_VAL(n));
+  for (i = 1; i <= pq->PQcnt; i++) {
+    n = pq->pq[i];
+    fprintf (stderr, "%d(%d:%f) ",  
+      n, pq->idxs[n], pq->vals[n]);
   }
   fprintf (stderr, "\n");
 }
@@ -16,21 +16,31 @@
 #pragma once
 
 #include <cgraph/alloc.h>
-#include <ortho/sgraph.h>
 
-#define N_VAL(n) (n)->n_val
-#define N_IDX(n) (n)->n_idx
 #define N_DAD(n) (n)->n_dad
 #define N_EDGE(n) (n)->n_edge
 #define E_WT(e) (e->weight)
 
-void PQgen(int sz);
-void PQfree(void);
-void PQinit(void);
-void PQcheck (void);
-void PQupheap(int);
-int PQ_insert(snode* np);
-void PQdownheap (int k);
-snode* PQremove (void);
-void PQupdate (snode* n, int d);
-void PQprint (void);
+/// @brief max-heap of search graph node indices
+///
+/// Each search owns one, so that searches over a shared @ref sgraph do not
+/// interfere. Node values and heap positions live in arrays owned by the
+/// search and indexed by @ref snode::index.
+typedef struct {
+  int *pq;     ///< heap of node indices, from 1
+  int PQcnt;   ///< number of nodes in the heap
+  int PQsize;  ///< capacity of the heap
+  double *vals; ///< value of each node
+  int *idxs;    ///< position of each node in @ref pq
+} PQ;
+
+void PQgen(PQ *pq, int sz, double *vals, int *idxs);
+void PQfree(PQ *pq);
+void PQinit(PQ *pq);
+void PQcheck(PQ *pq);
+void PQupheap(PQ *pq, int k);
+int PQ_insert(PQ *pq, int n);
+void PQdownheap(PQ *pq, int k);
+int PQremove(PQ *pq);
+void PQupdate(PQ *pq, int n, double d);
+void PQprint(PQ *pq);
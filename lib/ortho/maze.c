@@ -334,7 +334,7 @@ chkSgraph (sgraph* g)
 static sgraph*
 mkMazeGraph (maze* mp, boxf bb)
 {
-    int nsides, i, maxdeg;
+    int nsides, i;
     int bound = 4*mp->ncells;
     sgraph* g = createSGraph (bound + 2);
     Dt_t* vdict = dtopen(&vdictDisc,Dtoset);
@@ -383,7 +383,6 @@ mkMazeGraph (maze* mp, boxf bb)
     /* For each gcell, corresponding to a node in the input graph,
      * connect it to its corresponding search nodes.
      */
-    maxdeg = 0;
     sides = gv_calloc(g->nnodes, sizeof(snode*));
     nsides = 0;
     for (i = 0; i < mp->ngcells; i++) {
@@ -417,7 +416,6 @@ mkMazeGraph (maze* mp, boxf bb)
 	    np->np->cells[0] = cp;
 	}
 	nsides += cp->nsides;
-        if (cp->nsides > maxdeg) maxdeg = cp->nsides;
     }
 
     /* Mark cells that are small because of a small node, not because of the close
@@ -434,23 +432,40 @@ mkMazeGraph (maze* mp, boxf bb)
     
     /* create edges
      * For each ordinary cell, there can be at most 6 edges.
-     * At most 2 gcells will be used at a time, and each of these
-     * can have at most degree maxdeg.
+     * Edges from the end points of a route to the sides of its gcells
+     * are added by each search.
      */
-    initSEdges (g, maxdeg);
+    initSEdges (g);
     for (i = 0; i < mp->ncells; i++) {
 	cell* cp = mp->cells+i;
 	createSEdges (cp, g);
     }
 
+    /* Record the midpoint of each node, as the midpoint of its side of an
+     * ordinary cell. Neighbouring ordinary cells share whole sides, so this
+     * does not depend on the cell chosen.
+     */
+    g->pos = gv_calloc(g->nnodes, sizeof(pointf));
+    for (i = 0; i < g->nnodes; i++) {
+	snode* np = g->nodes+i;
+	cell* cp = IsNode(np->cells[0]) ? np->cells[1] : np->cells[0];
+	boxf cb = cp->bb;
+	if (np->isVert) {
+	    g->pos[i].x = cp == np->cells[0] ? cb.UR.x : cb.LL.x;
+	    g->pos[i].y = (cb.LL.y + cb.UR.y) / 2;
+	}
+	else {
+	    g->pos[i].x = (cb.LL.x + cb.UR.x) / 2;
+	    g->pos[i].y = cp == np->cells[0] ? cb.UR.y : cb.LL.y;
+	}
+    }
+
     /* tidy up memory */
     dtclose (vdict);
     dtclose (hdict);
     free (ditems);
 
 chkSgraph (g);
-    /* save core graph state */
-    gsave(g);
     return g;
 }
 
@@ -35,8 +35,12 @@
 #include <cgraph/unused.h>
 #include <common/geomprocs.h>
 #include <common/globals.h>
+#include <common/instrument.h>
 #include <common/render.h>
 #include <common/pointset.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 typedef struct {
     int d;
     Agedge_t* e;
@@ -449,11 +453,11 @@ assignSegs (size_t nrtes, route* route_list, maze* mp)
 }
 
 /* addLoop:
- * Add two temporary nodes to sgraph corresponding to two ends of a loop at cell cp, i
+ * Add two temporary nodes to search ss corresponding to two ends of a loop at cell cp, i
  * represented by dp and sp.
  */
 static void
-addLoop (sgraph* sg, cell* cp, snode* dp, snode* sp)
+addLoop (ssearch* ss, cell* cp, snode* dp, snode* sp)
 {
     int i;
     int onTop;
@@ -469,30 +473,105 @@ addLoop (sgraph* sg, cell* cp, snode* dp, snode* sp)
 	    onTop = 0;
 	}
 	if (onTop)
-	    createSEdge (sg, sp, onp, 0);  /* FIX weight */
+	    addSearchEdge (ss, sp, onp);  /* FIX weight */
 	else
-	    createSEdge (sg, dp, onp, 0);  /* FIX weight */
+	    addSearchEdge (ss, dp, onp);  /* FIX weight */
     }
-    sg->nnodes += 2;
 }
 
 /* addNodeEdges:
- * Add temporary node to sgraph corresponding to cell cp, represented
+ * Add temporary node to search ss corresponding to cell cp, represented
  * by np.
  */
 static void
-addNodeEdges (sgraph* sg, cell* cp, snode* np)
+addNodeEdges (ssearch* ss, cell* cp, snode* np)
 {
     int i;
 
     for (i = 0; i < cp->nsides; i++) {
 	snode* onp = cp->sides[i];
 
-	createSEdge (sg, np, onp, 0);  /* FIX weight */
+	addSearchEdge (ss, np, onp);  /* FIX weight */
     }
-    sg->nnodes++;
-#ifdef DEBUG
-    np->cells[0] = np->cells[1] = cp;
+}
+
+/// a path found by a search, from the start of a route back to its end
+typedef struct {
+    int* nodes;     ///< indices of the nodes on the path
+    sedge** edges;  ///< edge from each node to the next, or NULL at the ends
+    double cost;    ///< total weight of the edges on the path
+    int n, size;
+} spath_t;
+
+/* findPath:
+ * Search for the cheapest path for edge e between the end point nodes sn and
+ * dn, using the working state ss, and store it in sp. This only reads the
+ * search graph, so several edges can be routed at once with different
+ * states. If astar is true, the search is directed towards the tail cell.
+ */
+static int
+findPath (ssearch* ss, Agedge_t* e, snode* sn, snode* dn, spath_t* sp,
+          bool astar)
+{
+    sgraph* sg = ss->g;
+    cell* start = CELL(agtail(e));
+    cell* dest = CELL(aghead(e));
+    int rc;
+
+    if (start == dest)
+	addLoop (ss, start, dn, sn);
+    else {
+	addNodeEdges (ss, dest, dn);
+	addNodeEdges (ss, start, sn);
+    }
+    ss->goal = astar ? &start->bb : NULL;
+    rc = shortPath (ss, dn, sn);
+    if (rc == 0) {
+	sp->cost = ss->vals[sn->index];
+	sp->n = 0;
+	for (int v = sn->index; v >= 0; v = ss->dads[v])
+	    sp->n++;
+	if (sp->n > sp->size) {
+	    sp->nodes = gv_recalloc(sp->nodes, sp->size, sp->n, sizeof(int));
+	    sp->edges = gv_recalloc(sp->edges, sp->size, sp->n, sizeof(sedge*));
+	    sp->size = sp->n;
+	}
+	int i = 0;
+	for (int v = sn->index; v >= 0; v = ss->dads[v], i++) {
+	    int u = ss->dads[v];
+	    sp->nodes[i] = v;
+	    if (u >= 0 && u < sg->nnodes && v < sg->nnodes)
+		sp->edges[i] = ss->dadedge[v];
+	    else
+		sp->edges[i] = NULL;
+	}
+    }
+    clearSearch (ss);
+    return rc;
+}
+
+/* setPath:
+ * Record the path sp in the N_DAD and N_EDGE fields of its nodes, as read by
+ * convertSPtoRoute.
+ */
+static void
+setPath (sgraph* sg, spath_t* sp)
+{
+    for (int i = 0; i < sp->n; i++) {
+	snode* np = &sg->nodes[sp->nodes[i]];
+	N_DAD(np) = i + 1 < sp->n ? &sg->nodes[sp->nodes[i + 1]] : NULL;
+	N_EDGE(np) = sp->edges[i];
+    }
+}
+
+/// index of the calling thread among those routing edges
+static int
+workerId (void)
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
 #endif
 }
 
@@ -1245,16 +1324,18 @@ void orthoEdges(Agraph_t *g, bool useLbls) {
     sgraph* sg;
     maze* mp;
     route* route_list;
-    int gstart;
     Agnode_t* n;
     Agedge_t* e;
     snode* sn;
     snode* dn;
     epair_t* es = gv_calloc(agnedges(g), sizeof(epair_t));
-    cell* start;
-    cell* dest;
     PointSet* ps = NULL;
-    textlabel_t* lbl;
+    int batch;
+    bool astar;
+    int nsearches = 0;
+    ssearch** searches = NULL;
+    spath_t* paths = NULL;
+    double weight = 0;
 
     if (Concentrate) 
 	ps = newPS();
@@ -1326,34 +1407,50 @@ void orthoEdges(Agraph_t *g, bool useLbls) {
 
     qsort(es, n_edges, sizeof(epair_t), edgecmp);
 
-    gstart = sg->nnodes;
-    PQgen (sg->nnodes+2);
-    sn = &sg->nodes[gstart];
-    dn = &sg->nodes[gstart+1];
-    for (size_t i = 0; i < n_edges; i++) {
+    /* Route the edges in batches. The paths in a batch are all found with the
+     * channel weights left by the previous batches, so they can be searched
+     * for concurrently. They are then converted to routes in order, which
+     * updates the weights.
+     */
+    batch = late_int(g, agattr(g, AGRAPH, "orthobatch", NULL), 1, 1);
+    if ((size_t)batch > n_edges)
+	batch = n_edges > 0 ? (int)n_edges : 1;
+    astar = late_bool(g, agattr(g, AGRAPH, "orthoastar", NULL), false);
+    nsearches = 1;
+#ifdef _OPENMP
+    if (batch > 1)
+	nsearches = omp_get_max_threads();
+#endif
+    searches = gv_calloc(nsearches, sizeof(ssearch*));
+    for (int i = 0; i < nsearches; i++)
+	searches[i] = createSearch (sg);
+    paths = gv_calloc(batch, sizeof(spath_t));
+
+    sn = &sg->nodes[sg->nnodes];
+    dn = &sg->nodes[sg->nnodes+1];
+    for (size_t i = 0; i < n_edges; i += (size_t)batch) {
+	const int nb = (int)MIN((size_t)batch, n_edges - i);
+	int failed = 0;
 #ifdef DEBUG
 	if (i > 0 && (odb_flags & ODB_IGRAPH)) emitSearchGraph (stderr, sg);
 #endif
-	e = es[i].e;
-        start = CELL(agtail(e));
-        dest = CELL(aghead(e));
-
-	if (useLbls && (lbl = ED_label(e)) && lbl->set) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(||:failed) if(nb > 1)
+#endif
+	for (int j = 0; j < nb; j++) {
+	    if (findPath (searches[workerId()], es[i + (size_t)j].e, sn, dn, &paths[j],
+	                  astar))
+		failed = 1;
 	}
-	else {
-	    if (start == dest)
-		addLoop (sg, start, dn, sn);
-	    else {
-       		addNodeEdges (sg, dest, dn);
-		addNodeEdges (sg, start, sn);
-	    }
-       	    if (shortPath (sg, dn, sn)) goto orthofinish;
+	if (failed) goto orthofinish;
+
+	for (int j = 0; j < nb; j++) {
+	    setPath (sg, &paths[j]);
+	    route_list[i + (size_t)j] = convertSPtoRoute(sg, sn, dn);
+	    weight += paths[j].cost;
 	}
-	    
-       	route_list[i] = convertSPtoRoute(sg, sn, dn);
-       	reset (sg);
     }
-    PQfree ();
+    gvtrace_count("ortho route weight", (unsigned long long)llround(weight));
 
     mp->hchans = extractHChans (mp);
     mp->vchans = extractVChans (mp);
@@ -1369,6 +1466,15 @@ orthofinish:
     if (Concentrate)
 	freePS (ps);
 
+    for (int i = 0; i < nsearches; i++)
+	freeSearch (searches[i]);
+    free (searches);
+    for (int i = 0; i < batch; i++) {
+	free (paths[i].nodes);
+	free (paths[i].edges);
+    }
+    free (paths);
+
     for (size_t i=0; i < n_edges; i++)
 	free (route_list[i].segs);
     free (route_list);
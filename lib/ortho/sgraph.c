@@ -11,46 +11,22 @@
 
 #include "config.h"
 #include <cgraph/alloc.h>
+#include <float.h>
 #include <limits.h>
+#include <string.h>
 #include <ortho/sgraph.h>
 #include <ortho/fPQ.h>
 
 void
-gsave (sgraph* G)
+initSEdges (sgraph* g)
 {
     int i;
-    G->save_nnodes = G->nnodes;
-    G->save_nedges = G->nedges;
-    for (i = 0; i < G->nnodes; i++)
-	G->nodes[i].save_n_adj =  G->nodes[i].n_adj;
-}
-
-void 
-reset(sgraph* G)
-{
-    int i;
-    G->nnodes = G->save_nnodes;
-    G->nedges = G->save_nedges;
-    for (i = 0; i < G->nnodes; i++)
-	G->nodes[i].n_adj = G->nodes[i].save_n_adj;
-    for (; i < G->nnodes+2; i++)
-	G->nodes[i].n_adj = 0;
-}
-
-void
-initSEdges (sgraph* g, int maxdeg)
-{
-    int i;
-    int* adj = gv_calloc(6 * g->nnodes + 2 * maxdeg, sizeof(int));
-    g->edges = gv_calloc(3 * g->nnodes + maxdeg, sizeof(sedge));
+    int* adj = gv_calloc(6 * g->nnodes, sizeof(int));
+    g->edges = gv_calloc(3 * g->nnodes, sizeof(sedge));
     for (i = 0; i < g->nnodes; i++) {
 	g->nodes[i].adj_edge_list = adj;
 	adj += 6;
     }
-    for (; i < g->nnodes+2; i++) {
-	g->nodes[i].adj_edge_list = adj;
-	adj += maxdeg;
-    }
 }
 
 sgraph*
@@ -104,94 +80,228 @@ freeSGraph (sgraph* g)
     free (g->nodes[0].adj_edge_list);
     free (g->nodes);
     free (g->edges);
+    free (g->pos);
     free (g);
 }
 
-#include <ortho/fPQ.h>
+/* createSearch:
+ * Allocate the working state for searches over g, whose two end point
+ * nodes follow its other nodes.
+ */
+ssearch*
+createSearch (sgraph* g)
+{
+    ssearch* s = gv_alloc(sizeof(ssearch));
+    int n = g->nnodes + 2;
+
+    s->g = g;
+    s->vals = gv_calloc(n, sizeof(double));
+    s->keys = gv_calloc(n, sizeof(double));
+    s->idxs = gv_calloc(n, sizeof(int));
+    s->gen = gv_calloc(n, sizeof(int));
+    s->dads = gv_calloc(n, sizeof(int));
+    s->dadedge = gv_calloc(n, sizeof(sedge*));
+    s->xhead = gv_calloc(n, sizeof(int));
+    for (int i = 0; i < n; i++)
+	s->xhead[i] = -1;
+    PQgen (&s->pq, n, s->keys, s->idxs);
+    return s;
+}
+
+void
+freeSearch (ssearch* s)
+{
+    if (!s)
+	return;
+    PQfree (&s->pq);
+    free (s->keys);
+    free (s->vals);
+    free (s->idxs);
+    free (s->gen);
+    free (s->dads);
+    free (s->dadedge);
+    free (s->xhead);
+    free (s->xedges);
+    free (s->xnext);
+    free (s);
+}
+
+/* add end k of an end point edge to the list of node v, keeping creation
+ * order; list entries are 2 * edge index + end
+ */
+static void
+addSearchEdgeToNode (ssearch* s, int v, int k)
+{
+    int* p = &s->xhead[v];
+    while (*p >= 0)
+	p = &s->xnext[*p];
+    *p = k;
+    s->xnext[k] = -1;
+}
+
+/* addSearchEdge:
+ * Join an end point and a node of the graph by an edge of weight 0 that is
+ * only seen by this search.
+ */
+void
+addSearchEdge (ssearch* s, snode* v1, snode* v2)
+{
+    if (s->nxedges == s->xsize) {
+	int sz = s->xsize ? 2 * s->xsize : 16;
+	s->xedges = gv_recalloc(s->xedges, s->xsize, sz, sizeof(sedge));
+	s->xnext = gv_recalloc(s->xnext, 2 * s->xsize, 2 * sz, sizeof(int));
+	s->xsize = sz;
+    }
+    int idx = s->nxedges++;
+    sedge* e = s->xedges + idx;
+    e->v1 = v1->index;
+    e->v2 = v2->index;
+    e->weight = 0;
+    e->cnt = 0;
+
+    addSearchEdgeToNode (s, e->v1, 2 * idx);
+    addSearchEdgeToNode (s, e->v2, 2 * idx + 1);
+}
+
+/* clearSearch:
+ * Remove the end point edges, ready for the next route.
+ */
+void
+clearSearch (ssearch* s)
+{
+    for (int i = 0; i < s->nxedges; i++) {
+	s->xhead[s->xedges[i].v1] = -1;
+	s->xhead[s->xedges[i].v2] = -1;
+    }
+    s->nxedges = 0;
+}
 
 /* shortest path:
  * Constructs the path of least weight between from and to.
  * 
- * Assumes graph, node and edge type, and that nodes
- * have associated values N_VAL, N_IDX, and N_DAD, the first two
- * being ints, the last being a node*. Edges have a E_WT function 
- * to specify the edge length or weight.
- * 
- * Assumes there are functions:
- *  agnnodes: graph -> int           number of nodes in the graph
- *  agfstnode, agnxtnode : iterators over the nodes in the graph
- *  agfstedge, agnxtedge : iterators over the edges attached to a node
- *  adjacentNode : given an edge e and an endpoint n of e, returns the
- *                 other endpoint.
- * 
+ * Node values, heap positions and predecessors are kept in the search
+ * state s, indexed by node, so the graph itself is not modified. Edges have
+ * a E_WT function to specify the edge length or weight. Nodes are reached
+ * through the edges of the graph, then through the end point edges of s.
+ *
+ * Values are only valid for nodes stamped with the number of the current
+ * search, so nothing needs clearing between searches.
+ *
+ * If s->goal is set, nodes are taken from the heap in order of their
+ * distance from the start plus the Manhattan distance from their midpoint to
+ * the goal box (A*). Crossing a cell costs at least the Manhattan distance
+ * between the midpoints of the sides it joins, and weights only grow, so the
+ * estimate never exceeds the remaining cost and the path found is still one
+ * of least weight. The end point edges have weight 0 and end on the goal box.
+ * Values are doubles, like the weights and the estimate, as rounding them
+ * at each step would let the estimate exceed the remaining cost.
+ *
  * The path is given by
- *  to, N_DAD(to), N_DAD(N_DAD(to)), ..., from
+ *  to, dads[to], dads[dads[to]], ..., from
  */
 
-#define UNSEEN INT_MIN
+#define UNSEEN (-DBL_MAX)
 
-static snode*
-adjacentNode(sgraph* g, sedge* e, snode* n)
+/* value of node n in the current search */
+static double
+getVal (ssearch* s, int n)
 {
-    if (e->v1==n->index)
-	return &g->nodes[e->v2];
-    else
-	return &g->nodes[e->v1];
+    return s->gen[n] == s->stamp ? s->vals[n] : UNSEEN;
 }
 
-int
-shortPath (sgraph* g, snode* from, snode* to)
+/* estimate of the cost from node n to s->goal */
+static double
+estimate (ssearch* s, int n)
 {
-    snode* n;
-    sedge* e;
-    snode* adjn;
-    int d;
-    int   x, y;
+    if (!s->goal || n >= s->g->nnodes)
+	return 0;
+    pointf p = s->g->pos[n];
+    const boxf* b = s->goal;
+    double dx = p.x < b->LL.x ? b->LL.x - p.x : p.x > b->UR.x ? p.x - b->UR.x : 0;
+    double dy = p.y < b->LL.y ? b->LL.y - p.y : p.y > b->UR.y ? p.y - b->UR.y : 0;
+    return dx + dy;
+}
 
-    for (x = 0; x<g->nnodes; x++) {
-	snode* temp = &g->nodes[x];
-	N_VAL(temp) = UNSEEN;
-    }
-    
-    PQinit();
-    if (PQ_insert (from)) return 1;
-    N_DAD(from) = NULL;
-    N_VAL(from) = 0;
-    
-    while ((n = PQremove())) {
+/* setVal:
+ * Set the value of node n to d and its heap key to match.
+ */
+static void
+setVal (ssearch* s, int n, double d)
+{
+    s->vals[n] = d;
+    s->gen[n] = s->stamp;
+    s->keys[n] = d - estimate (s, n);
+}
+
+/* relax:
+ * Reach the other end of edge e from settled node n.
+ */
+static int
+relax (ssearch* s, int n, sedge* e)
+{
+    int adjn = e->v1 == n ? e->v2 : e->v1;
+    double val = getVal (s, adjn);
+    double d;
+
+    if (val < 0) {
+	d = -(s->vals[n] + E_WT(e));
+	if (val == UNSEEN) {
 #ifdef DEBUG
-	fprintf (stderr, "process %d\n", n->index);
+	    fprintf (stderr, "new %d (%f)\n", adjn, -d);
 #endif
-	N_VAL(n) *= -1;
-	if (n == to) break;
-	for (y=0; y<n->n_adj; y++) {
-	    e = &g->edges[n->adj_edge_list[y]];
-	    adjn = adjacentNode(g, e, n);
-	    if (N_VAL(adjn) < 0) {
-		d = -(N_VAL(n) + E_WT(e));
-		if (N_VAL(adjn) == UNSEEN) {
+	    setVal (s, adjn, d);
+	    if (PQ_insert(&s->pq, adjn)) return 1;
+	    s->dads[adjn] = n;
+	    s->dadedge[adjn] = e;
+	}
+	else {
+	    if (val < d) {
 #ifdef DEBUG
-		    fprintf (stderr, "new %d (%d)\n", adjn->index, -d);
+		fprintf (stderr, "adjust %d (%f)\n", adjn, -d);
 #endif
-		    N_VAL(adjn) = d;
-		    if (PQ_insert(adjn)) return 1;
-		    N_DAD(adjn) = n;
-		    N_EDGE(adjn) = e;
-            	}
-		else {
-		    if (N_VAL(adjn) < d) {
+		setVal (s, adjn, d);
+		PQupdate(&s->pq, adjn, s->keys[adjn]);
+		s->dads[adjn] = n;
+		s->dadedge[adjn] = e;
+	    }
+	}
+    }
+    return 0;
+}
+
+int
+shortPath (ssearch* s, snode* from, snode* to)
+{
+    sgraph* g = s->g;
+    snode* np;
+    int n;
+    int   y;
+
+    if (s->stamp == INT_MAX) {
+	memset (s->gen, 0, (g->nnodes + 2) * sizeof(int));
+	s->stamp = 0;
+    }
+    s->stamp++;
+    
+    PQinit(&s->pq);
+    setVal (s, from->index, 0);
+    if (PQ_insert (&s->pq, from->index)) return 1;
+    s->dads[from->index] = -1;
+    
+    while ((n = PQremove(&s->pq)) >= 0) {
 #ifdef DEBUG
-			fprintf (stderr, "adjust %d (%d)\n", adjn->index, -d);
+	fprintf (stderr, "process %d\n", n);
 #endif
-			PQupdate(adjn, d);
-			N_DAD(adjn) = n;
-			N_EDGE(adjn) = e;
-		    }
-		}
-	    }
+	s->vals[n] *= -1;
+	if (n == to->index) break;
+	np = &g->nodes[n];
+	for (y=0; y<np->n_adj; y++) {
+	    if (relax (s, n, &g->edges[np->adj_edge_list[y]])) return 1;
+	}
+	for (y = s->xhead[n]; y >= 0; y = s->xnext[y]) {
+	    if (relax (s, n, &s->xedges[y / 2])) return 1;
 	}
     }
 
     return 0;
 }
-
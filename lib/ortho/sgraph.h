@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <ortho/fPQ.h>
 #include <ortho/structures.h>
 #include <stdbool.h>
 
@@ -24,11 +25,9 @@ typedef struct sedge sedge;
  */
 
 struct snode {
-  int n_val, n_idx;
-  snode* n_dad;
-  sedge* n_edge;
+  snode* n_dad;   ///< next node on the path being converted to a route
+  sedge* n_edge;  ///< edge to @ref n_dad
   short   n_adj;
-  short   save_n_adj;
   struct cell* cells[2]; ///< [0] - left or botom, [1] - top or right adjusted cell
 
     /** @brief edges incident on this node
@@ -48,18 +47,48 @@ struct sedge {
   int v1, v2;
 };
 
+/** @brief search graph of a @ref maze
+ *
+ * Two nodes past @ref nnodes are reserved for the end points of a route.
+ */
 typedef struct {
   int nnodes, nedges;
-  int save_nnodes, save_nedges;
   snode* nodes;
   sedge* edges;
+  pointf* pos;  ///< midpoint of the segment of each node, used by A*
 } sgraph;
 
-extern void reset(sgraph*);
-extern void gsave(sgraph*);
+/** @brief working state of a path search over a shared @ref sgraph
+ *
+ * The graph is only read while searching. The edges joining the two end
+ * points of a route to the sides of their cells are kept here, along with the
+ * node values and the heap, so several searches can run over one graph at
+ * once.
+ */
+typedef struct {
+  sgraph* g;
+  PQ pq;
+  double* vals;     ///< per node, distance from the start, negated until final
+  double* keys;     ///< per node, heap key: @ref vals less the A* estimate
+  int* idxs;        ///< per node, position in @ref pq
+  int* gen;         ///< per node, the search in which @ref vals was last set
+  int stamp;        ///< number of the current search
+  const boxf* goal; ///< if set, search by A* towards this box
+  int* dads;        ///< per node, predecessor on the best path or -1
+  sedge** dadedge;  ///< per node, edge to the predecessor
+  int* xhead;       ///< per node, first end point edge or -1
+  sedge* xedges;    ///< edges incident on the end points
+  int* xnext;       ///< per end point edge, next one at the same node or -1
+  int nxedges, xsize;
+} ssearch;
+
 extern sgraph* createSGraph(int);
 extern void freeSGraph (sgraph*);
-extern void initSEdges (sgraph* g, int maxdeg);
-extern int shortPath (sgraph* g, snode* from, snode* to);
+extern void initSEdges (sgraph* g);
 extern snode* createSNode (sgraph*);
 extern sedge* createSEdge (sgraph* g, snode* v0, snode* v1, double wt);
+extern ssearch* createSearch (sgraph* g);
+extern void freeSearch (ssearch* s);
+extern void addSearchEdge (ssearch* s, snode* v0, snode* v1);
+extern void clearSearch (ssearch* s);
+extern int shortPath (ssearch* s, snode* from, snode* to);
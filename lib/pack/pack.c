@@ -23,23 +23,38 @@
 #include <cgraph/streq.h>
 #include <common/render.h>
 #include <pack/pack.h>
-#include <common/pointset.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define C 100			/* Max. avg. polyomino size */
 
 #define MOVEPT(p) ((p).x += dx, (p).y += dy)
 /* Given cell size s, GRID(x:double,s:int) returns how many cells are required by size x */
 #define GRID(x,s) ((int)ceil((x)/(s)))
-/* Given grid cell size s, CVAL(v:int,s:int) returns index of cell containing point v */
-#define CVAL(v,s) ((v) >= 0 ? (v)/(s) : (((v)+1)/(s))-1)
+/* Given grid cell size s, CVAL(v:double,s:int) returns index of cell containing point v */
+#define CVAL(v,s) floor((v) / (s))
 /* Given grid cell size s, CELL(p:point,s:int) sets p to cell containing point p */
 #define CELL(p,s) ((p).x = CVAL((p).x,s), (p).y = CVAL((p).y,(s)))
 
+/// a set of grid cells, stored as rows of bits
+///
+/// Cell (x, y) is bit x - x0 of row y - y0, with bit i of a row in bit i % 64
+/// of word i / 64. Cells beyond the rows are empty. This lets a polyomino be
+/// tested against the cells already taken a word at a time.
+typedef struct {
+    int x0, y0;		///< cell of the first bit of the first row
+    int height;		///< number of rows
+    size_t stride;	///< words per row
+    uint64_t *bits;	///< height × stride words
+} bitgrid;
+
 typedef struct {
     int perim;			/* half size of bounding rectangle perimeter */
-    pointf *cells;		///< cells in covering polyomino
+    bitgrid cells;		///< cells in covering polyomino
     int nc;			/* no. of cells */
     size_t index; ///<  index in original array
 } ginfo;
@@ -49,6 +64,170 @@ typedef struct {
     size_t index; ///< index in original array
 } ainfo;
 
+/// floor of a / 64
+static long wordOf(long a) {
+    return a >= 0 ? a / 64 : -((-a + 63) / 64);
+}
+
+/* Grow the grid to take in the cells from (lx,ly) to (ux,uy).
+ * Each side that grows at least doubles, so filling a grid cell by
+ * cell takes amortized constant time per cell.
+ */
+static void bgCover(bitgrid *g, int lx, int ly, int ux, int uy) {
+    if (g->bits == NULL) {
+	g->x0 = lx;
+	g->y0 = ly;
+	g->height = uy - ly + 1;
+	g->stride = (size_t)(ux - lx) / 64 + 1;
+	g->bits = gv_calloc((size_t)g->height * g->stride, sizeof(uint64_t));
+	return;
+    }
+
+    const long x1 = g->x0 + 64 * (long)g->stride - 1;
+    const int y1 = g->y0 + g->height - 1;
+    if (lx >= g->x0 && ux <= x1 && ly >= g->y0 && uy <= y1)
+	return;
+
+    size_t left = 0, right = 0;
+    int below = 0, above = 0;
+    if (lx < g->x0) {
+	left = (size_t)(g->x0 - lx + 63) / 64;
+	left = left > g->stride ? left : g->stride;
+    }
+    if (ux > x1) {
+	right = (size_t)(ux - x1 + 63) / 64;
+	right = right > g->stride ? right : g->stride;
+    }
+    if (ly < g->y0)
+	below = g->y0 - ly > g->height ? g->y0 - ly : g->height;
+    if (uy > y1)
+	above = uy - y1 > g->height ? uy - y1 : g->height;
+
+    const size_t stride = g->stride + left + right;
+    const int height = g->height + below + above;
+    uint64_t *bits = gv_calloc((size_t)height * stride, sizeof(uint64_t));
+    for (int r = 0; r < g->height; r++)
+	memcpy(bits + (size_t)(r + below) * stride + left,
+	       g->bits + (size_t)r * g->stride, g->stride * sizeof(uint64_t));
+    free(g->bits);
+    g->bits = bits;
+    g->x0 -= 64 * (int)left;
+    g->y0 -= below;
+    g->stride = stride;
+    g->height = height;
+}
+
+/// add cell (x,y) to the grid
+static void bgSet(bitgrid *g, int x, int y) {
+    bgCover(g, x, y, x, y);
+    const size_t col = (size_t)(x - g->x0);
+    g->bits[(size_t)(y - g->y0) * g->stride + col / 64] |= UINT64_C(1) << (col % 64);
+}
+
+/// is cell (x,y) in the grid?
+static bool bgGet(const bitgrid *g, int x, int y) {
+    if (g->bits == NULL || y < g->y0 || y >= g->y0 + g->height || x < g->x0)
+	return false;
+    const size_t col = (size_t)(x - g->x0);
+    if (col / 64 >= g->stride)
+	return false;
+    return (g->bits[(size_t)(y - g->y0) * g->stride + col / 64] >> (col % 64)) & 1;
+}
+
+/* Test whether any cell of p, translated by (dx,dy), is in g. If merge
+ * is true, add the translated cells of p to g instead.
+ */
+static bool bgOverlay(bitgrid *g, const bitgrid *p, int dx, int dy,
+                      bool merge) {
+    if (p->bits == NULL)
+	return false;
+    if (merge)
+	bgCover(g, p->x0 + dx, p->y0 + dy,
+	        p->x0 + dx + 64 * (int)p->stride - 1, p->y0 + dy + p->height - 1);
+    else if (g->bits == NULL)
+	return false;
+
+    const long stride = (long)g->stride;
+    // position in the rows of g of the first bit of the rows of p
+    const long off = (long)p->x0 + dx - g->x0;
+    for (int r = 0; r < p->height; r++) {
+	const int gr = p->y0 + r + dy - g->y0;
+	if (gr < 0 || gr >= g->height)
+	    continue;
+	const uint64_t *prow = p->bits + (size_t)r * p->stride;
+	uint64_t *grow = g->bits + (size_t)gr * g->stride;
+	for (size_t k = 0; k < p->stride; k++) {
+	    const uint64_t w = prow[k];
+	    if (w == 0)
+		continue;
+	    // the word straddles words q and q + 1 of the row of g
+	    const long pos = off + 64 * (long)k;
+	    const long q = wordOf(pos);
+	    const int sh = (int)(pos - 64 * q);
+	    const uint64_t lo = w << sh;
+	    const uint64_t hi = sh == 0 ? 0 : w >> (64 - sh);
+	    if (merge) {
+		grow[q] |= lo;
+		if (hi)
+		    grow[q + 1] |= hi;
+	    } else {
+		if (q >= 0 && q < stride && (grow[q] & lo))
+		    return true;
+		if (hi && q + 1 >= 0 && q + 1 < stride && (grow[q + 1] & hi))
+		    return true;
+	    }
+	}
+    }
+    return false;
+}
+
+/// number of cells in the grid
+static int bgCount(const bitgrid *g) {
+    int n = 0;
+    for (size_t i = 0; i < (size_t)g->height * g->stride; i++)
+	for (uint64_t w = g->bits[i]; w != 0; w &= w - 1)
+	    n++;
+    return n;
+}
+
+static void bgFree(bitgrid *g) {
+    free(g->bits);
+    *g = (bitgrid){0};
+}
+
+/// shrink the grid to the rows and columns its cells span
+static void bgTrim(bitgrid *g) {
+    int lx = INT_MAX, ly = INT_MAX, ux = INT_MIN, uy = INT_MIN;
+    for (int y = g->y0; y < g->y0 + g->height; y++)
+	for (int x = g->x0; x < g->x0 + 64 * (int)g->stride; x++)
+	    if (bgGet(g, x, y)) {
+		lx = x < lx ? x : lx;
+		ux = x > ux ? x : ux;
+		ly = y < ly ? y : ly;
+		uy = y;
+	    }
+    if (lx > ux)
+	return;
+
+    bitgrid t = {0};
+    bgCover(&t, lx, ly, ux, uy);
+    for (int y = ly; y <= uy; y++)
+	for (int x = lx; x <= ux; x++)
+	    if (bgGet(g, x, y))
+		bgSet(&t, x, y);
+    bgFree(g);
+    *g = t;
+}
+
+/// list the cells of the grid, for debugging
+static void bgDump(const bitgrid *g) {
+    for (int x = g->x0; x < g->x0 + 64 * (int)g->stride; x++)
+	for (int y = g->y0; y < g->y0 + g->height; y++)
+	    if (bgGet(g, x, y))
+		fprintf(stderr, "  %d %d cell\n", x, y);
+}
+
+
 /* Compute grid step size. This is a root of the
  * quadratic equation al^2 +bl + c, where a, b and
  * c are defined below.
@@ -116,7 +295,7 @@ static int sgn(int x) {
 /* Mark cells crossed by line from cell p to cell q.
  * Bresenham's algorithm, from Graphics Gems I, pp. 99-100.
  */
-static void fillLine(pointf p, pointf q, PointSet * ps)
+static void fillLine(pointf p, pointf q, bitgrid *ps)
 {
     int x1 = ROUND(p.x);
     int y1 = ROUND(p.y);
@@ -136,7 +315,7 @@ static void fillLine(pointf p, pointf q, PointSet * ps)
     if (ax > ay) {              /* x dominant */
         d = ay - (ax >> 1);
         for (;;) {
-            addPS(ps, x, y);
+            bgSet(ps, x, y);
             if (x == x2)
                 return;
             if (d >= 0) {
@@ -149,7 +328,7 @@ static void fillLine(pointf p, pointf q, PointSet * ps)
     } else {                    /* y dominant */
         d = ax - (ay >> 1);
         for (;;) {
-            addPS(ps, x, y);
+            bgSet(ps, x, y);
             if (y == y2)
                 return;
             if (d >= 0) {
@@ -165,7 +344,7 @@ static void fillLine(pointf p, pointf q, PointSet * ps)
 /* It appears that spline_edges always have the start point at the
  * beginning and the end point at the end.
  */
-static void fillEdge(Agedge_t *e, pointf p, PointSet *ps, double dx, double dy,
+static void fillEdge(Agedge_t *e, pointf p, bitgrid *ps, double dx, double dy,
          int ssize, bool doS) {
     size_t k;
     bezier bz;
@@ -225,14 +404,12 @@ static void fillEdge(Agedge_t *e, pointf p, PointSet *ps, double dx, double dy,
  */
 static void genBox(boxf bb0, ginfo *info, int ssize, unsigned int margin,
                    pointf center, char *s) {
-    PointSet *ps;
+    bitgrid ps = {0};
     int W, H;
     pointf UR, LL;
     boxf bb;
-    double x, y;
 
     bb = bb0;
-    ps = newPS();
 
     LL.x = center.x - margin;
     LL.y = center.y - margin;
@@ -241,26 +418,22 @@ static void genBox(boxf bb0, ginfo *info, int ssize, unsigned int margin,
     CELL(LL, ssize);
     CELL(UR, ssize);
 
-    for (x = LL.x; x <= UR.x; x++)
-	for (y = LL.y; y <= UR.y; y++)
-	    addPS(ps, x, y);
+    bgCover(&ps, (int)LL.x, (int)LL.y, (int)UR.x, (int)UR.y);
+    for (int x = (int)LL.x; x <= UR.x; x++)
+	for (int y = (int)LL.y; y <= UR.y; y++)
+	    bgSet(&ps, x, y);
 
-    info->cells = pointsOf(ps);
-    info->nc = sizeOf(ps);
+    info->cells = ps;
+    info->nc = bgCount(&ps);
     W = GRID(bb0.UR.x - bb0.LL.x + 2 * margin, ssize);
     H = GRID(bb0.UR.y - bb0.LL.y + 2 * margin, ssize);
     info->perim = W + H;
 
     if (Verbose > 2) {
-	int i;
 	fprintf(stderr, "%s no. cells %d W %d H %d\n",
 		s, info->nc, W, H);
-	for (i = 0; i < info->nc; i++)
-	    fprintf(stderr, "  %.0f %.0f cell\n", info->cells[i].x,
-		    info->cells[i].y);
+	bgDump(&info->cells);
     }
-
-    freePS(ps);
 }
 
 /* Generate polyomino info from graph.
@@ -274,7 +447,8 @@ static void genBox(boxf bb0, ginfo *info, int ssize, unsigned int margin,
  */
 static int genPoly(Agraph_t *root, Agraph_t *g, ginfo *info, int ssize,
                    pack_info *pinfo, pointf center) {
-    PointSet *ps;
+    bitgrid grid = {0};
+    bitgrid *ps = &grid;
     int W, H;
     Agraph_t *eg;		/* graph containing edges */
     Agnode_t *n;
@@ -288,7 +462,6 @@ static int genPoly(Agraph_t *root, Agraph_t *g, ginfo *info, int ssize,
     else
 	eg = g;
 
-    ps = newPS();
     const double dx = center.x - round(GD_bb(g).LL.x);
     const double dy = center.y - round(GD_bb(g).LL.y);
 
@@ -316,9 +489,9 @@ static int genPoly(Agraph_t *root, Agraph_t *g, ginfo *info, int ssize,
 		CELL(bb.LL, ssize);
 		CELL(bb.UR, ssize);
 
-		for (double x = bb.LL.x; x <= bb.UR.x; x++)
-		    for (double y = bb.LL.y; y <= bb.UR.y; y++)
-			addPS(ps, x, y);
+		for (int x = (int)bb.LL.x; x <= bb.UR.x; x++)
+		    for (int y = (int)bb.LL.y; y <= bb.UR.y; y++)
+			bgSet(ps, x, y);
 
 		/* note which nodes are in clusters */
 		for (n = agfstnode(subg); n; n = agnxtnode(subg, n))
@@ -338,9 +511,9 @@ static int genPoly(Agraph_t *root, Agraph_t *g, ginfo *info, int ssize,
 		CELL(LL, ssize);
 		CELL(UR, ssize);
 
-		for (double x = LL.x; x <= UR.x; x++)
-		    for (double y = LL.y; y <= UR.y; y++)
-			addPS(ps, x, y);
+		for (int x = (int)LL.x; x <= UR.x; x++)
+		    for (int y = (int)LL.y; y <= UR.y; y++)
+			bgSet(ps, x, y);
 
 		CELL(pt, ssize);
 		for (e = agfstout(eg, n); e; e = agnxtout(eg, e)) {
@@ -373,9 +546,9 @@ static int genPoly(Agraph_t *root, Agraph_t *g, ginfo *info, int ssize,
 	    CELL(LL, ssize);
 	    CELL(UR, ssize);
 
-	    for (double x = LL.x; x <= UR.x; x++)
-		for (double y = LL.y; y <= UR.y; y++)
-		    addPS(ps, x, y);
+	    for (int x = (int)LL.x; x <= UR.x; x++)
+		for (int y = (int)LL.y; y <= UR.y; y++)
+		    bgSet(ps, x, y);
 
 	    CELL(pt, ssize);
 	    for (e = agfstout(eg, n); e; e = agnxtout(eg, e)) {
@@ -383,59 +556,39 @@ static int genPoly(Agraph_t *root, Agraph_t *g, ginfo *info, int ssize,
 	    }
 	}
 
-    info->cells = pointsOf(ps);
-    info->nc = sizeOf(ps);
+    bgTrim(&grid);
+    info->cells = grid;
+    info->nc = bgCount(&grid);
     W = GRID(GD_bb(g).UR.x - GD_bb(g).LL.x + 2 * margin, ssize);
     H = GRID(GD_bb(g).UR.y - GD_bb(g).LL.y + 2 * margin, ssize);
     info->perim = W + H;
 
     if (Verbose > 2) {
-	int i;
 	fprintf(stderr, "%s no. cells %d W %d H %d\n",
 		agnameof(g), info->nc, W, H);
-	for (i = 0; i < info->nc; i++)
-	    fprintf(stderr, "  %.0f %.0f cell\n", info->cells[i].x,
-		    info->cells[i].y);
+	bgDump(&info->cells);
     }
 
-    freePS(ps);
     return 0;
 }
 
 /* Check if polyomino fits at given point.
- * If so, add cells to pointset, store point in place and return true.
+ * If so, add cells to the grid, store point in place and return true.
  */
-static int fits(int x, int y, ginfo *info, PointSet *ps, pointf *place,
+static int fits(int x, int y, ginfo *info, bitgrid *ps, pointf *place,
                 int step, boxf *bbs) {
-    pointf *cells = info->cells;
-    int n = info->nc;
-    int i;
-
-    for (i = 0; i < n; i++) {
-	pointf cell = *cells;
-	cell.x += x;
-	cell.y += y;
-	if (inPS(ps, cell))
-	    return 0;
-	cells++;
-    }
+    if (bgOverlay(ps, &info->cells, x, y, false))
+	return 0;
 
     const pointf LL = bbs[info->index].LL;
     place->x = step * x - LL.x;
     place->y = step * y - LL.y;
 
-    cells = info->cells;
-    for (i = 0; i < n; i++) {
-	pointf cell = *cells;
-	cell.x += x;
-	cell.y += y;
-	insertPS(ps, cell);
-	cells++;
-    }
+    bgOverlay(ps, &info->cells, x, y, true);
 
     if (Verbose >= 2)
-	fprintf(stderr, "cc (%d cells) at (%d,%d) (%.0f,%.0f)\n", n, x, y,
-		place->x, place->y);
+	fprintf(stderr, "cc (%d cells) at (%d,%d) (%.0f,%.0f)\n", info->nc,
+		x, y, place->x, place->y);
     return 1;
 }
 
@@ -443,21 +596,15 @@ static int fits(int x, int y, ginfo *info, PointSet *ps, pointf *place,
  * fill polyomino set. Note that polyomino set for the
  * graph is constructed where it will be.
  */
-static void placeFixed(ginfo *info, PointSet *ps, pointf *place,
+static void placeFixed(ginfo *info, bitgrid *ps, pointf *place,
                        pointf center) {
-    pointf *cells = info->cells;
-    int n = info->nc;
-    int i;
-
     place->x = -center.x;
     place->y = -center.y;
 
-    for (i = 0; i < n; i++) {
-	insertPS(ps, *cells++);
-    }
+    bgOverlay(ps, &info->cells, 0, 0, true);
 
     if (Verbose >= 2)
-	fprintf(stderr, "cc (%d cells) at (%.0f,%.0f)\n", n, place->x,
+	fprintf(stderr, "cc (%d cells) at (%.0f,%.0f)\n", info->nc, place->x,
 		place->y);
 }
 
@@ -466,7 +613,7 @@ static void placeFixed(ginfo *info, PointSet *ps, pointf *place,
  * with bounding box origin at point.
  * First graph (i == 0) is centered on the origin if possible.
  */
-static void placeGraph(size_t i, ginfo *info, PointSet *ps, pointf *place,
+static void placeGraph(size_t i, ginfo *info, bitgrid *ps, pointf *place,
                        int step, unsigned int margin, boxf* bbs) {
     int x, y;
     int bnd;
@@ -529,13 +676,8 @@ static void placeGraph(size_t i, ginfo *info, PointSet *ps, pointf *place,
 #ifdef DEBUG
 void dumpp(ginfo * info, char *pfx)
 {
-    pointf *cells = info->cells;
-    int i, c_cnt = info->nc;
-
     fprintf(stderr, "%s\n", pfx);
-    for (i = 0; i < c_cnt; i++) {
-	fprintf(stderr, "%.0f %.0f box\n", cells[i].x, cells[i].y);
-    }
+    bgDump(&info->cells);
 }
 #endif
 
@@ -682,7 +824,7 @@ static pointf *arrayRects(size_t ng, boxf *gs, pack_info *pinfo) {
 
 static pointf *polyRects(size_t ng, boxf *gs, pack_info *pinfo) {
     int stepSize;
-    Dict_t *ps;
+    bitgrid ps = {0};
 
     /* calculate grid size */
     stepSize = computeStep(ng, gs, pinfo->margin);
@@ -705,17 +847,16 @@ static pointf *polyRects(size_t ng, boxf *gs, pack_info *pinfo) {
     }
     qsort(sinfo, ng, sizeof(ginfo *), cmpf);
 
-    ps = newPS();
     pointf *places = gv_calloc(ng, sizeof(pointf));
     for (size_t i = 0; i < ng; i++)
-	placeGraph(i, sinfo[i], ps, places + sinfo[i]->index,
+	placeGraph(i, sinfo[i], &ps, places + sinfo[i]->index,
 		       stepSize, pinfo->margin, gs);
 
     free(sinfo);
     for (size_t i = 0; i < ng; i++)
-	free(info[i].cells);
+	bgFree(&info[i].cells);
     free(info);
-    freePS(ps);
+    bgFree(&ps);
 
     if (Verbose > 1)
 	for (size_t i = 0; i < ng; i++)
@@ -746,14 +887,13 @@ static pointf *polyRects(size_t ng, boxf *gs, pack_info *pinfo) {
  *
  * FIX: fixed mode does not always work. The fixed ones get translated
  * back to be centered on the origin.
- * FIX: Check CELL and GRID macros for negative coordinates 
  * FIX: Check width and height computation
  */
 static pointf *polyGraphs(size_t ng, Agraph_t **gs, Agraph_t *root,
                           pack_info *pinfo) {
     int stepSize;
     ginfo *info;
-    Dict_t *ps;
+    bitgrid ps = {0};
     bool *fixed = pinfo->fixed;
     int fixed_cnt = 0;
     boxf fixed_bb = { {0, 0}, {0, 0} };
@@ -820,29 +960,28 @@ static pointf *polyGraphs(size_t ng, Agraph_t **gs, Agraph_t *root,
     }
     qsort(sinfo, ng, sizeof(ginfo *), cmpf);
 
-    ps = newPS();
     pointf *places = gv_calloc(ng, sizeof(pointf));
     if (fixed) {
 	for (size_t i = 0; i < ng; i++) {
 	    if (fixed[i])
-		placeFixed(sinfo[i], ps, places + sinfo[i]->index, center);
+		placeFixed(sinfo[i], &ps, places + sinfo[i]->index, center);
 	}
 	for (size_t i = 0; i < ng; i++) {
 	    if (!fixed[i])
-		placeGraph(i, sinfo[i], ps, places + sinfo[i]->index,
+		placeGraph(i, sinfo[i], &ps, places + sinfo[i]->index,
 			   stepSize, pinfo->margin, bbs);
 	}
     } else {
 	for (size_t i = 0; i < ng; i++)
-	    placeGraph(i, sinfo[i], ps, places + sinfo[i]->index,
+	    placeGraph(i, sinfo[i], &ps, places + sinfo[i]->index,
 		       stepSize, pinfo->margin, bbs);
     }
 
     free(sinfo);
     for (size_t i = 0; i < ng; i++)
-	free(info[i].cells);
+	bgFree(&info[i].cells);
     free(info);
-    freePS(ps);
+    bgFree(&ps);
     free (bbs);
 
     if (Verbose > 1)
@@ -23,6 +23,7 @@
 #include <common/arith.h>
 #include <math.h>
 #include <common/globals.h>
+#include <common/instrument.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
@@ -253,6 +254,23 @@ void export_embedding(FILE *fp, int dim, SparseMatrix A, double *x, double *widt
 
 }
 
+static unsigned long long qtree_size(QuadTree qt) {
+  if (qt == NULL)
+    return 0;
+  unsigned long long size = 1;
+  if (qt->qts != NULL) {
+    for (int i = 0; i < 1 << qt->dim; i++)
+      size += qtree_size(qt->qts[i]);
+  }
+  return size;
+}
+
+/// count the nodes of a newly built quadtree, if anyone is looking
+static void trace_qtree(QuadTree qt) {
+  if (gvtrace_enabled())
+    gvtrace_count("quadtree nodes", qtree_size(qt));
+}
+
 static double update_step(bool adaptive_cooling, double step, double Fnorm,
                           double Fnorm0) {
 
@@ -386,6 +404,7 @@ void spring_electrical_embedding_fast(int dim, SparseMatrix A0, spring_electrica
     start = clock();
 #endif
     QuadTree qt = QuadTree_new_from_point_list(dim, n, max_qtree_level, x);
+    trace_qtree(qt);
 
 #ifdef TIME
     qtree_new_cpu += ((double) (clock() - start))/CLOCKS_PER_SEC;
@@ -720,6 +739,7 @@ void spring_electrical_embedding(int dim, SparseMatrix A0, spring_electrical_con
 
       max_qtree_level = oned_optimizer_get(qtree_level_optimizer);
       qt = QuadTree_new_from_point_list(dim, n, max_qtree_level, x);
+      trace_qtree(qt);
 
 	
     }
@@ -919,6 +939,7 @@ void spring_electrical_spring_embedding(int dim, SparseMatrix A0, SparseMatrix D
     QuadTree qt = NULL;
     if (USE_QT) {
       qt = QuadTree_new_from_point_list(dim, n, max_qtree_level, x);
+      trace_qtree(qt);
     }
 
     for (i = 0; i < n; i++){
@@ -114,10 +114,9 @@ static Agnode_t *findCenterNode(Agraph_t * g)
 }
 
 /* bfs to create tree structure */
-static void setNStepsToCenter(Agraph_t * g, Agnode_t * n)
+static void setNStepsToCenter(Agraph_t * g, Agnode_t * n, Agsym_t *wt)
 {
     Agnode_t *next;
-    Agsym_t* wt = agfindedgeattr(g,"weight");
     queue_t q = {0};
 
     queue_push(&q,n);
@@ -143,14 +142,14 @@ static void setNStepsToCenter(Agraph_t * g, Agnode_t * n)
  * nStepsToCenter and parent node for each node.
  * Return UINT64_MAX if some node was not reached.
  */
-static uint64_t setParentNodes(Agraph_t * sg, Agnode_t * center)
+static uint64_t setParentNodes(Agraph_t * sg, Agnode_t * center, Agsym_t *wt)
 {
     uint64_t maxn = 0;
     uint64_t unset = SCENTER(center);
 
     SCENTER(center) = 0;
     SPARENT(center) = 0;
-    setNStepsToCenter(sg, center);
+    setNStepsToCenter(sg, center, wt);
 
     /* find the maximum number of steps from the center */
     for (Agnode_t *n = agfstnode(sg); n; n = agnxtnode(sg, n)) {
@@ -251,16 +250,15 @@ static void setPositions(Agraph_t * sg, Agnode_t * center)
  * If the ranksep attribute is not provided, use DEF_RANKSEP for all values. 
  */ 
 static double*
-getRankseps (Agraph_t* g, uint64_t maxrank)
+getRankseps (const char *p, uint64_t maxrank)
 {
-    char *p;
     char *endp;
     char c;
     uint64_t rk = 1;
     double* ranks = gv_calloc(maxrank + 1, sizeof(double));
     double xf = 0.0, delx = 0.0, d;
 
-    if ((p = late_string(g, agfindgraphattr(g->root, "ranksep"), NULL))) {
+    if (p) {
 	while (rk <= maxrank && (d = strtod (p, &endp)) > 0) {
 	    delx = fmax(d, MIN_RANKSEP);
 	    xf += delx;
@@ -282,9 +280,9 @@ getRankseps (Agraph_t* g, uint64_t maxrank)
     return ranks;
 }
 
-static void setAbsolutePos(Agraph_t * g, uint64_t maxrank)
+static void setAbsolutePos(Agraph_t * g, uint64_t maxrank, const char *rs)
 {
-    double* ranksep = getRankseps (g, maxrank);
+    double* ranksep = getRankseps (rs, maxrank);
     if (Verbose) {
 	fputs ("Rank separation = ", stderr);
 	for (uint64_t i = 0; i <= maxrank; i++)
@@ -301,32 +299,32 @@ static void setAbsolutePos(Agraph_t * g, uint64_t maxrank)
     free (ranksep);
 }
 
-/* circleLayout:
- *  We assume sg is is connected and non-empty.
- *  Also, if center != 0, we are guaranteed that center is
- *  in the graph.
- */
-Agnode_t* circleLayout(Agraph_t * sg, Agnode_t * center)
+void circleLayoutJob(circle_job_t *job)
 {
+    Agraph_t *sg = job->sg;
+    Agnode_t *center = job->center;
+
+    job->root = center;
+    job->disconnected = false;
     if (agnnodes(sg) == 1) {
 	Agnode_t *n = agfstnode(sg);
 	ND_pos(n)[0] = 0;
 	ND_pos(n)[1] = 0;
-	return center;
+	return;
     }
 
     initLayout(sg);
 
     if (!center)
-	center = findCenterNode(sg);
+	center = job->root = findCenterNode(sg);
 
-    uint64_t maxNStepsToCenter = setParentNodes(sg,center);
+    uint64_t maxNStepsToCenter = setParentNodes(sg, center, job->weight);
     if (Verbose)
 	fprintf(stderr, "root = %s max steps to root = %" PRIu64 "\n",
 	        agnameof(center), maxNStepsToCenter);
     if (maxNStepsToCenter == UINT64_MAX) {
-	agerrorf("twopi: use of weight=0 creates disconnected component.\n");
-	return center;
+	job->disconnected = true;
+	return;
     }
 
     setSubtreeSize(sg);
@@ -335,6 +333,30 @@ Agnode_t* circleLayout(Agraph_t * sg, Agnode_t * center)
 
     setPositions(sg, center);
 
-    setAbsolutePos(sg, maxNStepsToCenter);
-    return center;
+    setAbsolutePos(sg, maxNStepsToCenter, job->ranksep);
+}
+
+void circleJobInit(circle_job_t *job, Agraph_t *sg, Agnode_t *center)
+{
+    *job = (circle_job_t){
+	.sg = sg,
+	.center = center,
+	.weight = agfindedgeattr(sg, "weight"),
+	.ranksep = late_string(sg, agfindgraphattr(sg->root, "ranksep"), NULL),
+    };
+}
+
+/* circleLayout:
+ *  We assume sg is is connected and non-empty.
+ *  Also, if center != 0, we are guaranteed that center is
+ *  in the graph.
+ */
+Agnode_t* circleLayout(Agraph_t * sg, Agnode_t * center)
+{
+    circle_job_t job;
+    circleJobInit(&job, sg, center);
+    circleLayoutJob(&job);
+    if (job.disconnected)
+	agerrorf("twopi: use of weight=0 creates disconnected component.\n");
+    return job.root;
 }
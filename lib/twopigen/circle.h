@@ -11,6 +11,7 @@
 #pragma once
 
 #include "render.h"
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +36,25 @@ extern "C" {
 #define SPAN(n) (RDATA(n)->span)
 #define THETA(n) (RDATA(n)->theta)
 
+/// a component to be laid out by @ref circleLayoutJob
+typedef struct {
+  Agraph_t *sg;        ///< connected, non-empty component
+  Agnode_t *center;    ///< requested root node, or NULL to pick one
+  Agnode_t *root;      ///< set to the root node used
+  Agsym_t *weight;     ///< edge weight attribute, or NULL
+  const char *ranksep; ///< ranksep attribute value, or NULL
+  bool disconnected;   ///< set if edges of weight 0 disconnected the component
+} circle_job_t;
+
+/// look up the attributes a component's layout needs
+void circleJobInit(circle_job_t *job, Agraph_t *sg, Agnode_t *center);
+
+/// lay out a component prepared by @ref circleJobInit
+///
+/// This neither searches graph dictionaries nor reports errors, so jobs for
+/// different components can run concurrently.
+void circleLayoutJob(circle_job_t *job);
+
     extern Agnode_t* circleLayout(Agraph_t * sg, Agnode_t * center);
     extern void twopi_layout(Agraph_t * g);
     extern void twopi_cleanup(Agraph_t * g);
@@ -137,6 +137,9 @@ void twopi_layout(Agraph_t * g)
 	    getPackInfo (g, l_node, CL_OFFSET, &pinfo);
 	    pinfo.doSplines = false;
 
+	    // Components are prepared and finished in order, as these search and
+	    // modify the graph, but laid out concurrently in between.
+	    circle_job_t *jobs = gv_calloc(ncc, sizeof(circle_job_t));
 	    for (size_t i = 0; i < ncc; i++) {
 		sg = ccs[i];
 		if (ctr && agcontains(sg, ctr))
@@ -144,13 +147,29 @@ void twopi_layout(Agraph_t * g)
 		else if (!rootattr || !(lctr = findRootNode(sg, rootattr)))
 		    lctr = 0;
 		(void)graphviz_node_induce(sg, NULL);
-		c = circleLayout(sg, lctr);
+		circleJobInit(&jobs[i], sg, lctr);
+	    }
+
+	    // each job only touches the nodes of its own component
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if(ncc > 1 && !Verbose)
+#endif
+	    for (size_t i = 0; i < ncc; i++)
+		circleLayoutJob(&jobs[i]);
+
+	    for (size_t i = 0; i < ncc; i++) {
+		sg = ccs[i];
+		if (jobs[i].disconnected)
+		    agerrorf("twopi: use of weight=0 creates disconnected component.\n");
+		lctr = jobs[i].center;
+		c = jobs[i].root;
 	        if (setRoot && !ctr)
 		    ctr = c;
 		if (setLocalRoot && (!lctr || (lctr == ctr)))
 		    agxset (c, rootattr, "1"); 
 		adjustNodes(sg);
 	    }
+	    free(jobs);
 	    n = agfstnode(g);
 	    free(ND_alg(n));
 	    ND_alg(n) = NULL;
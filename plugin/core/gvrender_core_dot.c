@@ -42,6 +42,7 @@ typedef enum {
 	FORMAT_XDOT,
 	FORMAT_XDOT12,
 	FORMAT_XDOT14,
+	FORMAT_GVB,
 } format_type;
 
 #define XDOTVERSION "1.7"
@@ -392,7 +393,8 @@ static void dot_begin_graph(GVJ_t *job)
 	    break;
 	case FORMAT_XDOT:
 	case FORMAT_XDOT12:
-	case FORMAT_XDOT14: {
+	case FORMAT_XDOT14:
+	case FORMAT_GVB: {
 	    bool e_arrows; // graph has edges with end arrows
 	    bool s_arrows; // graph has edges with start arrows
 	    attach_attrs_and_arrows(g, &s_arrows, &e_arrows);
@@ -428,6 +430,13 @@ static void xdot_end_graph(graph_t* g)
 
 typedef int (*putstrfn) (void *chan, const char *str);
 typedef int (*flushfn) (void *chan);
+
+/* agwritebin passes the job it was given back as a void pointer */
+static size_t gvb_write(void *chan, const char *s, size_t n)
+{
+    return gvwrite(chan, s, n);
+}
+
 static void dot_end_graph(GVJ_t *job)
 {
     graph_t *g = job->obj->u.g;
@@ -461,6 +470,11 @@ static void dot_end_graph(GVJ_t *job)
 	    if (!(job->flags & OUTPUT_NOT_REQUIRED))
 		agwrite(g, job);
 	    break;
+	case FORMAT_GVB:
+	    xdot_end_graph(g);
+	    if (!(job->flags & OUTPUT_NOT_REQUIRED))
+		agwritebin(g, job, gvb_write);
+	    break;
 	default:
 	    UNREACHABLE();
     }
@@ -764,5 +778,6 @@ gvplugin_installed_t gvdevice_dot_types[] = {
     {FORMAT_XDOT, "xdot:xdot", 1, NULL, &device_features_dot},
     {FORMAT_XDOT12, "xdot1.2:xdot", 1, NULL, &device_features_dot},
     {FORMAT_XDOT14, "xdot1.4:xdot", 1, NULL, &device_features_dot},
+    {FORMAT_GVB, "gvb:xdot", 1, NULL, &device_features_dot},
     {0, NULL, 0, NULL, NULL}
 };
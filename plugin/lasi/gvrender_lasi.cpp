@@ -25,6 +25,7 @@
 
 #include <gvc/gvplugin_render.h>
 #include <gvc/gvplugin_device.h>
+#include <gvc/gvplugin_textlayout.h>
 #include <gvc/gvio.h>
 #include <gvc/gvcint.h>
 #include <cgraph/agxbuf.h>
@@ -334,6 +335,11 @@ static void lasi_textspan(GVJ_t * job, pointf p, textspan_t * span)
     if (job->obj->pencolor.u.HSVA[3] < .5)
 	return; // skip transparent text
 
+    // spans measured from the text size cache carry no layout
+    gvtextlayout_engine_t *gvte = job->gvc->textlayout.engine;
+    if (!span->layout && gvte && gvte->textlayout)
+	gvte->textlayout(span, nullptr);
+
     if (span->layout) {
 	pango_font = pango_layout_get_font_description((PangoLayout*)(span->layout));
 	font = pango_font_description_get_family(pango_font);
@@ -1 +1,9 @@
+#pragma once
+
+#include <stdbool.h>
+#include <common/geom.h>
+#include <common/textspan.h>
+
 #define FONT_DPI 96.
+
+bool pango_textlayout(textspan_t *span, char **fontpath);
@@ -295,6 +295,12 @@ static void cairogen_textspan(GVJ_t * job, pointf p, textspan_t * span)
     cairo_t *cr = job->context;
     pointf A[2];
 
+    /* spans measured from the text size cache carry no layout */
+    if (span->layout == NULL)
+	pango_textlayout(span, NULL);
+    if (span->layout == NULL)
+	return;
+
     cairo_set_dash (cr, dashed, 0, 0.0);  /* clear any dashing */
     cairogen_set_color(cr, &obj->pencolor);
 
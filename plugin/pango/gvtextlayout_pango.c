@@ -20,6 +20,7 @@
 #include <cgraph/alloc.h>
 #include <common/utils.h>
 #include <gvc/gvplugin_textlayout.h>
+#include "gvplugin_pango.h"
 
 #include <pango/pangocairo.h>
 #include "gvgetfontlist.h"
@@ -32,24 +33,17 @@ static void pango_free_layout (void *layout)
     g_object_unref(layout);
 }
 
-static char* pango_psfontResolve (PostscriptAlias* pa)
+static char *pango_psfontResolve(const PostscriptAlias *pa)
 {
-    static char buf[1024];
-    strcpy(buf, pa->family);
-    strcat(buf, ",");
-    if (pa->weight) {
-        strcat(buf, " ");
-        strcat(buf, pa->weight);
-    }
-    if (pa->stretch) {
-        strcat(buf, " ");
-        strcat(buf, pa->stretch);
-    }
-    if (pa->style) {
-        strcat(buf, " ");
-        strcat(buf, pa->style);
-    }
-    return buf;
+    agxbuf buf = {0};
+    agxbprint(&buf, "%s,", pa->family);
+    if (pa->weight)
+        agxbprint(&buf, " %s", pa->weight);
+    if (pa->stretch)
+        agxbprint(&buf, " %s", pa->stretch);
+    if (pa->style)
+        agxbprint(&buf, " %s", pa->style);
+    return agxbdisown(&buf);
 }
 
 #define FONT_DPI 96.
@@ -64,128 +58,204 @@ static int agxbput_int(void *buffer, const char *s) {
   return (int)len;
 }
 
-static bool pango_textlayout(textspan_t * span, char **fontpath)
+/// Pango state owned by a single thread
+///
+/// Pango font maps and contexts must not be used from more than one thread, so
+/// each thread doing text layout creates its own on first use.
+typedef struct {
+    PangoFontMap *fontmap;
+    PangoContext *context;
+    char buf[1024];  /* returned in fontpath, only good until next call */
+} pango_state_t;
+
+static void pango_state_free(void *state)
 {
-    static char buf[1024];  /* returned in fontpath, only good until next call */
-    static PangoFontMap *fontmap;
-    static PangoContext *context;
-    static PangoFontDescription *desc;
-    static char *fontname;
-    static double fontsize;
-    static gv_font_map* gv_fmap;
-    char *fnt, *psfnt = NULL;
-    PangoLayout *layout;
-    PangoRectangle logical_rect;
-    cairo_font_options_t* options;
-    PangoFont *font;
-#ifdef ENABLE_PANGO_MARKUP
-    PangoAttrList *attrs;
-    GError *error = NULL;
-    int flags;
-#endif
-    char *text;
-    double textlayout_scale;
-    PostscriptAlias *pA;
-
-    if (!context) {
-	fontmap = pango_cairo_font_map_new();
-	gv_fmap = get_font_mapping(fontmap);
-	context = pango_font_map_create_context (fontmap);
-	options=cairo_font_options_create();
-	cairo_font_options_set_antialias(options,CAIRO_ANTIALIAS_GRAY);
-	cairo_font_options_set_hint_style(options,CAIRO_HINT_STYLE_FULL);
-	cairo_font_options_set_hint_metrics(options,CAIRO_HINT_METRICS_ON);
-	cairo_font_options_set_subpixel_order(options,CAIRO_SUBPIXEL_ORDER_BGR);
-	pango_cairo_context_set_font_options(context, options);
-	pango_cairo_context_set_resolution(context, FONT_DPI);
-	cairo_font_options_destroy(options);
-	g_object_unref(fontmap);
-    }
+    pango_state_t *st = state;
+    g_object_unref(st->context);
+    free(st);
+}
 
-    if (!fontname || strcmp(fontname, span->font->name) != 0 || fontsize != span->font->size) {
+static GPrivate pango_state = G_PRIVATE_INIT(pango_state_free);
 
-	/* check if the conversion to Pango units below will overflow */
-	if ((double)(G_MAXINT / PANGO_SCALE) < span->font->size) {
-	    return false;
-	}
+/* Postscript to Pango font mapping, computed by the first thread to need it */
+static gv_font_map *gv_fmap;
+G_LOCK_DEFINE_STATIC(gv_fmap);
 
-	free(fontname);
-	fontname = gv_strdup(span->font->name);
-	fontsize = span->font->size;
-	pango_font_description_free (desc);
+/// font descriptions keyed by size and font name, shared by all threads
+///
+/// Descriptions are never modified or removed once inserted, and Pango copies
+/// them into each layout, so they may be used without holding the lock.
+static GHashTable *descs;
+G_LOCK_DEFINE_STATIC(descs);
 
-	pA = span->font->postscript_alias;
-	if (pA) {
-	    psfnt = fnt = gv_fmap[pA->xfig_code].gv_font;
-	    if(!psfnt)
-		psfnt = fnt = pango_psfontResolve (pA);
-	}
-	else
-	    fnt = fontname;
-
-	desc = pango_font_description_from_string(fnt);
-        /* all text layout is done at a scale of FONT_DPI (nominaly 96.) */
-        pango_font_description_set_size (desc, (gint)(fontsize * PANGO_SCALE));
+static pango_state_t *get_pango_state(void)
+{
+    cairo_font_options_t* options;
+    pango_state_t *st = g_private_get(&pango_state);
+
+    if (st)
+	return st;
+
+    st = gv_alloc(sizeof(pango_state_t));
+    st->fontmap = pango_cairo_font_map_new();
+    G_LOCK(gv_fmap);
+    if (!gv_fmap)
+	gv_fmap = get_font_mapping(st->fontmap);
+    G_UNLOCK(gv_fmap);
+    st->context = pango_font_map_create_context (st->fontmap);
+    options=cairo_font_options_create();
+    cairo_font_options_set_antialias(options,CAIRO_ANTIALIAS_GRAY);
+    cairo_font_options_set_hint_style(options,CAIRO_HINT_STYLE_FULL);
+    cairo_font_options_set_hint_metrics(options,CAIRO_HINT_METRICS_ON);
+    cairo_font_options_set_subpixel_order(options,CAIRO_SUBPIXEL_ORDER_BGR);
+    pango_cairo_context_set_font_options(st->context, options);
+    pango_cairo_context_set_resolution(st->context, FONT_DPI);
+    cairo_font_options_destroy(options);
+    g_object_unref(st->fontmap); /* the context keeps it alive */
+    g_private_set(&pango_state, st);
+    return st;
+}
 
-        if (fontpath && (font = pango_font_map_load_font(fontmap, context, desc))) {  /* -v support */
-	    const char *fontclass;
+/// the Pango font family string for a font
+///
+/// @param psfnt [out] Whether the name was resolved from a Postscript alias
+/// @return A string the caller must free
+static char *pango_fontname(const textfont_t *tf, bool *psfnt)
+{
+    const PostscriptAlias *pA = tf->postscript_alias;
+
+    *psfnt = pA != NULL;
+    if (!pA)
+	return gv_strdup(tf->name);
+    if (gv_fmap[pA->xfig_code].gv_font)
+	return gv_strdup(gv_fmap[pA->xfig_code].gv_font);
+    return pango_psfontResolve(pA);
+}
 
-	    fontclass = G_OBJECT_CLASS_NAME(G_OBJECT_GET_CLASS(font));
+static PangoFontDescription *pango_fontdesc(const textfont_t *tf)
+{
+    agxbuf key = {0};
+    agxbprint(&key, "%.17g %s", tf->size, tf->name);
+    char *k = agxbdisown(&key);
+
+    G_LOCK(descs);
+    if (!descs)
+	descs = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+	                              (GDestroyNotify)pango_font_description_free);
+    PangoFontDescription *desc = g_hash_table_lookup(descs, k);
+    if (desc) {
+	free(k);
+    } else {
+	bool psfnt;
+	char *fnt = pango_fontname(tf, &psfnt);
+	desc = pango_font_description_from_string(fnt);
+	/* all text layout is done at a scale of FONT_DPI (nominaly 96.) */
+	pango_font_description_set_size (desc, (gint)(tf->size * PANGO_SCALE));
+	free(fnt);
+	g_hash_table_insert(descs, k, desc);
+    }
+    G_UNLOCK(descs);
+    return desc;
+}
 
-	    buf[0] = '\0';
-	    if (psfnt) {
-		strcat(buf, "(ps:pango  ");
-		strcat(buf, psfnt);
-		strcat(buf, ") ");
-	    }
-	    strcat(buf, "(");
-	    strcat(buf, fontclass);
-	    strcat(buf, ") ");
+/// describe the font Pango actually picked, for -v
+static void pango_fontpath(pango_state_t *st, const textfont_t *tf,
+                           PangoFontDescription *desc, char **fontpath)
+{
+    char *buf = st->buf;
+    PangoFont *font = pango_font_map_load_font(st->fontmap, st->context, desc);
+    const char *fontclass;
+    bool psfnt;
+    char *fnt;
+
+    if (!font)
+	return;
+
+    fontclass = G_OBJECT_CLASS_NAME(G_OBJECT_GET_CLASS(font));
+
+    buf[0] = '\0';
+    fnt = pango_fontname(tf, &psfnt);
+    if (psfnt) {
+	strcat(buf, "(ps:pango  ");
+	strcat(buf, fnt);
+	strcat(buf, ") ");
+    }
+    free(fnt);
+    strcat(buf, "(");
+    strcat(buf, fontclass);
+    strcat(buf, ") ");
 #ifdef HAVE_PANGO_FC_FONT_LOCK_FACE
-	    if (strcmp(fontclass, "PangoCairoFcFont") == 0) {
-	        FT_Face face;
-	        PangoFcFont *fcfont;
-	        FT_Stream stream;
-	        FT_StreamDesc streamdesc;
-	        fcfont = PANGO_FC_FONT(font);
-	        face = pango_fc_font_lock_face(fcfont);
-	        if (face) {
-		    strcat(buf, "\"");
-		    strcat(buf, face->family_name);
-		    strcat(buf, ", ");
-		    strcat(buf, face->style_name);
-		    strcat(buf, "\" ");
-
-		    stream = face->stream;
-		    if (stream) {
-			streamdesc = stream->pathname;
-			if (streamdesc.pointer)
-			    strcat(buf, (char*)streamdesc.pointer);
-		        else
-			    strcat(buf, "*no pathname available*");
-		    }
-		    else
-			strcat(buf, "*no stream available*");
-		}
-	        pango_fc_font_unlock_face(fcfont);
+    if (strcmp(fontclass, "PangoCairoFcFont") == 0) {
+        FT_Face face;
+        PangoFcFont *fcfont;
+        FT_Stream stream;
+        FT_StreamDesc streamdesc;
+        fcfont = PANGO_FC_FONT(font);
+        face = pango_fc_font_lock_face(fcfont);
+        if (face) {
+	    strcat(buf, "\"");
+	    strcat(buf, face->family_name);
+	    strcat(buf, ", ");
+	    strcat(buf, face->style_name);
+	    strcat(buf, "\" ");
+
+	    stream = face->stream;
+	    if (stream) {
+		streamdesc = stream->pathname;
+		if (streamdesc.pointer)
+		    strcat(buf, (char*)streamdesc.pointer);
+	        else
+		    strcat(buf, "*no pathname available*");
 	    }
 	    else
+		strcat(buf, "*no stream available*");
+	}
+        pango_fc_font_unlock_face(fcfont);
+    }
+    else
 #endif
-	    {
-    		PangoFontDescription *tdesc;
-		char *tfont;
-
-	        tdesc = pango_font_describe(font);
-	        tfont = pango_font_description_to_string(tdesc);
-	        strcat(buf, "\"");
-	        strcat(buf, tfont);
-	        strcat(buf, "\" ");
-	        g_free(tfont);
-	    }
-            *fontpath = buf;
-        }
+    {
+	PangoFontDescription *tdesc;
+	char *tfont;
+
+        tdesc = pango_font_describe(font);
+        tfont = pango_font_description_to_string(tdesc);
+        strcat(buf, "\"");
+        strcat(buf, tfont);
+        strcat(buf, "\" ");
+        g_free(tfont);
+        pango_font_description_free(tdesc);
+    }
+    g_object_unref(font);
+    *fontpath = buf;
+}
+
+bool pango_textlayout(textspan_t * span, char **fontpath)
+{
+    pango_state_t *st;
+    PangoFontDescription *desc;
+    PangoLayout *layout;
+    PangoRectangle logical_rect;
+#ifdef ENABLE_PANGO_MARKUP
+    PangoAttrList *attrs;
+    GError *error = NULL;
+    int flags;
+    char *markup_text = NULL;
+#endif
+    char *text;
+    double textlayout_scale;
+    bool rc;
+
+    /* check if the conversion to Pango units below will overflow */
+    if ((double)(G_MAXINT / PANGO_SCALE) < span->font->size) {
+	return false;
     }
 
+    st = get_pango_state();
+    desc = pango_fontdesc(span->font);
+    if (fontpath)  /* -v support */
+	pango_fontpath(st, span->font, desc, fontpath);
+
 #ifdef ENABLE_PANGO_MARKUP
     if ((span->font) && (flags = span->font->flags)) {
 	agxbuf xb = {0};
@@ -216,8 +286,11 @@ static bool pango_textlayout(textspan_t * span, char **fontpath)
 	    agxbput(&xb,"</sup>");
 
 	agxbput (&xb,"</span>");
-	if (!pango_parse_markup (agxbuse(&xb), -1, 0, &attrs, &text, NULL, &error)) {
+	if (pango_parse_markup (agxbuse(&xb), -1, 0, &attrs, &markup_text, NULL, &error)) {
+	    text = markup_text;
+	} else {
 	    fprintf (stderr, "Error - pango_parse_markup: %s\n", error->message);
+	    g_error_free(error);
 	    text = span->str;
 	    attrs = NULL;
 	}
@@ -231,15 +304,17 @@ static bool pango_textlayout(textspan_t * span, char **fontpath)
     text = span->str;
 #endif
 
-    layout = pango_layout_new (context);
+    layout = pango_layout_new (st->context);
     span->layout = layout;    /* layout free with textspan - see labels.c */
     span->free_layout = pango_free_layout;    /* function for freeing pango layout */
 
     pango_layout_set_text (layout, text, -1);
     pango_layout_set_font_description (layout, desc);
 #ifdef ENABLE_PANGO_MARKUP
-    if (attrs)
+    if (attrs) {
 	pango_layout_set_attributes (layout, attrs);
+	pango_attr_list_unref (attrs);
+    }
 #endif
 
     pango_layout_get_extents (layout, NULL, &logical_rect);
@@ -258,7 +333,11 @@ static bool pango_textlayout(textspan_t * span, char **fontpath)
     /* The distance below midline for y centering of text strings */
     span->yoffset_centerline = 0.05 * span->font->size;
 
-    return logical_rect.width != 0 || strcmp(text, "") == 0;
+    rc = logical_rect.width != 0 || strcmp(text, "") == 0;
+#ifdef ENABLE_PANGO_MARKUP
+    g_free(markup_text);
+#endif
+    return rc;
 }
 
 static gvtextlayout_engine_t pango_textlayout_engine = {
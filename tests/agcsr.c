@@ -0,0 +1,49 @@
+/* test case for compressed sparse row snapshots (see
+ * test_misc.py:test_agcsr())
+ */
+
+#include <assert.h>
+#include <graphviz/cgraph.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(void) {
+  Agraph_t *g = agmemread("digraph { a -> b [weight=2]; a -> c; c -> a; "
+                          "b -> b [weight=oops]; subgraph s { b; c } }");
+  assert(g != NULL);
+
+  Agcsr_t *csr = agcsr(g);
+  assert(csr->nnodes == 3);
+  assert(csr->nedges == 4);
+
+  Agsym_t *weight = agattr(g, AGEDGE, "weight", NULL);
+  double *w = agcsrvalues(csr, weight, 1);
+
+  for (size_t i = 0; i < csr->nnodes; ++i) {
+    assert(agcsrindex(csr, csr->nodes[i]) == i);
+    printf("%s:", agnameof(csr->nodes[i]));
+    for (size_t x = csr->out_offset[i]; x < csr->out_offset[i + 1]; ++x) {
+      assert(agtail(csr->out_edges[x]) == csr->nodes[i]);
+      printf(" ->%s/%g", agnameof(csr->nodes[csr->out_head[x]]), w[x]);
+    }
+    for (size_t x = csr->in_offset[i]; x < csr->in_offset[i + 1]; ++x) {
+      assert(aghead(csr->in_edges[x]) == csr->nodes[i]);
+      printf(" <-%s", agnameof(csr->nodes[csr->in_tail[x]]));
+    }
+    printf("\n");
+  }
+  free(w);
+
+  // a subgraph gets its own numbering, and knows nothing of other nodes
+  Agraph_t *s = agsubg(g, "s", 0);
+  Agcsr_t *sub = agcsr(s);
+  assert(sub->nnodes == 2);
+  assert(agcsrindex(sub, agnode(g, "a", 0)) == SIZE_MAX);
+  assert(agcsrindex(sub, agnode(g, "c", 0)) == 1);
+  agcsrfree(sub);
+
+  agcsrfree(csr);
+  agclose(g);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+/* test case for cached numeric conversion of strings (see
+ * test_misc.py:test_agstrtod())
+ */
+
+#include <assert.h>
+#include <graphviz/cgraph.h>
+#include <stdio.h>
+
+/// print the conversions of a reference-counted string
+static void convert(const char *s) {
+  double d = 0;
+  long l = 0;
+  const bool d_ok = agstrtod(s, &d);
+  const bool l_ok = agstrtol(s, &l);
+
+  // converting again is answered from the cache, with the same result
+  double d2 = 0;
+  long l2 = 0;
+  assert(agstrtod(s, &d2) == d_ok && d2 == d);
+  assert(agstrtol(s, &l2) == l_ok && l2 == l);
+
+  printf("\"%s\":", s);
+  if (d_ok)
+    printf(" %g", d);
+  else
+    printf(" not a double");
+  if (l_ok)
+    printf(" %ld", l);
+  else
+    printf(" not a long");
+  printf("\n");
+}
+
+int main(void) {
+  Agraph_t *g = agopen("g", Agdirected, NULL);
+  assert(g != NULL);
+
+  char *invalid = agstrdup(g, "oops");
+  char *empty = agstrdup(g, "");
+  char *number = agstrdup(g, "2.5");
+  convert(invalid);
+  convert(empty);
+  convert(number);
+  agstrfree(g, invalid);
+  agstrfree(g, empty);
+  agstrfree(g, number);
+
+  // a new value is parsed afresh, while the default keeps its own result
+  Agsym_t *width = agattr(g, AGNODE, "width", "0.75");
+  Agnode_t *n = agnode(g, "n", 1);
+  convert(agxget(n, width));
+  agxset(n, width, "3");
+  convert(agxget(n, width));
+  agxset(n, width, "wide");
+  convert(agxget(n, width));
+  convert(width->defval);
+
+  agclose(g);
+  return 0;
+}
@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+
+"""
+Graphviz layout and rendering benchmarks
+
+This generates a corpus of graph families at several sizes with gvgen, lays
+each out with every layout engine and renders it to the major output formats,
+and records wall clock time, processor time, peak resident set size and the
+per phase spans of `--trace`. Results are written as JSON, for comparison
+across builds and over time.
+
+The corpus is reproducible: gvgen is seeded, and the same seed gives the same
+graphs on every platform.
+"""
+
+import argparse
+import datetime
+import json
+import math
+import os
+import platform
+import random
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+ENGINES = ("dot", "neato", "sfdp", "fdp", "circo", "twopi", "osage", "patchwork")
+"""layout engines to time"""
+
+FORMATS = ("svg", "png", "pdf", "ps", "json", "xdot")
+"""output formats to time rendering to"""
+
+FAMILIES = ("grid", "tree", "powerlaw", "dag", "clustered")
+"""graph families in the corpus"""
+
+
+class Gvgen:
+    """generator of the corpus graphs, backed by gvgen"""
+
+    def __init__(self, gvgen: Path, seed: int):
+        self.gvgen = gvgen
+        self.seed = seed
+
+    def run(self, *args: str) -> str:
+        """run gvgen with the corpus seed"""
+        return subprocess.check_output(
+            [self.gvgen, f"-z{self.seed}", *args], universal_newlines=True
+        )
+
+    def generate(self, family: str, size: int) -> str:
+        """DOT source of a graph of the given family with about `size` nodes"""
+
+        if family == "grid":
+            side = max(2, round(math.sqrt(size)))
+            return self.run(f"-g{side},{side}")
+
+        if family == "tree":
+            # a ternary tree of the height giving the closest node count
+            height = max(1, round(math.log(2 * size + 1, 3)) - 1)
+            return self.run(f"-t{height},3")
+
+        if family == "powerlaw":
+            return self.run(f"-a{max(3, size)},2")
+
+        if family == "dag":
+            return self.run("-d", f"-A{max(3, size)},{max(2, size * 3 // 2)}")
+
+        if family == "clustered":
+            # power law clusters, joined by a few random edges between them
+            clusters = max(2, round(math.sqrt(size) / 2))
+            per_cluster = max(3, size // clusters)
+            rng = random.Random(self.seed)
+            lines = ["graph {"]
+            for i in range(clusters):
+                seed = self.seed + i
+                body = subprocess.check_output(
+                    [self.gvgen, f"-z{seed}", f"-nc{i}_", f"-a{per_cluster},2"],
+                    universal_newlines=True,
+                )
+                lines.append(f"  subgraph cluster_{i} {{")
+                lines += body.splitlines()[1:-1]
+                lines.append("  }")
+            for i in range(clusters):
+                j = rng.randrange(clusters - 1)
+                j += j >= i
+                a = rng.randrange(per_cluster) + 1
+                b = rng.randrange(per_cluster) + 1
+                lines.append(f"  c{i}_{a} -- c{j}_{b}")
+            lines.append("}")
+            return "\n".join(lines) + "\n"
+
+        raise ValueError(f"unknown graph family {family}")
+
+
+def graph_size(source: str) -> Tuple[int, int]:
+    """count the nodes and edges of gvgen-style DOT"""
+    nodes = set()
+    edges = 0
+    for line in source.splitlines():
+        words = line.split()
+        if len(words) == 3 and words[1] in ("--", "->"):
+            nodes.update((words[0], words[2]))
+            edges += 1
+        elif len(words) == 1 and words[0] not in ("{", "}"):
+            nodes.add(words[0])
+    return len(nodes), edges
+
+
+class Run:
+    """outcome of running one command"""
+
+    def __init__(self):
+        self.status = "ok"
+        self.wall: float = 0
+        self.cpu: Optional[float] = None
+        self.peak_rss_kib: Optional[int] = None
+        self.stderr = ""
+
+
+def run(args: List[str], timeout: float) -> Run:
+    """run a command, measuring its time and peak memory use"""
+
+    result = Run()
+    with tempfile.TemporaryFile() as err:
+        start = time.perf_counter()
+        proc = subprocess.Popen(
+            args, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=err
+        )
+        timer = threading.Timer(timeout, proc.kill)
+        timer.start()
+        try:
+            if hasattr(os, "wait4"):
+                _, status, usage = os.wait4(proc.pid, 0)
+                proc.returncode = os.waitstatus_to_exitcode(status)
+                result.cpu = usage.ru_utime + usage.ru_stime
+                # ru_maxrss is in bytes on macOS and KiB elsewhere
+                rss = usage.ru_maxrss
+                result.peak_rss_kib = rss // 1024 if sys.platform == "darwin" else rss
+            else:
+                proc.wait()
+        finally:
+            result.wall = time.perf_counter() - start
+            killed = not timer.is_alive()
+            timer.cancel()
+        err.seek(0)
+        result.stderr = err.read().decode("utf-8", "replace")
+
+    if killed:
+        result.status = "timeout"
+    elif proc.returncode != 0:
+        result.status = "error"
+    return result
+
+
+def read_trace(path: Path) -> Dict[str, Dict]:
+    """flatten a JSON trace into per phase wall times and counters"""
+    phases: Dict[str, Dict] = {}
+
+    def visit(span: Dict, prefix: str):
+        name = prefix + span["name"]
+        # phases that run more than once, like parse, are summed
+        phase = phases.setdefault(name, {"wall": 0.0, "cpu": 0.0, "counters": {}})
+        phase["wall"] += span["wall"]
+        phase["cpu"] += span["cpu"]
+        for counter, value in span["counters"].items():
+            phase["counters"][counter] = phase["counters"].get(counter, 0) + value
+        for child in span["children"]:
+            visit(child, f"{name}/")
+
+    try:
+        for span in json.loads(path.read_text())["spans"]:
+            visit(span, "")
+    except (OSError, ValueError, KeyError):
+        return {}
+    return phases
+
+
+def measure(
+    args: List[str], repeat: int, timeout: float, trace: Optional[Path]
+) -> Dict:
+    """run a command repeatedly, summarizing its measurements"""
+
+    if trace is not None:
+        args = args + [f"--trace={trace}", "--trace-format=json"]
+
+    walls: List[float] = []
+    cpus: List[float] = []
+    rss: List[int] = []
+    phases: Dict[str, Dict] = {}
+    for _ in range(repeat):
+        r = run(args, timeout)
+        if r.status != "ok":
+            error = r.stderr.strip().splitlines()[-1] if r.stderr.strip() else ""
+            if "not recognized" in error:
+                return {"status": "unsupported", "error": error}
+            return {"status": r.status, "error": error}
+        walls.append(r.wall)
+        if r.cpu is not None:
+            cpus.append(r.cpu)
+        if r.peak_rss_kib is not None:
+            rss.append(r.peak_rss_kib)
+        if trace is not None:
+            phases = read_trace(trace)
+
+    return {
+        "status": "ok",
+        "wall": walls,
+        "wall_median": statistics.median(walls),
+        "cpu_median": statistics.median(cpus) if cpus else None,
+        "peak_rss_kib": max(rss) if rss else None,
+        "phases": phases,
+    }
+
+
+def progress(label: str, measurement: Dict):
+    """report a measurement as it is made"""
+    if measurement["status"] == "ok":
+        result = f"{measurement['wall_median']:.3f}s"
+    else:
+        result = measurement["status"]
+    sys.stderr.write(f"  {label}: {result}\n")
+
+
+def find_tool(name: str, bin_dir: Optional[Path]) -> Optional[Path]:
+    """locate a Graphviz program"""
+    found = shutil.which(name, path=str(bin_dir) if bin_dir else None)
+    return Path(found) if found else None
+
+
+def main(args: List[str]) -> int:  # pylint: disable=missing-function-docstring
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument(
+        "--bin-dir", type=Path, help="directory of the Graphviz programs (PATH)"
+    )
+    parser.add_argument(
+        "--corpus", type=Path, help="directory to write the generated graphs to"
+    )
+    parser.add_argument(
+        "--sizes",
+        type=lambda s: [int(x) for x in s.split(",")],
+        default=[100, 1000],
+        help="approximate node counts of the generated graphs (100,1000)",
+    )
+    parser.add_argument(
+        "--families",
+        type=lambda s: s.split(","),
+        default=list(FAMILIES),
+        help=f"graph families ({','.join(FAMILIES)})",
+    )
+    parser.add_argument(
+        "--engines",
+        type=lambda s: s.split(","),
+        default=list(ENGINES),
+        help=f"layout engines ({','.join(ENGINES)})",
+    )
+    parser.add_argument(
+        "--formats",
+        type=lambda s: s.split(",") if s else [],
+        default=list(FORMATS),
+        help=f"output formats to time rendering to ({','.join(FORMATS)})",
+    )
+    parser.add_argument("--repeat", type=int, default=3, help="runs of each case")
+    parser.add_argument(
+        "--timeout", type=float, default=600, help="seconds before a run is abandoned"
+    )
+    parser.add_argument("--seed", type=int, default=1, help="corpus seed")
+    parser.add_argument(
+        "--no-trace",
+        action="store_true",
+        help="do not record phases, for Graphviz versions without --trace",
+    )
+    parser.add_argument(
+        "--output", type=Path, help="file to write the results to (stdout)"
+    )
+    options = parser.parse_args(args[1:])
+
+    gvgen = find_tool("gvgen", options.bin_dir)
+    if gvgen is None:
+        sys.stderr.write("gvgen not found\n")
+        return 1
+    generator = Gvgen(gvgen, options.seed)
+
+    dot = find_tool("dot", options.bin_dir)
+    version = (
+        subprocess.run(
+            [dot, "-V"], stderr=subprocess.PIPE, universal_newlines=True, check=False
+        ).stderr.strip()
+        if dot
+        else None
+    )
+
+    results = []
+    with tempfile.TemporaryDirectory() as tmp:
+        corpus = options.corpus or Path(tmp)
+        corpus.mkdir(parents=True, exist_ok=True)
+        trace = None if options.no_trace else Path(tmp) / "trace.json"
+
+        for family in options.families:
+            for size in options.sizes:
+                source = generator.generate(family, size)
+                graph = corpus / f"{family}_{size}.gv"
+                graph.write_text(source)
+                nodes, edges = graph_size(source)
+                case = {"family": family, "size": size, "nodes": nodes, "edges": edges}
+                sys.stderr.write(f"{family} {size}: {nodes} nodes, {edges} edges\n")
+
+                for engine in options.engines:
+                    exe = find_tool(engine, options.bin_dir)
+                    if exe is None:
+                        continue
+                    m = measure(
+                        [exe, "-Tdot", "-o", os.devnull, graph],
+                        options.repeat,
+                        options.timeout,
+                        trace,
+                    )
+                    results.append({"kind": "layout", "engine": engine, **case, **m})
+                    progress(engine, m)
+
+                # time rendering alone, from a dot layout given to neato -n2
+                neato = find_tool("neato", options.bin_dir)
+                if dot is None or neato is None or not options.formats:
+                    continue
+                laid_out = corpus / f"{family}_{size}.xdot"
+                r = run([dot, "-Txdot", "-o", laid_out, graph], options.timeout)
+                if r.status != "ok":
+                    continue
+                for fmt in options.formats:
+                    m = measure(
+                        [neato, "-n2", f"-T{fmt}", "-o", os.devnull, laid_out],
+                        options.repeat,
+                        options.timeout,
+                        trace,
+                    )
+                    results.append({"kind": "render", "format": fmt, **case, **m})
+                    progress(f"-T{fmt}", m)
+
+    report = {
+        "graphviz": version,
+        "platform": platform.platform(),
+        "machine": platform.machine(),
+        "date": datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        "seed": options.seed,
+        "repeat": options.repeat,
+        "results": results,
+    }
+    text = json.dumps(report, indent=2, default=str) + "\n"
+    if options.output:
+        options.output.write_text(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,122 @@
+/* test case for the flat hash set method of cdt (see
+ * test_misc.py:test_dtfset())
+ */
+
+#include <assert.h>
+#include <graphviz/cdt.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+  Dtlink_t link;
+  int key;
+} item_t;
+
+static int freed;
+
+static void item_free(void *item, Dtdisc_t *disc) {
+  (void)disc;
+  free(item);
+  ++freed;
+}
+
+static int item_cmp(Dt_t *d, void *a, void *b, Dtdisc_t *disc) {
+  (void)d;
+  (void)disc;
+  const int x = *(int *)a;
+  const int y = *(int *)b;
+  return x < y ? -1 : x > y;
+}
+
+static Dtdisc_t disc = {
+    .key = offsetof(item_t, key),
+    .size = sizeof(int),
+    .link = offsetof(item_t, link),
+    .freef = item_free,
+    .comparf = item_cmp,
+};
+
+enum { N = 10000 };
+
+/// count objects by walking the dictionary
+static int walk(Dt_t *d) {
+  int n = 0;
+  for (item_t *i = dtfirst(d); i != NULL; i = dtnext(d, i))
+    ++n;
+  int m = 0;
+  for (item_t *i = dtlast(d); i != NULL; i = dtprev(d, i))
+    ++m;
+  assert(n == m);
+  return n;
+}
+
+int main(void) {
+  Dt_t *d = dtopen(&disc, Dtfset);
+  assert(d != NULL);
+
+  for (int k = 0; k < N; ++k) {
+    item_t *i = calloc(1, sizeof(*i));
+    assert(i != NULL);
+    i->key = k;
+    assert(dtinsert(d, i) == i);
+  }
+
+  // inserting a duplicate key returns the existing object
+  item_t dup = {.key = 42};
+  item_t *found = dtinsert(d, &dup);
+  assert(found != NULL && found != &dup && found->key == 42);
+  printf("size %d walk %d\n", dtsize(d), walk(d));
+
+  // delete the odd keys
+  for (int k = 1; k < N; k += 2) {
+    item_t *i = dtmatch(d, &k);
+    assert(i != NULL && i->key == k);
+    dtdelete(d, i);
+  }
+  for (int k = 0; k < N; ++k) {
+    item_t *i = dtmatch(d, &k);
+    assert((i != NULL) == (k % 2 == 0));
+  }
+  printf("size %d walk %d freed %d\n", dtsize(d), walk(d), freed);
+
+  // reinsert into slots freed by deletion
+  for (int k = 1; k < N; k += 2) {
+    item_t *i = calloc(1, sizeof(*i));
+    assert(i != NULL);
+    i->key = k;
+    assert(dtinsert(d, i) == i);
+  }
+  printf("size %d walk %d\n", dtsize(d), walk(d));
+
+  // renew an object under a new key
+  int k = 7;
+  item_t *i = dtmatch(d, &k);
+  assert(i != NULL);
+  i->key = N;
+  assert(dtrenew(d, i) == i);
+  assert(dtmatch(d, &k) == NULL);
+  k = N;
+  assert(dtmatch(d, &k) == i);
+
+  // round trip through an ordered set
+  dtmethod(d, Dtoset);
+  item_t *first = dtfirst(d);
+  printf("ordered first %d last %d\n", first->key, ((item_t *)dtlast(d))->key);
+  dtmethod(d, Dtfset);
+  printf("size %d walk %d\n", dtsize(d), walk(d));
+
+  // extract and restore
+  Dtlink_t *list = dtextract(d);
+  assert(dtsize(d) == 0);
+  assert(dtmatch(d, &k) == NULL);
+  dtrestore(d, list);
+  assert(dtmatch(d, &k) == i);
+  printf("size %d walk %d\n", dtsize(d), walk(d));
+
+  freed = 0;
+  dtclose(d);
+  printf("freed %d\n", freed);
+
+  return 0;
+}
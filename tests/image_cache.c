@@ -0,0 +1,51 @@
+/* test case for bounding the decoded image cache (see
+ * test_misc.py:test_image_cache())
+ */
+
+#include <assert.h>
+#include <graphviz/cgraph.h>
+#include <graphviz/gvc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *render(GVC_t *gvc, Agraph_t *g) {
+  char *result = NULL;
+  unsigned int length = 0;
+  assert(gvRenderData(gvc, g, "ps", &result, &length) == 0);
+  assert(result != NULL);
+  return result;
+}
+
+int main(void) {
+  GVC_t *gvc = gvContext();
+  assert(gvc != NULL);
+
+  Agraph_t *g = agread(stdin, NULL);
+  assert(g != NULL);
+  assert(gvLayout(gvc, g, "dot") == 0);
+
+  // render with every image kept in the cache
+  char *expected = render(gvc, g);
+  const size_t both = gvImageCacheSize();
+
+  // render again with room for no image, so each one evicts the other and is
+  // loaded again the next time it is drawn
+  gvSetImageCacheLimit(1);
+  for (int i = 0; i < 2; ++i) {
+    char *actual = render(gvc, g);
+    printf("%s\n", strcmp(expected, actual) == 0 ? "same" : "different");
+    gvFreeRenderData(actual);
+
+    // only the image drawn last is kept
+    const size_t one = gvImageCacheSize();
+    printf("%s\n", one > 0 && one < both ? "evicted" : "not evicted");
+  }
+
+  gvFreeRenderData(expected);
+  gvFreeLayout(gvc, g);
+  agclose(g);
+  gvFreeContext(gvc);
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+/* test case for incremental layout (see test_misc.py:test_layout_update())
+ */
+
+#include <assert.h>
+#include <graphviz/cgraph.h>
+#include <graphviz/gvc.h>
+#include <stdio.h>
+#include <string.h>
+
+/// keep a copy of the pos of each node and edge of g in its attribute "was"
+static void record(Agraph_t *g) {
+  for (Agnode_t *v = agfstnode(g); v != NULL; v = agnxtnode(g, v)) {
+    agsafeset(v, "was", agget(v, "pos"), "");
+    for (Agedge_t *e = agfstout(g, v); e != NULL; e = agnxtout(g, e))
+      agsafeset(e, "was", agget(e, "pos"), "");
+  }
+}
+
+/// is this node one of those passed to gvLayoutUpdate as changed?
+static int is_changed(Agnode_t *v, Agnode_t **changed, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if (changed[i] == v)
+      return 1;
+  }
+  return 0;
+}
+
+/// compare the pos of each node and edge of g with the recorded one,
+/// skipping those touching a changed node
+static void compare(Agraph_t *g, Agnode_t **changed, size_t nchanged) {
+  for (Agnode_t *v = agfstnode(g); v != NULL; v = agnxtnode(g, v)) {
+    if (is_changed(v, changed, nchanged))
+      continue;
+    printf("%s %s\n", agnameof(v),
+           strcmp(agget(v, "pos"), agget(v, "was")) == 0 ? "same pos"
+                                                         : "moved");
+    for (Agedge_t *e = agfstout(g, v); e != NULL; e = agnxtout(g, e)) {
+      if (is_changed(aghead(e), changed, nchanged))
+        continue;
+      printf("%s->%s %s\n", agnameof(agtail(e)), agnameof(aghead(e)),
+             strcmp(agget(e, "pos"), agget(e, "was")) == 0 ? "same pos"
+                                                           : "rerouted");
+    }
+  }
+}
+
+int main(void) {
+  GVC_t *gvc = gvContext();
+  assert(gvc != NULL);
+
+  Agraph_t *g = agmemread("digraph { a -> b -> c; a -> d -> c; b -> d }");
+  assert(g != NULL);
+
+  assert(gvLayout(gvc, g, "dot") == 0);
+  attach_attrs(g);
+
+  // record the first layout
+  record(g);
+
+  // with nothing changed, the nodes and edges keep their positions
+  assert(gvLayoutUpdate(gvc, g, "dot", NULL, 0) == 0);
+  attach_attrs(g);
+  compare(g, NULL, 0);
+
+  // the layout must be freed before the graph is edited
+  gvFreeLayout(gvc, g);
+
+  // add a node below a and lay out again
+  Agnode_t *a = agnode(g, "a", 0);
+  Agnode_t *e = agnode(g, "e", 1);
+  agedge(g, a, e, NULL, 1);
+  Agnode_t *changed[] = {a, e};
+  const size_t nchanged = sizeof(changed) / sizeof(changed[0]);
+
+  // give an edge between unchanged nodes a spline of our own, which a fresh
+  // layout would not produce
+  Agnode_t *c = agnode(g, "c", 0);
+  Agnode_t *d = agnode(g, "d", 0);
+  Agedge_t *dc = agedge(g, d, c, NULL, 0);
+  assert(dc != NULL);
+  agset(dc, "pos", "e,61,35 75,72 70,60 66,50 64,46");
+  agset(dc, "was", agget(dc, "pos"));
+
+  assert(gvLayoutUpdate(gvc, g, "dot", changed, nchanged) == 0);
+  attach_attrs(g);
+  printf("e %s\n", strcmp(agget(e, "pos"), "") != 0 ? "placed" : "missing");
+
+  // the other nodes and the edges between them are where they were
+  compare(g, changed, nchanged);
+
+  // swap two nodes of a rank, dropping the splines, and lay out again
+  gvFreeLayout(gvc, g);
+  Agnode_t *b = agnode(g, "b", 0);
+  char pos_b[64];
+  snprintf(pos_b, sizeof(pos_b), "%s", agget(b, "pos"));
+  agset(b, "pos", agget(e, "pos"));
+  agset(e, "pos", pos_b);
+  for (Agnode_t *v = agfstnode(g); v != NULL; v = agnxtnode(g, v)) {
+    for (Agedge_t *ve = agfstout(g, v); ve != NULL; ve = agnxtout(g, ve))
+      agset(ve, "pos", "");
+  }
+
+  // they keep the order they were given, which a fresh layout would undo
+  assert(gvLayoutUpdate(gvc, g, "dot", NULL, 0) == 0);
+  attach_attrs(g);
+  double xb, xe, y;
+  assert(sscanf(agget(b, "pos"), "%lf,%lf", &xb, &y) == 2);
+  assert(sscanf(agget(e, "pos"), "%lf,%lf", &xe, &y) == 2);
+  printf("b %s e\n", xb > xe ? "right of" : "left of");
+
+  gvFreeLayout(gvc, g);
+  agclose(g);
+  gvFreeContext(gvc);
+
+  return 0;
+}
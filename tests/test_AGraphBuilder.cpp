@@ -0,0 +1,313 @@
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <cgraph++/AGraph.h>
+#include <cgraph++/AGraphBuilder.h>
+
+/// write a graph as DOT into a string
+static std::string to_dot(Agraph_t *g) {
+  FILE *f = std::tmpfile();
+  REQUIRE(f != nullptr);
+  REQUIRE(agwrite(g, f) == 0);
+  std::rewind(f);
+  std::string dot;
+  for (int c; (c = std::getc(f)) != EOF;) {
+    dot += static_cast<char>(c);
+  }
+  std::fclose(f);
+  return dot;
+}
+
+TEST_CASE("A built graph is the same as one parsed from DOT source") {
+  for (const auto desc : {Agdirected, Agundirected}) {
+    CGraph::AGraphBuilder builder("G", desc);
+    builder.reserve(100, 300);
+    builder.set_graph_attr("rankdir", "LR");
+    const auto color = builder.declare_node_attr("color", "black");
+    const auto weight = builder.declare_edge_attr("weight", "1");
+    const auto red = builder.intern("red");
+    const auto two = builder.intern("2");
+
+    std::string dot = std::string(desc.directed ? "digraph" : "graph") +
+                      " G {\n  graph [rankdir=LR];\n"
+                      "  node [color=black];\n  edge [weight=1];\n";
+    const char *arrow = desc.directed ? " -> " : " -- ";
+    for (int i = 0; i < 100; ++i) {
+      const auto name = "n" + std::to_string(i);
+      REQUIRE(builder.add_node(name) == static_cast<std::size_t>(i));
+      dot += "  " + name;
+      if (i % 3 == 0) {
+        builder.set_node_attr(i, color, red);
+        dot += " [color=red]";
+      }
+      dot += ";\n";
+    }
+    unsigned x = 1;
+    for (int i = 0; i < 300; ++i) {
+      x = x * 1103515245u + 12345u;
+      const auto tail = (x >> 8) % 100;
+      x = x * 1103515245u + 12345u;
+      const auto head = (x >> 8) % 100;
+      REQUIRE(builder.add_edge(tail, head) == static_cast<std::size_t>(i));
+      dot += "  n" + std::to_string(tail) + arrow + "n" + std::to_string(head);
+      if (i % 5 == 0) {
+        builder.set_edge_attr(i, weight, two);
+        dot += " [weight=2]";
+      }
+      dot += ";\n";
+    }
+    dot += "}\n";
+
+    const auto built = builder.finish();
+    const CGraph::AGraph parsed{dot};
+    REQUIRE(agnnodes(built.c_struct()) == 100);
+    REQUIRE(agnedges(built.c_struct()) == 300);
+    REQUIRE(to_dot(built.c_struct()) == to_dot(parsed.c_struct()));
+  }
+}
+
+TEST_CASE("Adding a node name twice refers to the same node") {
+  CGraph::AGraphBuilder builder;
+  const auto a = builder.add_node("a");
+  const auto a2 = builder.add_node("a");
+  builder.add_edge(a, a2);
+  const auto g = builder.finish();
+  REQUIRE(agnnodes(g.c_struct()) == 1);
+  REQUIRE(agnedges(g.c_struct()) == 1);
+}
+
+TEST_CASE("Interned values are only stored once") {
+  CGraph::AGraphBuilder builder;
+  REQUIRE(builder.intern("red") == builder.intern(std::string("red")));
+  REQUIRE(builder.intern("red") != builder.intern("blue"));
+}
+
+TEST_CASE("Building a graph with unknown indices throws an exception") {
+  CGraph::AGraphBuilder builder;
+  const auto a = builder.add_node("a");
+  const auto attr = builder.declare_node_attr("color");
+  const auto red = builder.intern("red");
+  REQUIRE_THROWS_AS(builder.add_edge(a, a + 1), std::out_of_range);
+  REQUIRE_THROWS_AS(builder.set_node_attr(a + 1, attr, red), std::out_of_range);
+  REQUIRE_THROWS_AS(builder.set_node_attr(a, attr + 1, red), std::out_of_range);
+  REQUIRE_THROWS_AS(builder.set_edge_attr(0, 0, red), std::out_of_range);
+}
+
+TEST_CASE("A builder can be reused after finishing a graph") {
+  CGraph::AGraphBuilder builder("G");
+  builder.add_node("a");
+  const auto first = builder.finish();
+  builder.add_node("b");
+  builder.add_node("c");
+  const auto second = builder.finish();
+  REQUIRE(agnnodes(first.c_struct()) == 1);
+  REQUIRE(agnnodes(second.c_struct()) == 2);
+  REQUIRE(std::string(agnameof(second.c_struct())) == "G");
+}
+
+TEST_CASE("A builder can be moved before finishing a graph") {
+  static_assert(!std::is_copy_constructible_v<CGraph::AGraphBuilder>);
+  static_assert(!std::is_copy_assignable_v<CGraph::AGraphBuilder>);
+
+  auto builder = std::make_unique<CGraph::AGraphBuilder>("G");
+  const auto color = builder->declare_node_attr("color", "black");
+  const auto red = builder->intern("red");
+  const auto a = builder->add_node("a");
+  builder->set_node_attr(a, color, red);
+
+  // move away from the original and destroy it
+  CGraph::AGraphBuilder moved = std::move(*builder);
+  builder.reset();
+  CGraph::AGraphBuilder assigned;
+  assigned = std::move(moved);
+
+  const auto g = assigned.finish();
+  Agnode_t *n = agfstnode(g.c_struct());
+  REQUIRE(n != nullptr);
+  REQUIRE(std::string(agget(n, const_cast<char *>("color"))) == "red");
+}
+
+/// list the out and in edges of each node of a graph, in iteration order
+static std::string walk(Agraph_t *g) {
+  std::string s;
+  for (Agnode_t *n = agfstnode(g); n != nullptr; n = agnxtnode(g, n)) {
+    s += std::string(agnameof(n)) + " out:";
+    for (Agedge_t *e = agfstout(g, n); e != nullptr; e = agnxtout(g, e)) {
+      s += " " + std::string(agnameof(aghead(e))) + "#" +
+           std::to_string(AGSEQ(e));
+    }
+    s += " in:";
+    for (Agedge_t *e = agfstin(g, n); e != nullptr; e = agnxtin(g, e)) {
+      s += " " + std::string(agnameof(agtail(e))) + "#" +
+           std::to_string(AGSEQ(e));
+    }
+    s += " all:";
+    for (Agedge_t *e = agfstedge(g, n); e != nullptr; e = agnxtedge(g, e, n)) {
+      s += " " + std::to_string(AGSEQ(e));
+    }
+    s += "\n";
+  }
+  return s;
+}
+
+using Ends = std::vector<std::pair<const char *, const char *>>;
+
+/// add edges between the named nodes of a graph, in bulk or one at a time
+static std::vector<Agedge_t *> add_edges(Agraph_t *g, const Ends &ends,
+                                         bool bulk) {
+  std::vector<Agnode_t *> tails;
+  std::vector<Agnode_t *> heads;
+  for (const auto &[tail, head] : ends) {
+    tails.push_back(agnode(g, const_cast<char *>(tail), 0));
+    heads.push_back(agnode(g, const_cast<char *>(head), 0));
+    REQUIRE(tails.back() != nullptr);
+    REQUIRE(heads.back() != nullptr);
+  }
+  std::vector<Agedge_t *> edges(ends.size());
+  if (bulk) {
+    agedges(g, tails.data(), heads.data(), ends.size(), edges.data());
+  } else {
+    for (std::size_t i = 0; i < ends.size(); ++i) {
+      edges[i] = agedge(g, tails[i], heads[i], nullptr, 1);
+    }
+  }
+  return edges;
+}
+
+TEST_CASE("Bulk edges join the edges nodes already have") {
+  const std::string dot =
+      "digraph { a -> b; b -> c; c -> a; a -> c; c -> c; d }";
+  const Ends ends = {{"a", "b"}, {"b", "a"}, {"c", "c"}, {"d", "a"},
+                     {"a", "b"}, {"c", "b"}, {"d", "d"}, {"b", "c"}};
+
+  const CGraph::AGraph bulk{dot};
+  const CGraph::AGraph single{dot};
+  const auto edges = add_edges(bulk.c_struct(), ends, true);
+  add_edges(single.c_struct(), ends, false);
+
+  for (std::size_t i = 0; i < ends.size(); ++i) {
+    REQUIRE(edges[i] != nullptr);
+    REQUIRE(std::string(agnameof(agtail(edges[i]))) == ends[i].first);
+    REQUIRE(std::string(agnameof(aghead(edges[i]))) == ends[i].second);
+  }
+  REQUIRE(agnedges(bulk.c_struct()) == 5 + static_cast<int>(ends.size()));
+  REQUIRE(walk(bulk.c_struct()) == walk(single.c_struct()));
+  REQUIRE(to_dot(bulk.c_struct()) == to_dot(single.c_struct()));
+}
+
+TEST_CASE("Bulk edges are checked against existing ones where needed") {
+  SECTION("strict graphs do not get parallel edges") {
+    const std::string dot = "strict digraph { a -> b; c }";
+    const Ends ends = {{"a", "b"}, {"b", "a"}, {"a", "c"}, {"a", "c"}};
+
+    const CGraph::AGraph bulk{dot};
+    const CGraph::AGraph single{dot};
+    const auto edges = add_edges(bulk.c_struct(), ends, true);
+    add_edges(single.c_struct(), ends, false);
+
+    REQUIRE(ageqedge(edges[0], agedge(bulk.c_struct(), agtail(edges[0]),
+                                      aghead(edges[0]), nullptr, 0)));
+    REQUIRE(ageqedge(edges[2], edges[3]));
+    REQUIRE(agnedges(bulk.c_struct()) == 3);
+    REQUIRE(walk(bulk.c_struct()) == walk(single.c_struct()));
+  }
+
+  SECTION("graphs without loops do not get loops") {
+    Agdesc_t desc = Agdirected;
+    desc.no_loop = 1;
+    const CGraph::AGraph bulk{agopen(const_cast<char *>("G"), desc, nullptr)};
+    const CGraph::AGraph single{
+        agopen(const_cast<char *>("G"), desc, nullptr)};
+    for (Agraph_t *g : {bulk.c_struct(), single.c_struct()}) {
+      agnode(g, const_cast<char *>("a"), 1);
+      agnode(g, const_cast<char *>("b"), 1);
+    }
+    const Ends ends = {{"a", "b"}, {"a", "a"}, {"b", "a"}};
+    const auto edges = add_edges(bulk.c_struct(), ends, true);
+    add_edges(single.c_struct(), ends, false);
+
+    REQUIRE(edges[0] != nullptr);
+    REQUIRE(edges[1] == nullptr);
+    REQUIRE(edges[2] != nullptr);
+    REQUIRE(agnedges(bulk.c_struct()) == 2);
+    REQUIRE(walk(bulk.c_struct()) == walk(single.c_struct()));
+  }
+
+  SECTION("edges added to a subgraph are also in the root graph") {
+    const std::string dot = "digraph { subgraph s { a -> b; c } d }";
+    const Ends ends = {{"a", "b"}, {"b", "c"}, {"c", "a"}};
+
+    const CGraph::AGraph bulk{dot};
+    const CGraph::AGraph single{dot};
+    Agraph_t *sub = agsubg(bulk.c_struct(), const_cast<char *>("s"), 0);
+    Agraph_t *single_sub =
+        agsubg(single.c_struct(), const_cast<char *>("s"), 0);
+    REQUIRE(sub != nullptr);
+    REQUIRE(single_sub != nullptr);
+    const auto edges = add_edges(sub, ends, true);
+    add_edges(single_sub, ends, false);
+
+    for (Agedge_t *e : edges) {
+      REQUIRE(e != nullptr);
+      REQUIRE(ageqedge(agsubedge(sub, e, 0), e));
+      REQUIRE(ageqedge(agsubedge(bulk.c_struct(), e, 0), e));
+    }
+    REQUIRE(agnedges(sub) == 4);
+    REQUIRE(agnedges(bulk.c_struct()) == 4);
+    REQUIRE(walk(sub) == walk(single_sub));
+    REQUIRE(walk(bulk.c_struct()) == walk(single.c_struct()));
+  }
+}
+
+TEST_CASE("Bulk edges can be found, iterated over and deleted") {
+  std::string dot = "digraph {";
+  for (int i = 0; i < 30; ++i) {
+    dot += " n" + std::to_string(i) + ";";
+  }
+  dot += " }";
+  std::vector<std::string> names;
+  for (int i = 0; i < 30; ++i) {
+    names.push_back("n" + std::to_string(i));
+  }
+  Ends ends;
+  unsigned x = 1;
+  for (int i = 0; i < 200; ++i) {
+    x = x * 1103515245u + 12345u;
+    const auto tail = (x >> 8) % 30;
+    x = x * 1103515245u + 12345u;
+    const auto head = (x >> 8) % 30;
+    ends.emplace_back(names[tail].c_str(), names[head].c_str());
+  }
+
+  const CGraph::AGraph bulk{dot};
+  const CGraph::AGraph single{dot};
+  const auto edges = add_edges(bulk.c_struct(), ends, true);
+  const auto single_edges = add_edges(single.c_struct(), ends, false);
+  REQUIRE(agnedges(bulk.c_struct()) == 200);
+  REQUIRE(walk(bulk.c_struct()) == walk(single.c_struct()));
+
+  // every edge can be looked up by its end points
+  for (Agedge_t *e : edges) {
+    Agedge_t *found = agedge(bulk.c_struct(), agtail(e), aghead(e), nullptr, 0);
+    REQUIRE(found != nullptr);
+    REQUIRE(agtail(found) == agtail(e));
+    REQUIRE(aghead(found) == aghead(e));
+  }
+
+  // delete every other edge
+  for (std::size_t i = 0; i < edges.size(); i += 2) {
+    REQUIRE(agdeledge(bulk.c_struct(), edges[i]) == 0);
+    REQUIRE(agdeledge(single.c_struct(), single_edges[i]) == 0);
+  }
+  REQUIRE(agnedges(bulk.c_struct()) == 100);
+  REQUIRE(walk(bulk.c_struct()) == walk(single.c_struct()));
+  REQUIRE(to_dot(bulk.c_struct()) == to_dot(single.c_struct()));
+}
@@ -1,4 +1,5 @@
 #include <stdexcept>
+#include <string>
 
 #include <catch2/catch_all.hpp>
 
@@ -38,3 +39,24 @@ TEST_CASE("AGraph can be move assigned") {
   other = std::move(g);
   REQUIRE(other.c_struct() == c_ptr);
 }
+
+TEST_CASE("AGraph can be constructed from DOT source larger than the scanner "
+          "buffer") {
+  std::string dot = "digraph {\n";
+  for (int i = 0; i < 10000; ++i) {
+    dot += "  n" + std::to_string(i) + " -> n" + std::to_string(i + 1) + ";\n";
+  }
+  dot += "}\n";
+  CGraph::AGraph g{dot};
+  REQUIRE(agnnodes(g.c_struct()) == 10001);
+  REQUIRE(agnedges(g.c_struct()) == 10000);
+}
+
+TEST_CASE("AGraph construction does not see trailing input of a previous "
+          "DOT source") {
+  CGraph::AGraph first{"graph {a}\ngraph {b}\n"};
+  REQUIRE(agnode(first.c_struct(), const_cast<char *>("a"), 0) != nullptr);
+  CGraph::AGraph second{"graph {c}"};
+  REQUIRE(agnode(second.c_struct(), const_cast<char *>("b"), 0) == nullptr);
+  REQUIRE(agnode(second.c_struct(), const_cast<char *>("c"), 0) != nullptr);
+}
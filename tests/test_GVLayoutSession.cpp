@@ -0,0 +1,77 @@
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_all.hpp>
+
+#include <cgraph++/AGraph.h>
+#include <gvc++/GVContext.h>
+#include <gvc++/GVLayout.h>
+#include <gvc++/GVLayoutSession.h>
+#include <gvc++/GVRenderData.h>
+
+TEST_CASE("A layout session renders its template like a one-off layout") {
+  const auto demand_loading = false;
+  auto gvc =
+      std::make_shared<GVC::GVContext>(lt_preloaded_symbols, demand_loading);
+
+  auto dot = "digraph {a -> b -> c}";
+  const auto session = GVC::GVLayoutSession(gvc, dot, "dot");
+
+  auto g = std::make_shared<CGraph::AGraph>(dot);
+  const auto layout = GVC::GVLayout(gvc, g, "dot");
+
+  // render twice, to check the template is left ready for another layout
+  REQUIRE(session.render("svg").string_view() ==
+          layout.render("svg").string_view());
+  REQUIRE(session.render("svg").string_view() ==
+          layout.render("svg").string_view());
+}
+
+TEST_CASE("Attribute overrides apply to a single layout of a session") {
+  const auto demand_loading = false;
+  auto gvc =
+      std::make_shared<GVC::GVContext>(lt_preloaded_symbols, demand_loading);
+
+  const auto session =
+      GVC::GVLayoutSession(gvc, "digraph {a [color=red]; a -> b}", "dot");
+  Agraph_t *g = session.graph().c_struct();
+  Agnode_t *a = agnode(g, const_cast<char *>("a"), 0);
+  REQUIRE(a != nullptr);
+
+  const auto before = std::string(session.render("svg").string_view());
+  REQUIRE(before.find("stroke=\"red\"") != std::string::npos);
+
+  const auto overridden = session.render(
+      "svg", {{a, "color", "blue"}, {g, "bgcolor", "yellow"}});
+  REQUIRE(overridden.string_view().find("stroke=\"blue\"") !=
+          std::string_view::npos);
+  REQUIRE(overridden.string_view().find("fill=\"yellow\"") !=
+          std::string_view::npos);
+  REQUIRE(overridden.string_view().find("stroke=\"red\"") ==
+          std::string_view::npos);
+
+  REQUIRE(std::string(agget(a, const_cast<char *>("color"))) == "red");
+  REQUIRE(session.render("svg").string_view() == before);
+}
+
+TEST_CASE("Changes to the template of a session persist between layouts") {
+  const auto demand_loading = false;
+  auto gvc =
+      std::make_shared<GVC::GVContext>(lt_preloaded_symbols, demand_loading);
+
+  const auto session = GVC::GVLayoutSession(gvc, "digraph {a -> b}", "dot");
+  Agraph_t *g = session.graph().c_struct();
+
+  REQUIRE(session.render("svg").string_view().find(">c</text>") ==
+          std::string_view::npos);
+
+  Agnode_t *b = agnode(g, const_cast<char *>("b"), 0);
+  Agnode_t *c = agnode(g, const_cast<char *>("c"), 1);
+  agedge(g, b, c, nullptr, 1);
+
+  std::string streamed;
+  session.render("svg", {},
+                 [&](std::string_view chunk) { streamed += chunk; });
+  REQUIRE(streamed.find(">c</text>") != std::string::npos);
+}
@@ -163,3 +163,22 @@ TEST_CASE("Layout with an unknown engine throws an exception") {
   REQUIRE_THROWS_AS(GVC::GVLayout(gvc, g, "UNKNOWN_ENGINE"),
                     std::runtime_error);
 }
+
+TEST_CASE("A graph can be laid out again from its previous layout") {
+  const auto demand_loading = false;
+  auto gvc =
+      std::make_shared<GVC::GVContext>(lt_preloaded_symbols, demand_loading);
+
+  auto dot = "digraph {a -> b; a -> c}";
+  auto g = std::make_shared<CGraph::AGraph>(dot);
+
+  // rendering in the dot format records the layout in the pos attributes
+  { GVC::GVLayout(gvc, g, "dot").render("dot"); }
+
+  Agnode_t *a = agnode(g->c_struct(), const_cast<char *>("a"), 0);
+  Agnode_t *d = agnode(g->c_struct(), const_cast<char *>("d"), 1);
+  agedge(g->c_struct(), a, d, nullptr, 1);
+
+  const auto layout = GVC::GVLayout(gvc, g, "dot", {a, d});
+  REQUIRE(!layout.render("dot").string_view().empty());
+}
@@ -1,4 +1,8 @@
 #include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 #include <catch2/catch_all.hpp>
 
@@ -37,3 +41,49 @@ TEST_CASE("Rendering in an unknown format throws an exception") {
 
   REQUIRE_THROWS_AS(layout.render("UNKNOWN_FORMAT"), std::runtime_error);
 }
+
+TEST_CASE("Rendered SVG can be streamed to a sink or an output stream") {
+  const auto demand_loading = false;
+  auto gvc =
+      std::make_shared<GVC::GVContext>(lt_preloaded_symbols, demand_loading);
+
+  auto dot = "digraph {a -> b -> c; a -> c}";
+  auto g = std::make_shared<CGraph::AGraph>(dot);
+
+  const auto layout = GVC::GVLayout(gvc, g, "dot");
+
+  const auto result = layout.render("svg");
+
+  std::string streamed;
+  std::size_t chunks = 0;
+  layout.render("svg", [&](std::string_view chunk) {
+    streamed += chunk;
+    ++chunks;
+  });
+  REQUIRE(chunks > 1);
+  REQUIRE(streamed == result.string_view());
+
+  std::ostringstream os;
+  layout.render("svg", os);
+  REQUIRE(os.str() == result.string_view());
+}
+
+TEST_CASE("An exception thrown by a render sink is propagated") {
+  const auto demand_loading = false;
+  auto gvc =
+      std::make_shared<GVC::GVContext>(lt_preloaded_symbols, demand_loading);
+
+  auto dot = "digraph {a}";
+  auto g = std::make_shared<CGraph::AGraph>(dot);
+
+  const auto layout = GVC::GVLayout(gvc, g, "dot");
+
+  REQUIRE_THROWS_AS(layout.render("svg",
+                                  [](std::string_view) {
+                                    throw std::length_error("sink is full");
+                                  }),
+                    std::length_error);
+
+  // the layout can still be rendered afterwards
+  REQUIRE(layout.render("svg").length() > 0);
+}
@@ -10,11 +10,12 @@ import subprocess
 import sys
 import tempfile
 from pathlib import Path
+from typing import Dict, List
 
 import pytest
 
 sys.path.append(os.path.dirname(__file__))
-from gvtest import ROOT, compile_c, dot  # pylint: disable=wrong-import-position
+from gvtest import ROOT, compile_c, dot, run_c  # pylint: disable=wrong-import-position
 
 
 def test_json_node_order():
@@ -229,3 +230,641 @@ def test_xml_escape():
                     assert escaped == f"character |{expected}|", "bad UTF-8 escaping"
                 else:
                     assert escaped == unescaped, "bad UTF-8 passthrough"
+
+
+def test_gvb_round_trip():
+    """
+    a graph written in the binary format should read back as the same graph
+    its -Txdot output describes
+    """
+
+    source = (
+        'digraph G { label="x"; edge [style=""]; a -> b [color=red];\n'
+        "  subgraph cluster_s { node [shape=box]; c; d }\n"
+        "  c -> d; c -> d; b [label=<<b>hi</b>>] }"
+    )
+
+    gvb = dot("gvb", source=source)
+    assert gvb.startswith(b"\x89GVB\r\n\x1a\n"), "missing binary format magic"
+    xdot = dot("xdot", source=source)
+
+    # both should lay out identically when read back in
+    from_gvb = subprocess.check_output(
+        ["dot", "-Tcanon"], input=gvb, universal_newlines=False
+    )
+    from_xdot = subprocess.check_output(
+        ["dot", "-Tcanon"], input=xdot.encode("utf-8"), universal_newlines=False
+    )
+    assert from_gvb == from_xdot, "binary round trip lost information"
+
+
+@pytest.mark.parametrize("truncate", (True, False))
+def test_gvb_bad_length(truncate: bool):
+    """
+    a binary graph shorter than its header claims should be rejected with an
+    error, without trying to allocate the claimed length
+    """
+
+    if truncate:
+        gvb = dot("gvb", source="digraph { a -> b -> c }")
+        gvb = gvb[: len(gvb) // 2]
+    else:
+        # magic, version 1, then a length of 2⁶⁰ - 1 and no payload
+        gvb = b"\x89GVB\r\n\x1a\n\x01" + b"\xff" * 8 + b"\x0f"
+
+    proc = subprocess.run(
+        ["dot", "-Tcanon"], input=gvb, stdout=subprocess.PIPE, stderr=subprocess.PIPE
+    )
+    stderr = proc.stderr.decode("utf-8", "replace")
+    assert proc.returncode in (0, 1), "dot crashed on a bad binary graph"
+    assert "out of memory" not in stderr, "allocated the claimed length"
+    assert "truncated binary graph" in stderr, "bad binary graph not reported"
+
+
+@pytest.mark.skipif(
+    os.getenv("build_system") == "msbuild",
+    reason="Windows MSBuild release does not contain any header files (#1777)",
+)
+def test_agcsr():
+    """
+    compressed sparse row snapshots should reflect the graph’s adjacency
+    """
+
+    # find co-located test source
+    c_src = (Path(__file__).parent / "agcsr.c").resolve()
+    assert c_src.exists(), "missing test case"
+
+    stdout, _ = run_c(c_src, link=["cgraph"])
+
+    assert stdout.splitlines() == [
+        "a: ->b/2 ->c/1 <-c",
+        "b: ->b/1 <-a <-b",
+        "c: ->a/1 <-a",
+    ]
+
+
+@pytest.mark.skipif(
+    os.getenv("build_system") == "msbuild",
+    reason="Windows MSBuild release does not contain any header files (#1777)",
+)
+def test_agstrtod():
+    """
+    cached conversions of strings should match strtod and strtol
+    """
+
+    # find co-located test source
+    c_src = (Path(__file__).parent / "agstrtod.c").resolve()
+    assert c_src.exists(), "missing test case"
+
+    stdout, _ = run_c(c_src, link=["cgraph"])
+
+    assert stdout.splitlines() == [
+        '"oops": not a double not a long',
+        '"": not a double not a long',
+        '"2.5": 2.5 2',
+        '"0.75": 0.75 0',
+        '"3": 3 3',
+        '"wide": not a double not a long',
+        '"0.75": 0.75 0',
+    ]
+
+
+@pytest.mark.skipif(
+    os.getenv("build_system") == "msbuild",
+    reason="Windows MSBuild release does not contain any header files (#1777)",
+)
+def test_dtfset():
+    """
+    the flat hash set method of cdt should behave as a set
+    """
+
+    # find co-located test source
+    c_src = (Path(__file__).parent / "dtfset.c").resolve()
+    assert c_src.exists(), "missing test case"
+
+    stdout, _ = run_c(c_src, link=["cdt"])
+
+    assert stdout.splitlines() == [
+        "size 10000 walk 10000",
+        "size 5000 walk 5000 freed 5000",
+        "size 10000 walk 10000",
+        "ordered first 0 last 10000",
+        "size 10000 walk 10000",
+        "size 10000 walk 10000",
+        "freed 10000",
+    ]
+
+
+def test_orthobatch():
+    """
+    batched ortho routing should not depend on the number of threads
+    """
+
+    input = ROOT / "tests/graphs/clust4.gv"
+    assert input.exists(), "unexpectedly missing test case"
+
+    def route(batch: int, threads: int) -> str:
+        env = os.environ.copy()
+        env["OMP_NUM_THREADS"] = str(threads)
+        return subprocess.check_output(
+            ["dot", "-Gsplines=ortho", f"-Gorthobatch={batch}", "-Txdot", input],
+            env=env,
+            universal_newlines=True,
+        )
+
+    assert route(4, 1) == route(4, 4), "routing depends on the thread count"
+
+
+def test_orthoastar():
+    """
+    ortho routing with an A* search should still route every edge orthogonally
+    """
+
+    input = ROOT / "tests/graphs/clust4.gv"
+    assert input.exists(), "unexpectedly missing test case"
+
+    output = subprocess.check_output(
+        ["dot", "-Gsplines=ortho", "-Gorthoastar=true", "-Tjson", input],
+        universal_newlines=True,
+    )
+    edges = json.loads(output)["edges"]
+    assert len(edges) > 0, "no edges in output"
+
+    for edge in edges:
+        assert "pos" in edge, f"edge {edge['_gvid']} was not routed"
+        points = [
+            tuple(float(v) for v in p.split(","))
+            for p in edge["pos"].split()
+            if not p.startswith(("s,", "e,"))
+        ]
+        assert len(points) >= 2, f"edge {edge['_gvid']} has an empty route"
+        for (x0, y0), (x1, y1) in zip(points, points[1:]):
+            assert (
+                abs(x0 - x1) < 0.01 or abs(y0 - y1) < 0.01
+            ), f"edge {edge['_gvid']} has a diagonal segment"
+
+
+@pytest.mark.parametrize("graph", ("honda-tokoro.gv", "proc3d.gv"))
+def test_orthoastar_weight(tmp_path: Path, graph: str):
+    """
+    ortho routing with an A* search should find routes of least weight
+    """
+
+    input = ROOT / "tests/graphs" / graph
+    assert input.exists(), "unexpectedly missing test case"
+
+    def weight(astar: bool) -> int:
+        trace = tmp_path / f"{astar}.json"
+        # route all edges in one batch, so every search sees the same weights
+        subprocess.run(
+            [
+                "dot",
+                "-Gsplines=ortho",
+                "-Gorthobatch=1000",
+                f"-Gorthoastar={str(astar).lower()}",
+                "-Tsvg",
+                "-o",
+                os.devnull,
+                f"--trace={trace}",
+                "--trace-format=json",
+                input,
+            ],
+            check=True,
+        )
+        data = json.loads(trace.read_text())
+        layout = next(s for s in data["spans"] if s["name"] == "layout")
+        splines = next(s for s in layout["children"] if s["name"] == "splines")
+        return splines["counters"]["ortho route weight"]
+
+    # no route can weigh less than the least, so equal totals mean that every
+    # A* route is of least weight
+    assert weight(True) == weight(False), "A* found a heavier route"
+
+
+def test_twopi_components():
+    """
+    twopi should lay out many components the same with any number of threads
+    """
+
+    # a few hundred small trees, some rooted by attribute
+    graph = ["graph {"]
+    for i in range(200):
+        for j in range(1, 8):
+            graph += [f"  c{i}_{j} -- c{i}_{2 * j}", f"  c{i}_{j} -- c{i}_{2 * j + 1}"]
+        if i % 3 == 0:
+            graph.append(f"  c{i}_5 [root=true]")
+    graph.append("}")
+
+    def layout(threads: int) -> str:
+        env = os.environ.copy()
+        env["OMP_NUM_THREADS"] = str(threads)
+        return subprocess.check_output(
+            ["twopi", "-Txdot"],
+            input="\n".join(graph),
+            env=env,
+            universal_newlines=True,
+        )
+
+    assert layout(1) == layout(4), "layout depends on the thread count"
+
+
+@pytest.mark.parametrize("engine", ("circo", "fdp", "neato", "twopi"))
+def test_pack_overlap(engine: str):
+    """
+    packed components should not overlap each other
+    """
+
+    # boxes of assorted sizes, each its own component
+    sizes = [(0.3 + (i * 7 % 13) / 10, 0.3 + (i * 5 % 7) / 10) for i in range(40)]
+    nodes = [f"n{i} [width={w:.1f}, height={h:.1f}]" for i, (w, h) in enumerate(sizes)]
+    source = "graph { node [shape=box]; " + "; ".join(nodes) + " }"
+
+    output = subprocess.check_output(
+        [engine, "-Tjson"], input=source, universal_newlines=True
+    )
+    boxes = []
+    for obj in json.loads(output)["objects"]:
+        x, y = (float(v) for v in obj["pos"].split(","))
+        w = float(obj["width"]) * 36
+        h = float(obj["height"]) * 36
+        boxes.append((x - w, y - h, x + w, y + h))
+
+    for a, b in itertools.combinations(boxes, 2):
+        assert (
+            a[2] <= b[0] or b[2] <= a[0] or a[3] <= b[1] or b[3] <= a[1]
+        ), "packed components overlap"
+
+
+@pytest.mark.skipif(
+    os.getenv("build_system") == "msbuild",
+    reason="Windows MSBuild release does not contain any header files (#1777)",
+)
+def test_layout_update():
+    """
+    an incremental layout should keep the previous positions of unchanged nodes,
+    the splines between them and the order of nodes, and place new nodes
+    """
+
+    # find co-located test source
+    c_src = (Path(__file__).parent / "layout_update.c").resolve()
+    assert c_src.exists(), "missing test case"
+
+    stdout, _ = run_c(c_src, link=["cgraph", "gvc"])
+
+    assert stdout.splitlines() == [
+        "a same pos",
+        "a->b same pos",
+        "a->d same pos",
+        "b same pos",
+        "b->c same pos",
+        "b->d same pos",
+        "c same pos",
+        "d same pos",
+        "d->c same pos",
+        "e placed",
+        "b same pos",
+        "b->c same pos",
+        "b->d same pos",
+        "c same pos",
+        "d same pos",
+        "d->c same pos",
+        "b right of e",
+    ]
+
+
+@pytest.mark.skipif(
+    os.getenv("build_system") == "msbuild",
+    reason="Windows MSBuild release does not contain any header files (#1777)",
+)
+def test_image_cache(tmp_path: Path):
+    """
+    images evicted from the decoded image cache should be loaded again
+    """
+
+    # find co-located test source
+    c_src = (Path(__file__).parent / "image_cache.c").resolve()
+    assert c_src.exists(), "missing test case"
+
+    # two PostScript images for the core plugin to load
+    images = []
+    for name in ("a", "b"):
+        image = tmp_path / f"{name}.ps"
+        image.write_text(
+            "%!PS-Adobe-3.0 EPSF-3.0\n"
+            "%%BoundingBox: 0 0 36 36\n"
+            f"newpath 0 0 moveto 36 36 lineto stroke % {name}\n"
+        )
+        images.append(image)
+
+    graph = "digraph { " + " ".join(
+        f'{i} [shape=box label="" image="{image}"];' for i, image in enumerate(images)
+    ) + " }"
+
+    stdout, _ = run_c(c_src, input=graph, link=["cgraph", "gvc"])
+
+    assert stdout.splitlines() == ["same", "evicted", "same", "evicted"]
+
+
+@pytest.mark.parametrize("fmt", ("chrome", "json"))
+def test_trace(tmp_path: Path, fmt: str):
+    """
+    `--trace` should record the phases of a dot run with their counters
+    """
+
+    trace = tmp_path / "trace.json"
+    subprocess.run(
+        ["dot", "-Tsvg", "-o", os.devnull, f"--trace={trace}", f"--trace-format={fmt}"],
+        input="digraph { a -> b -> c; a -> c; b -> d }",
+        check=True,
+        universal_newlines=True,
+    )
+    data = json.loads(trace.read_text())
+
+    if fmt == "chrome":
+        spans = {e["name"]: e["args"] for e in data["traceEvents"]}
+        assert all(e["ph"] == "X" and e["dur"] >= 0 for e in data["traceEvents"])
+    else:
+        layout = next(s for s in data["spans"] if s["name"] == "layout")
+        assert [s["name"] for s in layout["children"]] == [
+            "init",
+            "rank",
+            "mincross",
+            "position",
+            "splines",
+        ]
+        spans = {s["name"]: s["counters"] for s in data["spans"]}
+        spans.update({s["name"]: s["counters"] for s in layout["children"]})
+
+    for phase in ("parse", "layout", "rank", "mincross", "render", "write"):
+        assert phase in spans, f"missing {phase} span"
+    assert "network simplex pivots" in spans["rank"]
+    assert "mincross iterations" in spans["mincross"]
+
+
+@pytest.mark.skipif(
+    os.getenv("build_system") == "msbuild",
+    reason="Windows MSBuild release does not contain any header files (#1777)",
+)
+def test_trace_api():
+    """
+    spans and counters should be retrievable from the context that did the work
+    """
+
+    # find co-located test source
+    c_src = (Path(__file__).parent / "trace.c").resolve()
+    assert c_src.exists(), "missing test case"
+
+    stdout, _ = run_c(c_src, link=["cgraph", "gvc"])
+
+    assert stdout.splitlines() == [
+        "layout",
+        "  init",
+        "  rank",
+        "  mincross",
+        "  position",
+        "  splines",
+        "render",
+        "write",
+        "counted",
+        "0 spans from the other context",
+        "0 spans recorded by the other context",
+        "6 spans recorded by this context",
+    ]
+
+
+def text_layout(tmp_path: Path, labels: List[str], *args: str):
+    """
+    lay out a node for each label with `dot -Tjson`, returning the size, label
+    width and label baseline of each node and the trace counters
+
+    Labels are given as they are written in DOT, quotes or brackets included.
+    """
+    decls = "".join(f" n{i} [label={l}];" for i, l in enumerate(labels))
+    graph = "digraph {" + decls + " }"
+    trace = tmp_path / "trace.json"
+    out = subprocess.check_output(
+        ["dot", "-Tjson", f"--trace={trace}", "--trace-format=json", *args],
+        input=graph,
+        stderr=subprocess.DEVNULL,
+        universal_newlines=True,
+    )
+
+    nodes = []
+    for obj in json.loads(out)["objects"]:
+        _, y = (float(c) for c in obj["pos"].split(","))
+        text = next(op for op in obj["_ldraw_"] if op["op"] == "T")
+        baseline = round(text["pt"][1] - y, 2)
+        size = (obj["width"], obj["height"], text["width"], baseline)
+        nodes.append((obj["label"], *size))
+
+    counters: Dict[str, int] = {}
+    spans = json.loads(trace.read_text())["spans"]
+    while spans:
+        span = spans.pop()
+        for name, value in span["counters"].items():
+            counters[name] = counters.get(name, 0) + value
+        spans += span.get("children", [])
+    return nodes, counters
+
+
+def test_textspan_cache(tmp_path: Path):
+    """
+    repeated labels should be measured once and come out the same size as
+    their first measurement
+    """
+
+    labels = [f'"label {"x" * i}"' for i in range(10)]
+    first, counters = text_layout(tmp_path, labels)
+    assert counters["text measurements"] == len(labels)
+    assert "text measurement cache hits" not in counters
+
+    nodes, counters = text_layout(tmp_path, labels + labels[::-1] * 29)
+    assert counters["text measurements"] == len(labels)
+    assert counters["text measurement cache hits"] == len(labels) * 29
+    assert nodes[: len(labels)] == first
+    measured = dict((n[0], n[1:]) for n in first)
+    for label, *size in nodes:
+        assert tuple(size) == measured[label], f"{label} changed size"
+
+
+def test_textspan_cache_eviction(tmp_path: Path):
+    """
+    labels evicted from a full measurement cache should be measured again
+    """
+
+    # one more label than fits, so the first is evicted
+    labels = [f"l{i}" for i in range(4096 + 50)]
+    # the first labels again, evicting the next ones, then the latest labels,
+    # which are still there
+    again = labels[:50] + labels[-50:]
+    nodes, counters = text_layout(tmp_path, labels + again)
+    assert counters["text measurements"] == len(labels) + 50
+    assert counters["text measurement cache evictions"] == 100
+    assert counters["text measurement cache hits"] == 50
+    assert nodes[len(labels) :] == nodes[:50] + nodes[len(labels) - 50 : len(labels)]
+
+
+def test_textspan_cache_verbose(tmp_path: Path):
+    """
+    reporting font resolution with -v should bypass the measurement cache
+    without changing any sizes
+    """
+
+    labels = [f'"label {"x" * i}"' for i in range(10)] * 3
+    quiet, _ = text_layout(tmp_path, labels)
+    verbose, counters = text_layout(tmp_path, labels, "-v")
+    assert verbose == quiet
+
+    # the first measurement of the font is reported rather than remembered
+    assert counters["text measurements"] == 11
+    assert counters["text measurement cache hits"] == len(labels) - 11
+
+
+def html_table(a: str, b: str, width: int = 0) -> str:
+    """
+    a 2×2 HTML-like table label with the given text in two of its cells, and
+    optionally a fixed width for the first
+    """
+    fixed = f' FIXEDSIZE="TRUE" WIDTH="{width}" HEIGHT="20"' if width else ""
+    return (
+        f"<<TABLE><TR><TD{fixed}>{a}</TD><TD>x</TD></TR>"
+        f"<TR><TD>y</TD><TD>{b}</TD></TR></TABLE>>"
+    )
+
+
+def test_html_size_cache(tmp_path: Path):
+    """
+    tables should share row and column sizes only when their cells are the
+    same size
+    """
+
+    tables = [html_table("a", "b"), html_table("longer text", "b")]
+    # each table sized on its own
+    alone = [text_layout(tmp_path, [t])[0][0] for t in tables]
+    assert alone[0][1:] != alone[1][1:], "tables of different text sized alike"
+
+    nodes, counters = text_layout(tmp_path, tables * 10)
+    assert nodes == alone * 10
+    # rows are the same in both, columns are not
+    assert counters["html table sizings"] == 3
+    assert counters["html table size cache hits"] == 2 * len(nodes) - 3
+
+    # cells of a fixed size are sized alike whatever their text
+    fixed = [html_table(t, "b", 40) for t in ("a", "longer text", "c")]
+    nodes, counters = text_layout(tmp_path, fixed)
+    assert counters["html table sizings"] == 2
+    assert counters["html table size cache hits"] == 4
+    assert len({n[1:3] for n in nodes}) == 1
+
+
+def test_html_size_cache_full(tmp_path: Path):
+    """
+    sizes should be computed again, and come out the same, after the cache of
+    table sizes fills up and is cleared
+    """
+
+    # as many column sizes as the cache holds, and a few more
+    tables = [html_table("a", "b", 20 + i) for i in range(4100)]
+    nodes, counters = text_layout(tmp_path, tables + tables[:1])
+    assert counters["html table size cache clears"] == 1
+
+    # the rows once before and once after clearing, the columns of each table,
+    # and those of the first table again
+    assert counters["html table sizings"] == 1 + 1 + len(tables) + 1
+    assert nodes[-1] == nodes[0]
+
+
+@pytest.mark.parametrize("fmt", ("svg:cairo", "ps:lasi"))
+def test_textspan_cache_render(fmt: str):
+    """
+    renderers that draw text from a plugin layout should draw labels whose
+    size came from the measurement cache
+    """
+
+    # a label measured once, and one measured and then taken from the cache
+    once = "digraph { a [label=hello]; }"
+    twice = "digraph { a [label=hello]; b [label=hello]; }"
+    try:
+        once_out = dot(fmt, source=once)
+    except subprocess.CalledProcessError:
+        pytest.skip(f"{fmt} not available")
+    twice_out = dot(fmt, source=twice)
+
+    if fmt == "svg:cairo":
+        # cairo draws each glyph as a reference to its outline
+        glyphs = once_out.count('"#glyph')
+        assert glyphs > 0, "no text drawn"
+        assert twice_out.count('"#glyph') == 2 * glyphs, "cached label not drawn"
+    else:
+        # the same graph with nothing drawn for the second label
+        blank = dot(fmt, source='digraph { a [label=hello]; b [label=""]; }')
+        assert len(twice_out) > len(blank), "cached label not drawn"
+
+
+@pytest.mark.parametrize("family", ("-a50,1", "-a50,2", "-A50,80", "-r20,3", "-R20"))
+def test_gvgen_seed(family: str):
+    """
+    gvgen should generate the same random graph when given the same seed
+    """
+
+    first = subprocess.check_output(["gvgen", "-z42", family], universal_newlines=True)
+    second = subprocess.check_output(["gvgen", "-z42", family], universal_newlines=True)
+    assert first == second, "seeded gvgen output was not reproducible"
+
+    other = subprocess.check_output(["gvgen", "-z43", family], universal_newlines=True)
+    assert first != other, "gvgen seed had no effect"
+
+
+@pytest.mark.parametrize("family", ("-A6,1", "-A6,2", "-A4,10", "-A50,80"))
+def test_gvgen_dag(family: str):
+    """
+    gvgen random DAGs should have every node and no parallel edges
+    """
+
+    nodes, edges = (int(v) for v in family[2:].split(","))
+    output = subprocess.check_output(
+        ["gvgen", "-d", "-z1", family], universal_newlines=True
+    )
+    lines = [line.strip() for line in output.splitlines()[1:-1]]
+    arcs = [line for line in lines if "->" in line]
+    seen = {v for line in lines for v in line.split(" -> ")}
+
+    assert len(seen) == nodes, "nodes are missing"
+    assert len(set(arcs)) == len(arcs), "parallel edges were generated"
+    assert len(arcs) == min(edges, nodes * (nodes - 1) // 2)
+
+
+def test_benchmark(tmp_path: Path):
+    """
+    the benchmark script should time layout and rendering of its corpus
+    """
+
+    output = tmp_path / "benchmark.json"
+    subprocess.run(
+        [
+            sys.executable,
+            Path(__file__).parent / "benchmark.py",
+            "--sizes=20",
+            "--repeat=1",
+            "--engines=dot",
+            "--formats=svg",
+            f"--output={output}",
+        ],
+        check=True,
+    )
+    report = json.loads(output.read_text())
+
+    results = report["results"]
+    assert {r["family"] for r in results} == {
+        "grid",
+        "tree",
+        "powerlaw",
+        "dag",
+        "clustered",
+    }
+    for r in results:
+        assert r["status"] == "ok", f"{r['kind']} of {r['family']} failed"
+        assert r["nodes"] > 0
+        assert r["wall_median"] >= 0
+    layout = next(r for r in results if r["kind"] == "layout")
+    assert "layout/rank" in layout["phases"]
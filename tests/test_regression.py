@@ -4090,6 +4090,87 @@ def test_gvpr_printf(statement: str, expected: str):
     assert result == expected, "incorrect GVPR printf behavior"
 
 
+@pytest.mark.parametrize(
+    "statements,expected",
+    (
+        ('int i = 7; i += 3; i *= 2; i %= 6; printf("%d", i)', "2"),
+        ('int i = 1; i <<= 4; i >>= 2; i ^= 7; printf("%d", i)', "3"),
+        ('double f = 2.5; f += 1; f /= 2; printf("%g", f)', "1.75"),
+        ('int i = 5; int j = i++ + ++i; printf("%d %d", i, j)', "7 12"),
+        ('double f = 1; double g = f-- - --f; printf("%g %g", f, g)', "-1 2"),
+        ('unsigned u = 3; int i = -1; printf("%d", u < 4 && i < 0)', "1"),
+        (
+            "int i; int s; for (i = 0; i < 10; i++) s += i % 3 ? i : -i; "
+            'printf("%d", s)',
+            "9",
+        ),
+        ('int i = 10; while (i > 3) i -= 2; printf("%d", i)', "2"),
+        ('int i = 4; if (i / 2 == 2) i = 1; else i = 2; printf("%d", i)', "1"),
+        (
+            'string s = "abc"; printf("%d %d %d", s < "abd", s == "a*", s != "abc")',
+            "1 1 0",
+        ),
+        ('printf("%d", "12" + 1)', "13"),
+    ),
+)
+@pytest.mark.skipif(which("gvpr") is None, reason="gvpr not available")
+def test_gvpr_expressions(statements: str, expected: str):
+    """
+    check the values of arithmetic, assignments and loops in a GVPR program
+    """
+
+    # a program that evaluates the given statements
+    program = f"BEGIN {{ {statements}; }}"
+
+    # run this through GVPR with no input graph
+    gvpr_bin = which("gvpr")
+    result = subprocess.check_output(
+        [gvpr_bin, program], stdin=subprocess.DEVNULL, universal_newlines=True
+    )
+
+    # confirm we got the expected output
+    assert result == expected, "incorrect GVPR expression value"
+
+
+@pytest.mark.skipif(which("gvpr") is None, reason="gvpr not available")
+def test_gvpr_parallel_clauses():
+    """
+    clauses that only touch attributes of `$` should give the same result
+    whether they are evaluated by one thread or several
+    """
+
+    # a graph large enough for the clauses to be evaluated in parallel
+    nodes = "".join(f"n{i} [weight={i % 7}];\n" for i in range(3000))
+    edges = "".join(f"n{i} -> n{(i * 37) % 3000};\n" for i in range(3000))
+    graph = f'digraph {{ node [label="", color=""]; edge [color=""];\n{nodes}{edges}}}'
+
+    program = textwrap.dedent(
+        """\
+    N[$.weight == "3" || $.weight > "5"]{ $.label = $.weight + "!"; $.color = $.label }
+    N[$.weight == "0"]
+    E{ $.color = $.color == "" ? "red" : "blue"; $.color = $.color + "x" }
+    """
+    )
+
+    gvpr_bin = which("gvpr")
+    results = []
+    for threads in ("1", "4"):
+        env = os.environ.copy()
+        env["OMP_NUM_THREADS"] = threads
+        results += [
+            subprocess.check_output(
+                [gvpr_bin, "-c", program],
+                input=graph,
+                env=env,
+                universal_newlines=True,
+            )
+        ]
+
+    assert results[0] == results[1], "parallel evaluation changed the result"
+    assert 'color="3!"' in results[0], "node clause not applied"
+    assert "color=redx" in results[0], "edge clause not applied"
+
+
 usage_info = """\
 Usage: dot [-Vv?] [-(GNE)name=val] [-(KTlso)<val>] <dot files>
 (additional options for neato)    [-x] [-n<v>]
@@ -0,0 +1,70 @@
+/* test case for tracing (see test_misc.py:test_trace_api())
+ */
+
+#include <assert.h>
+#include <graphviz/cgraph.h>
+#include <graphviz/gvc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(void) {
+  GVC_t *gvc = gvContext();
+  assert(gvc != NULL);
+
+  Agraph_t *g = agmemread("digraph { a -> b -> c; a -> c; b -> d }");
+  assert(g != NULL);
+
+  gvTraceEnable(gvc, true);
+  assert(gvLayout(gvc, g, "dot") == 0);
+  char *result = NULL;
+  unsigned length = 0;
+  assert(gvRenderData(gvc, g, "dot", &result, &length) == 0);
+  gvFreeRenderData(result);
+  gvTraceEnable(gvc, false);
+
+  size_t n_spans = 0;
+  const gvtrace_span_t *spans = gvTraceSpans(gvc, &n_spans);
+  for (size_t i = 0; i < n_spans; ++i) {
+    assert(spans[i].wall >= 0 && spans[i].cpu >= 0);
+    printf("%s%s\n", spans[i].parent == SIZE_MAX ? "" : "  ", spans[i].name);
+  }
+
+  // the dot phases each run network simplex or mincross at least once
+  size_t n_counters = 0;
+  const gvtrace_counter_t *counters = gvTraceCounters(gvc, &n_counters);
+  int found = 0;
+  for (size_t i = 0; i < n_counters; ++i) {
+    assert(counters[i].span < n_spans);
+    if (strcmp(counters[i].name, "mincross iterations") == 0 &&
+        strcmp(spans[counters[i].span].name, "mincross") == 0)
+      found = 1;
+  }
+  printf("%s\n", found ? "counted" : "missing");
+  gvFreeLayout(gvc, g);
+
+  // each context records only the work done through it
+  GVC_t *other = gvContext();
+  assert(other != NULL);
+  gvTraceClear(gvc);
+  gvTraceEnable(gvc, true);
+  assert(gvLayout(other, g, "dot") == 0);
+  gvFreeLayout(other, g);
+  gvTraceSpans(gvc, &n_spans);
+  printf("%zu spans from the other context\n", n_spans);
+
+  gvTraceEnable(other, true);
+  assert(gvLayout(gvc, g, "dot") == 0);
+  gvFreeLayout(gvc, g);
+  gvTraceSpans(other, &n_spans);
+  printf("%zu spans recorded by the other context\n", n_spans);
+  gvTraceSpans(gvc, &n_spans);
+  printf("%zu spans recorded by this context\n", n_spans);
+
+  agclose(g);
+  gvFreeContext(other);
+  gvFreeContext(gvc);
+
+  return 0;
+}